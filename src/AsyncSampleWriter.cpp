@@ -0,0 +1,100 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#include <iostream>
+
+#include "AsyncSampleWriter.h"
+
+AsyncSampleWriter::AsyncSampleWriter(size_t capacity):
+    m_capacity(capacity),
+    m_busy(false),
+    m_stop(false),
+    m_thread(&AsyncSampleWriter::run, this)
+{
+}
+
+AsyncSampleWriter::~AsyncSampleWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_queued.notify_all();
+  m_thread.join();
+
+  //Nobody is left to report errors of the last tasks to
+  if(!m_error.empty())
+    std::cerr<<"AsyncSampleWriter - error: "<<m_error<<std::endl;
+}
+
+bool AsyncSampleWriter::enqueue(std::function<std::string()> task)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_taken.wait(lock, [this] { return m_tasks.size() < m_capacity; });
+    if(!m_error.empty()) return false;
+    m_tasks.push_back(std::move(task));
+  }
+  m_queued.notify_one();
+  return true;
+}
+
+bool AsyncSampleWriter::flush()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_taken.wait(lock, [this] { return m_tasks.empty() && !m_busy; });
+  return m_error.empty();
+}
+
+std::string AsyncSampleWriter::getError()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_error;
+}
+
+void AsyncSampleWriter::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while(true){
+    m_queued.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+    if(m_tasks.empty()) return; //Stopped and all tasks have run
+
+    std::function<std::string()> task = std::move(m_tasks.front());
+    m_tasks.pop_front();
+    m_busy = true;
+    lock.unlock();
+    m_taken.notify_all();
+
+    std::string error = task();
+
+    lock.lock();
+    if(m_error.empty()) m_error = error;
+    m_busy = false;
+    m_taken.notify_all();
+  }
+}
@@ -0,0 +1,81 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#ifndef KGS_ASYNCSAMPLEWRITER_H
+#define KGS_ASYNCSAMPLEWRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Runs output tasks on a background thread, so sampling doesn't wait for formatting and disk I/O.
+ * Tasks run in the order they were queued. They must only use data they own (e.g. copied positions)
+ * as the planner continues to modify molecules and configurations. Tasks must not exit the program: they
+ * return an error message instead, which enqueue and flush report on the thread that queues the output.
+ *
+ * The queue is bounded: when `capacity` tasks are waiting, enqueue blocks until the writer catches up,
+ * which limits the memory held by snapshots if the disk is slower than sampling.
+ */
+class AsyncSampleWriter {
+ public:
+  explicit AsyncSampleWriter(size_t capacity = 64);
+
+  /** Runs the remaining tasks and stops the writer thread */
+  ~AsyncSampleWriter();
+
+  /**
+   * Queue `task` for the writer thread. Blocks while the queue is full. `task` returns an empty string on
+   * success and an error message otherwise. Returns false without queuing if an earlier task failed (see getError).
+   */
+  bool enqueue(std::function<std::string()> task);
+
+  /** Wait until all queued tasks have run. Returns false if a task failed (see getError). */
+  bool flush();
+
+  /** Message of the first task that failed, or an empty string */
+  std::string getError();
+
+ private:
+  void run();
+
+  const size_t m_capacity;
+  std::deque<std::function<std::string()> > m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_queued;   ///< Signals the writer that a task (or shutdown) is ready
+  std::condition_variable m_taken;    ///< Signals enqueue and flush that the writer took or finished a task
+  bool m_busy;                        ///< The writer is running a task
+  bool m_stop;
+  std::string m_error;                ///< First error returned by a task
+  std::thread m_thread;
+};
+
+#endif //KGS_ASYNCSAMPLEWRITER_H
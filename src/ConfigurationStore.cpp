@@ -0,0 +1,263 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+
+#include "ConfigurationStore.h"
+#include "core/Atom.h"
+#include "core/Bond.h"
+#include "core/Configuration.h"
+#include "core/Molecule.h"
+#include "core/graph/KinTree.h"
+#include "core/dofs/DOF.h"
+
+using namespace std;
+
+namespace {
+  const char STORE_MAGIC[8] = {'K','G','S','C','O','N','F','1'};
+  const uint32_t SINGLE_PRECISION = 1;
+  const uint32_t DELTA_CODING = 2;
+  const uint8_t RECORD_DELTA = 1;    ///< Record values are relative to the last record with the parent id
+
+  /** FNV-1a */
+  void hashBytes(uint64_t& hash, const void* data, size_t bytes){
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    for(size_t i=0;i<bytes;i++){
+      hash ^= p[i];
+      hash *= 1099511628211ULL;
+    }
+  }
+
+  template<typename T>
+  void readValue(ifstream& in, T& value){
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  }
+}
+
+ConfigurationStore::ConfigurationStore(const string& file, Molecule* mol, bool singlePrecision, bool deltaCoding,
+                                       size_t cacheSize):
+    m_numDOFs(mol->m_spanningTree->getNumDOFs()),
+    m_singlePrecision(singlePrecision),
+    m_deltaCoding(deltaCoding),
+    m_numRecords(0),
+    m_cacheSize(cacheSize)
+{
+  for(size_t i=0;i<file.length();i++){
+    if(file[i]=='/'){
+      mkdir(file.substr(0,i).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    }
+  }
+
+  m_out.open(file.c_str(), ios::binary | ios::trunc);
+  if(!m_out.is_open()){
+    cerr<<"ConfigurationStore - error: Cannot write to "<<file<<endl;
+    exit(-1);
+  }
+
+  uint64_t hash = moleculeHash(mol);
+  uint32_t numDOFs = (uint32_t)m_numDOFs;
+  uint32_t flags = (singlePrecision?SINGLE_PRECISION:0) | (deltaCoding?DELTA_CODING:0);
+  vector<int32_t> bonds = dofBonds(mol);
+  m_out.write(STORE_MAGIC, sizeof(STORE_MAGIC));
+  m_out.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+  m_out.write(reinterpret_cast<const char*>(&numDOFs), sizeof(numDOFs));
+  m_out.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+  m_out.write(reinterpret_cast<const char*>(bonds.data()), bonds.size()*sizeof(int32_t));
+  m_out.flush();
+
+  m_buffer.resize(m_numDOFs*sizeof(double));
+}
+
+ConfigurationStore::~ConfigurationStore()
+{
+  m_out.close();
+}
+
+void ConfigurationStore::append(Configuration* conf)
+{
+  if(conf->getNumDOFs()!=m_numDOFs){
+    cerr<<"ConfigurationStore::append - error: Configuration has "<<conf->getNumDOFs()<<" DOFs but store has "<<m_numDOFs<<endl;
+    exit(-1);
+  }
+
+  int32_t id = conf->m_id;
+  int32_t parentId = conf->getParent()==nullptr ? -1 : conf->getParent()->m_id;
+  const vector<double>* parentValues = nullptr;
+  if(m_deltaCoding && conf->getParent()!=nullptr){
+    auto pit = m_storedValues.find(parentId);
+    if(pit!=m_storedValues.end()){
+      parentValues = &pit->second.first;
+      m_recentIds.splice(m_recentIds.begin(), m_recentIds, pit->second.second);
+    }
+  }
+  uint8_t recordFlags = parentValues==nullptr ? 0 : RECORD_DELTA;
+
+  m_out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+  m_out.write(reinterpret_cast<const char*>(&parentId), sizeof(parentId));
+  m_out.write(reinterpret_cast<const char*>(&recordFlags), sizeof(recordFlags));
+  m_out.write(reinterpret_cast<const char*>(&conf->m_distanceToIni), sizeof(double));
+  m_out.write(reinterpret_cast<const char*>(&conf->m_distanceToParent), sizeof(double));
+
+  //Values as the reader will see them, so later children are coded against exactly those
+  vector<double> stored(m_numDOFs);
+  if(m_singlePrecision){
+    float* values = reinterpret_cast<float*>(m_buffer.data());
+    for(size_t i=0;i<m_numDOFs;i++){
+      double base = parentValues==nullptr ? 0.0 : (*parentValues)[i];
+      values[i] = (float)(conf->m_dofs[i]-base);
+      stored[i] = base+values[i];
+    }
+    m_out.write(m_buffer.data(), m_numDOFs*sizeof(float));
+  }else{
+    double* values = reinterpret_cast<double*>(m_buffer.data());
+    for(size_t i=0;i<m_numDOFs;i++){
+      double base = parentValues==nullptr ? 0.0 : (*parentValues)[i];
+      values[i] = conf->m_dofs[i]-base;
+      stored[i] = base+values[i];
+    }
+    m_out.write(m_buffer.data(), m_numDOFs*sizeof(double));
+  }
+  m_out.flush();
+
+  if(m_deltaCoding && m_cacheSize>0){
+    auto it = m_storedValues.find(id);
+    if(it==m_storedValues.end()){
+      //The parent values are no longer needed for this record, so the parent may be the one dropped
+      if(m_storedValues.size()>=m_cacheSize){
+        m_storedValues.erase(m_recentIds.back());
+        m_recentIds.pop_back();
+      }
+      m_recentIds.push_front(id);
+      it = m_storedValues.insert(make_pair(id, make_pair(vector<double>(), m_recentIds.begin()))).first;
+    }else{
+      m_recentIds.splice(m_recentIds.begin(), m_recentIds, it->second.second);
+    }
+    it->second.first.swap(stored);
+  }
+  m_numRecords++;
+}
+
+vector<Configuration*> ConfigurationStore::read(const string& file, Molecule* mol)
+{
+  ifstream in(file.c_str(), ios::binary);
+  if(!in.is_open()){
+    cerr<<"ConfigurationStore::read - error: Cannot open "<<file<<endl;
+    exit(-1);
+  }
+
+  char magic[sizeof(STORE_MAGIC)];
+  uint64_t hash;
+  uint32_t numDOFs, flags;
+  in.read(magic, sizeof(magic));
+  readValue(in, hash);
+  readValue(in, numDOFs);
+  readValue(in, flags);
+  if(!in || memcmp(magic, STORE_MAGIC, sizeof(STORE_MAGIC))!=0){
+    cerr<<"ConfigurationStore::read - error: "<<file<<" is not a configuration store"<<endl;
+    exit(-1);
+  }
+  if(numDOFs!=mol->m_spanningTree->getNumDOFs() || hash!=moleculeHash(mol)){
+    cerr<<"ConfigurationStore::read - error: "<<file<<" was written for a different molecule or spanning tree ";
+    cerr<<"("<<numDOFs<<" DOFs, molecule has "<<mol->m_spanningTree->getNumDOFs()<<")"<<endl;
+    exit(-1);
+  }
+  in.seekg(2*numDOFs*sizeof(int32_t), ios::cur);
+
+  bool singlePrecision = (flags & SINGLE_PRECISION)!=0;
+  vector<char> buffer(numDOFs*(singlePrecision?sizeof(float):sizeof(double)));
+  vector<Configuration*> ret;
+  map<int, Configuration*> byId;
+
+  while(true){
+    int32_t id, parentId;
+    uint8_t recordFlags;
+    double distanceToIni, distanceToParent;
+    readValue(in, id);
+    readValue(in, parentId);
+    readValue(in, recordFlags);
+    readValue(in, distanceToIni);
+    readValue(in, distanceToParent);
+    in.read(buffer.data(), buffer.size());
+    if(!in) break; //End of file, or a record cut short by an interrupted run
+
+    auto pit = byId.find(parentId);
+    Configuration* parent = (parentId<0 || pit==byId.end()) ? nullptr : pit->second;
+    if((recordFlags & RECORD_DELTA) && parent==nullptr){
+      cerr<<"ConfigurationStore::read - error: Record "<<ret.size()<<" in "<<file<<" is relative to missing parent "<<parentId<<endl;
+      exit(-1);
+    }
+
+    Configuration* conf = parent==nullptr ? new Configuration(mol) : new Configuration(parent);
+    conf->m_id = id;
+    conf->m_distanceToIni = distanceToIni;
+    conf->m_distanceToParent = distanceToParent;
+    for(size_t i=0;i<numDOFs;i++){
+      double value = singlePrecision ? reinterpret_cast<float*>(buffer.data())[i] : reinterpret_cast<double*>(buffer.data())[i];
+      double base = (recordFlags & RECORD_DELTA) ? parent->m_dofs[i] : 0.0;
+      conf->m_dofs[i] = base+value;
+    }
+
+    ret.push_back(conf);
+    byId[id] = conf;
+  }
+  return ret;
+}
+
+uint64_t ConfigurationStore::moleculeHash(Molecule* mol)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for(auto const& atom: mol->getAtoms()){
+    int32_t id = atom->getId();
+    hashBytes(hash, &id, sizeof(id));
+    hashBytes(hash, atom->getName().data(), atom->getName().size());
+    //Positions at the precision of PDB-files
+    int64_t pos[3] = {
+        (int64_t)std::llround(atom->m_referencePosition.x*1000.0),
+        (int64_t)std::llround(atom->m_referencePosition.y*1000.0),
+        (int64_t)std::llround(atom->m_referencePosition.z*1000.0) };
+    hashBytes(hash, pos, sizeof(pos));
+  }
+  vector<int32_t> bonds = dofBonds(mol);
+  hashBytes(hash, bonds.data(), bonds.size()*sizeof(int32_t));
+  return hash;
+}
+
+vector<int32_t> ConfigurationStore::dofBonds(Molecule* mol)
+{
+  vector<int32_t> bonds(2*mol->m_spanningTree->getNumDOFs(), -1);
+  for(auto const& edge: mol->m_spanningTree->m_edges){
+    if(edge->getDOF()==nullptr || edge->getBond()==nullptr) continue;
+    int dof = edge->getDOF()->getIndex();
+    bonds[2*dof]   = edge->getBond()->m_atom1->getId();
+    bonds[2*dof+1] = edge->getBond()->m_atom2->getId();
+  }
+  return bonds;
+}
@@ -0,0 +1,102 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#ifndef KGS_CONFIGURATIONSTORE_H
+#define KGS_CONFIGURATIONSTORE_H
+
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+class Configuration;
+class Molecule;
+
+/**
+ * Binary file of sampled configurations stored as DOF-values instead of atom positions. As a
+ * Configuration is fully determined by its DOF-values and the molecule, atom positions are regenerated
+ * on demand by forward kinematics (Configuration::updatedMolecule) after reading.
+ *
+ * The header holds a hash of the molecule and its spanning tree, the number of DOFs and the bond of each
+ * DOF, so a file can only be read with the molecule (and tree) it was written for. Each record holds the
+ * id and parent id of a configuration, its distances to the initial and parent configuration, and its
+ * DOF-values. Values are optionally stored in single precision and as differences to the parent, which
+ * compresses well and keeps a record at a few KB. Differences are taken to the parent values as they will
+ * be read back, so rounding errors don't accumulate along tree paths.
+ *
+ * Only the values of the most recently used configurations are kept for delta coding, so memory doesn't grow
+ * with the number of samples. Children of configurations that are no longer kept are stored as absolute values.
+ */
+class ConfigurationStore {
+ public:
+  /**
+   * Create `file`, replacing an existing one, for configurations of `mol`. The values of at most `cacheSize`
+   * configurations are kept as delta coding parents.
+   */
+  ConfigurationStore(const std::string& file, Molecule* mol, bool singlePrecision = true, bool deltaCoding = true,
+                     size_t cacheSize = 1024);
+
+  ~ConfigurationStore();
+
+  /**
+   * Append `conf`. If its parent was appended before its values are stored relative to the parent. Otherwise
+   * it becomes a root when reading.
+   */
+  void append(Configuration* conf);
+
+  size_t size() const { return m_numRecords; }
+
+  /**
+   * Read all configurations in `file` as configurations of `mol`, in the order they were appended. Parent links
+   * (and tree depths) are restored for parents in the file. Exits if the file was written for another molecule
+   * or spanning tree. The caller owns the returned configurations.
+   */
+  static std::vector<Configuration*> read(const std::string& file, Molecule* mol);
+
+  /** Hash of atoms, reference positions and spanning tree DOFs of `mol`. */
+  static uint64_t moleculeHash(Molecule* mol);
+
+ private:
+  /** Atom ids of the bond of each DOF, -1 for global DOFs */
+  static std::vector<int32_t> dofBonds(Molecule* mol);
+
+  std::ofstream m_out;
+  const size_t m_numDOFs;
+  const bool m_singlePrecision;
+  const bool m_deltaCoding;
+  size_t m_numRecords;
+  /** DOF-values of recently appended configurations as they will be read, and their position in m_recentIds */
+  std::map<int, std::pair<std::vector<double>, std::list<int>::iterator> > m_storedValues;
+  std::list<int> m_recentIds;                         ///< Ids in m_storedValues, most recently used first
+  const size_t m_cacheSize;
+  std::vector<char> m_buffer;
+};
+
+#endif //KGS_CONFIGURATIONSTORE_H
@@ -29,11 +29,15 @@ IN THE SOFTWARE.
 
 
 #include "string.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <sstream>
 #include <stdlib.h>
 #include <stdio.h>
 #include <iomanip>
@@ -46,6 +50,8 @@ IN THE SOFTWARE.
 #include <math/gsl_helpers.h>
 
 
+#include "AsyncSampleWriter.h"
+#include "ConfigurationStore.h"
 #include "CTKTimer.h"
 #include "IO.h"
 #include "core/Atom.h"
@@ -57,6 +63,7 @@ IN THE SOFTWARE.
 #include "DisjointSets.h"
 #include "Logger.h"
 #include "Selection.h"
+#include "TrajectoryWriter.h"
 #include "Color.h"
 #include "HbondIdentifier.h"
 #include "core/graph/KinTree.h"
@@ -546,6 +553,64 @@ Molecule* IO::readPdb (
   return molecule;
 }
 
+void IO::readPdbPositions(const std::string& pdb_file, const Molecule* layout, std::vector<Coordinate>& positions)
+{
+  ifstream pdb(pdb_file.c_str());
+  if(!pdb.good()) {
+    cerr<<"IO::readPdbPositions - Cannot read file "<<pdb_file<<endl;
+    exit(-1);
+  }
+
+  const vector<Atom*>& atoms = layout->getAtoms();
+  positions.resize(atoms.size());
+  vector<char> found(atoms.size(), 0);
+  size_t next = 0;
+  int atomCount = 0;
+
+  string line;
+  while(getline(pdb, line)) {
+    //Same parsing of ATOM/HETATM records as in readPdb
+    if( line.substr(0, 4) != "ATOM" && line.substr(0, 6) != "HETATM" ) continue;
+    ++atomCount;
+    int offset = 0;
+    if (atomCount >99999) //quick and dirty adaption for molecules with > 100000 atoms
+      offset = 1;
+    string chain_name = line.substr(21+offset, 1);
+    int res_id = atoi(line.substr(22+offset, 4).c_str());
+    string atom_name = Util::trim(line.substr(12+offset, 5));
+    if (atom_name == "OP3") continue;
+    if (atom_name.at(0) >= 49 && atom_name.at(0) <= 57) { // if the first char is 1-9
+      string temp_name(atom_name.substr(1, 3));
+      temp_name += atom_name.substr(0, 1);
+      atom_name = temp_name;
+    }
+
+    //Files written from the layout list atoms in the same order, so try the next atom before looking it up
+    size_t idx = next;
+    if( idx>=atoms.size() || atoms[idx]->getName()!=atom_name || atoms[idx]->getResidue()->getId()!=res_id ||
+        atoms[idx]->getResidue()->getChain()->getName()!=chain_name ) {
+      Atom* atom = layout->getAtom(chain_name, res_id, atom_name);
+      if(atom==nullptr) continue;
+      idx = std::find(atoms.begin(), atoms.end(), atom) - atoms.begin();
+    }
+
+    positions[idx] = Coordinate(atof(line.substr(30+offset, 8).c_str()),
+                                atof(line.substr(38+offset, 8).c_str()),
+                                atof(line.substr(46+offset, 8).c_str()));
+    found[idx] = 1;
+    next = idx+1;
+  }
+  pdb.close();
+
+  for(size_t i=0; i<atoms.size(); i++) {
+    if(!found[i]) {
+      cerr<<"IO::readPdbPositions - "<<pdb_file<<" has no atom "<<atoms[i]->getName()<<" in residue ";
+      cerr<<atoms[i]->getResidue()->getId()<<" of chain "<<atoms[i]->getResidue()->getChain()->getName()<<endl;
+      exit(-1);
+    }
+  }
+}
+
 //void IO::makeCovBond (Residue* res1, Residue* res2, string atom_name1, string atom_name2) {
 //  //TODO: None of this needs to be in IO. Create a function in Molecule that does this and call it directly
 //  Atom* atom1 = res1->getAtom(atom_name1);
@@ -959,61 +1024,99 @@ void IO::readHbonds(const std::string& hbondMethod, const std::string& hbondFile
 //
 //}
 
-void IO::writePdb (Molecule * molecule, string output_file_name) {
-  for(int i=0;i<output_file_name.length();i++){
-    if(output_file_name[i]=='/'){
-      mkdir(output_file_name.substr(0,i).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+void IO::makeParentDirectories(const string& file)
+{
+  //Samples are written to the same few directories, so check the closest one before trying to create each
+  size_t last = file.rfind('/');
+  if(last==string::npos || last==0) return;
+  struct stat info;
+  if(stat(file.substr(0,last).c_str(), &info)==0) return;
+
+  for(int i=0;i<file.length();i++){
+    if(file[i]=='/'){
+      mkdir(file.substr(0,i).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
     }
   }
+}
 
-  ofstream output(output_file_name.c_str());
-  if(!output.is_open()) {
-    //cerr<<"Cannot write to "<<output_file_name<<". You might need to create output directory first"<<endl;
+void IO::writePdb (Molecule * molecule, string output_file_name) {
+  vector<Coordinate> positions;
+  vector<float> bFactors;
+  positions.reserve(molecule->getAtoms().size());
+  bFactors.reserve(molecule->getAtoms().size());
+  for(auto const& atom: molecule->getAtoms()){
+    positions.push_back(atom->m_position);
+    bFactors.push_back(atom->getBFactor());
+  }
+  string remarks = molecule->m_conf==nullptr ? "" : pdbRemarks(molecule->m_conf);
+  if(!writePdb(*pdbAtoms(molecule), remarks, positions, bFactors, output_file_name)) {
     cerr<<"Cannot write to "<<output_file_name<<endl;
     exit(-1);
   }
+}
 
-  if(molecule->m_conf!=nullptr){
-    Configuration* c = molecule->m_conf;
-    output << "REMARK\tID = " << c->m_id << endl;
-    if(c->getParent() != nullptr)
-      output << "REMARK\tParent ID = " << c->getParent()->m_id << endl;
-    output << "REMARK\tTree depth = " << c->m_treeDepth << endl;
-    output<<"REMARK\tTree-path = ";
-    int count=0;
-    while(c->getParent() != nullptr && c->getParent() != c) { output << c->m_id << " "; c=c->getParent(); count++; }
-    output << c->m_id << endl;
-    //Use molecule->m_conf for all information
-    output<<"REMARK\tDistance_initial = "<<setprecision(3)<<molecule->m_conf->m_distanceToIni<<endl;
-    output<<"REMARK\tDistance to parent = "<<setprecision(3)<<molecule->m_conf->m_distanceToParent<<endl;
-    output<<"REMARK\tDistance to target = "<<setprecision(6)<<molecule->m_conf->m_distanceToTarget<<endl;
-    output<<"REMARK\tMax violation = "<<setprecision(3)<<molecule->m_conf->m_maxConstraintViolation<<endl;
-    output<<"REMARK\tClash prevention = "<<setprecision(3)<<molecule->m_conf->m_usedClashPrevention<<endl;
-    output<<"REMARK\tClash free dofs = "<<setprecision(3)<<molecule->m_conf->m_clashFreeDofs<<endl;
-    output<<"REMARK\tOverall dofs = "<<setprecision(3)<<molecule->m_conf->getNumDOFs()<<endl;
-    output<<"REMARK\tMin collision factor = "<<setprecision(3)<<molecule->m_conf->m_minCollisionFactor<<endl;
-    output<<"REMARK\tVdw energy = "<<setprecision(6)<<molecule->m_conf->m_vdwEnergy<<endl;
-  }
-//  for (vector<Atom*>::iterator atom_itr=molecule->getAtoms().begin(); atom_itr != molecule->getAtoms().end(); ++atom_itr) {
+shared_ptr<IO::PdbAtoms> IO::pdbAtoms(Molecule * molecule) {
+  shared_ptr<PdbAtoms> ret = make_shared<PdbAtoms>();
+  ret->prefixes.reserve(molecule->getAtoms().size());
+  ret->types.reserve(molecule->getAtoms().size());
   for(auto const& atom: molecule->getAtoms()){
-//    Atom* atom = *atom_itr;
     Residue* res = atom->getResidue();
     char buffer[100];
-//    int bigRBId = atom->getBiggerRigidbody()==nullptr?0:atom->getBiggerRigidbody()->id();
     string head = "ATOM  ";
     if (atom->isHetatm()) head = "HETATM";
-    sprintf(buffer,"%s%5d %-4s %3s %1s%4d    %8.3f%8.3f%8.3f  1.00%6.2f          %2s  ",
+    sprintf(buffer,"%s%5d %-4s %3s %1s%4d    ",
             head.c_str(),
             atom->getId(),atom->getName().c_str(),
-            res->getName().c_str(),res->getChain()->getName().c_str(),res->getId(),
-            atom->m_position.x,atom->m_position.y,atom->m_position.z,
-            atom->getBFactor(),
-//            bigRBId,
-            atom->getType().c_str() );
-    string line(buffer);
-    output << line << endl;
+            res->getName().c_str(),res->getChain()->getName().c_str(),res->getId());
+    ret->prefixes.push_back(buffer);
+    ret->types.push_back(atom->getType());
+  }
+  return ret;
+}
+
+string IO::pdbRemarks(Configuration* conf) {
+  ostringstream output;
+  Configuration* c = conf;
+  output << "REMARK\tID = " << c->m_id << endl;
+  if(c->getParent() != nullptr)
+    output << "REMARK\tParent ID = " << c->getParent()->m_id << endl;
+  output << "REMARK\tTree depth = " << c->m_treeDepth << endl;
+  output<<"REMARK\tTree-path = ";
+  while(c->getParent() != nullptr && c->getParent() != c) { output << c->m_id << " "; c=c->getParent(); }
+  output << c->m_id << endl;
+  output<<"REMARK\tDistance_initial = "<<setprecision(3)<<conf->m_distanceToIni<<endl;
+  output<<"REMARK\tDistance to parent = "<<setprecision(3)<<conf->m_distanceToParent<<endl;
+  output<<"REMARK\tDistance to target = "<<setprecision(6)<<conf->m_distanceToTarget<<endl;
+  output<<"REMARK\tMax violation = "<<setprecision(3)<<conf->m_maxConstraintViolation<<endl;
+  output<<"REMARK\tClash prevention = "<<setprecision(3)<<conf->m_usedClashPrevention<<endl;
+  output<<"REMARK\tClash free dofs = "<<setprecision(3)<<conf->m_clashFreeDofs<<endl;
+  output<<"REMARK\tOverall dofs = "<<setprecision(3)<<conf->getNumDOFs()<<endl;
+  output<<"REMARK\tMin collision factor = "<<setprecision(3)<<conf->m_minCollisionFactor<<endl;
+  output<<"REMARK\tVdw energy = "<<setprecision(6)<<conf->m_vdwEnergy<<endl;
+  return output.str();
+}
+
+bool IO::writePdb (const PdbAtoms& atoms, const string& remarks, const vector<Coordinate>& positions,
+                   const vector<float>& bFactors, const string& output_file_name) {
+  assert(positions.size()==atoms.prefixes.size() && bFactors.size()==atoms.prefixes.size());
+  makeParentDirectories(output_file_name);
+
+  ofstream output(output_file_name.c_str());
+  if(!output.is_open())
+    return false;
+
+  output << remarks;
+  for(size_t i=0; i<positions.size(); i++){
+    char buffer[100];
+    sprintf(buffer,"%8.3f%8.3f%8.3f  1.00%6.2f          %2s  ",
+            positions[i].x,positions[i].y,positions[i].z,
+            bFactors[i],
+            atoms.types[i].c_str() );
+    //No endl: flushing every line dominates the cost of writing large molecules
+    output << atoms.prefixes[i] << buffer << '\n';
   }
   output.close();
+  return !output.fail();
 }
 
 void IO::writeQ (Molecule *protein, Configuration* referenceConf, string output_file_name) {
@@ -2329,21 +2432,115 @@ std::vector< std::tuple<Atom*, Atom*, double> > IO::readRelativeDistances(const
   return ret;
 }
 
+bool IO::asyncOutput = true;
+
+/** The writer used by writeNewSample. Destroyed at exit after writing all queued samples. */
+static AsyncSampleWriter& sampleWriter() {
+  static AsyncSampleWriter writer;
+  return writer;
+}
+
+/** Queue `task` on the sample writer, exiting if it or an earlier task failed */
+static void enqueueSample(std::function<string()> task) {
+  if (!sampleWriter().enqueue(std::move(task))) {
+    cerr << "IO::writeNewSample - error: " << sampleWriter().getError() << endl;
+    exit(-1);
+  }
+}
+
+/**
+ * Atom records of `molecule`, formatted once and shared by all samples queued for it. Entries are keyed by
+ * unique molecule id and removed when the molecule is destroyed.
+ */
+static shared_ptr<const IO::PdbAtoms> cachedPdbAtoms(Molecule* molecule) {
+  static mutex recordsMutex;
+  static map<unsigned long, shared_ptr<const IO::PdbAtoms> > atomRecords;
+  static int listener = Molecule::addDestructionListener([](unsigned long id) {
+    lock_guard<mutex> lock(recordsMutex);
+    atomRecords.erase(id);
+  });
+  (void)listener;
+
+  lock_guard<mutex> lock(recordsMutex);
+  shared_ptr<const IO::PdbAtoms>& atoms = atomRecords[molecule->getUniqueId()];
+  if (!atoms || atoms->prefixes.size() != molecule->getAtoms().size())
+    atoms = IO::pdbAtoms(molecule);
+  return atoms;
+}
+
+void IO::setAsyncOutput(bool async) {
+  if (!async) flushSamples();
+  asyncOutput = async;
+}
+
+void IO::flushSamples() {
+  if (asyncOutput && !sampleWriter().flush()) {
+    cerr << "IO::flushSamples - error: " << sampleWriter().getError() << endl;
+    exit(-1);
+  }
+}
+
 void IO::writeNewSample(Configuration *conf, Configuration *ref, int sample_num, const string &workingDir, int saveData) {
 //	const string& out_path = ExploreOptions::getOptions()->workingDirectory;
   const string &out_path = workingDir;
   const string &name = conf->getMolecule()->getName();
-  string out_file = out_path + "output/" + name + "_new_" + std::to_string(static_cast<long long>(sample_num)) + ".pdb";
 
-  if (saveData > 0) {
+  //Concurrent planner trees write their samples from separate threads. This guards the writers below
+  //and the queue order of the sample writer.
+  static mutex outputMutex;
+  lock_guard<mutex> lock(outputMutex);
+
+  if (saveData == SAVE_TRAJECTORY) {
+    //One trajectory per output directory and molecule, kept open until exit
+    static map<string, unique_ptr<TrajectoryWriter> > trajectories;
+    string base = out_path + "output/" + name + "_samples";
+    unique_ptr<TrajectoryWriter>& trajectory = trajectories[base];
+    if (!trajectory)
+      trajectory.reset(new TrajectoryWriter(base + ".dcd", base + ".txt", conf->getMolecule()->getAtoms().size()));
+    trajectory->append(conf);
+    return;
+  }
 
-    Molecule *protein = conf->updatedMolecule();
+  if (saveData == SAVE_CONFIGURATIONS) {
+    //DOF-values only. See ConfigurationStore::read to regenerate structures
+    static map<string, unique_ptr<ConfigurationStore> > stores;
+    string file = out_path + "output/" + name + "_samples.kgsconf";
+    unique_ptr<ConfigurationStore>& store = stores[file];
+    if (!store)
+      store.reset(new ConfigurationStore(file, conf->getMolecule()));
+    store->append(conf);
+    return;
+  }
+  string out_file = out_path + "output/" + name + "_new_" + std::to_string(static_cast<long long>(sample_num)) + ".pdb";
+
+  if (saveData <= 0) return;
+
+  Molecule *protein = conf->updatedMolecule();
+  if (asyncOutput) {
+    //Atom records only depend on the molecule
+    shared_ptr<const PdbAtoms> records = cachedPdbAtoms(protein);
+
+    //Copy what the writer needs as the planner keeps modifying the molecule
+    shared_ptr<vector<Coordinate> > positions = make_shared<vector<Coordinate> >();
+    shared_ptr<vector<float> > bFactors = make_shared<vector<float> >();
+    positions->reserve(protein->getAtoms().size());
+    bFactors->reserve(protein->getAtoms().size());
+    for (auto const &atom: protein->getAtoms()) {
+      positions->push_back(atom->m_position);
+      bFactors->push_back(atom->getBFactor());
+    }
+    shared_ptr<string> remarks = make_shared<string>(pdbRemarks(protein->m_conf));
+    enqueueSample([records, remarks, positions, bFactors, out_file]() -> string {
+      if (!IO::writePdb(*records, *remarks, *positions, *bFactors, out_file))
+        return "Cannot write to " + out_file;
+      return string();
+    });
+  } else {
     IO::writePdb(protein, out_file);
   }
 
 
   if (saveData > 1) {
-    Molecule *protein = conf->updatedMolecule();
 
     string out_q = out_path + "output/" + name + "_q_" + std::to_string(static_cast<long long>(sample_num)) + ".txt";
 
@@ -2352,8 +2549,6 @@ void IO::writeNewSample(Configuration *conf, Configuration *ref, int sample_num,
 
 
   if (saveData > 2) {
-    Molecule *protein = conf->updatedMolecule();
-
     // Save Jacobian and Nullspace to file
     string outJac = out_path + "output/" + name + "_jac_" +
                     std::to_string(static_cast<long long>(sample_num))
@@ -2388,9 +2583,32 @@ void IO::writeNewSample(Configuration *conf, Configuration *ref, int sample_num,
     //gsl_vector_outtofile(conf->CycleNullSpace->singularValues,outSing);
 
     if (NullspaceSVD *derived = dynamic_cast<NullspaceSVD *>(conf->getNullspace())) {
-      gsl_vector_outtofile(derived->getSVD()->S, outSing);
-      gsl_matrix_outtofile(derived->getMatrix(),outJac);
-      gsl_matrix_outtofile(derived->getBasis(),outNull);
+      //Singular values are only written if they belong to this sample (see NullspaceSVD::updateFromPrior)
+      bool writeSingularValues = derived->isSVDCurrent();
+      if (asyncOutput) {
+        //The nullspace is updated in place by later samples, so the writer gets its own copies
+        shared_ptr<gsl_vector> S;
+        if (writeSingularValues)
+          S.reset(gsl_vector_copy(derived->getSVD()->S), gsl_vector_free);
+        shared_ptr<gsl_matrix> jacobian(gsl_matrix_copy(derived->getMatrix()), gsl_matrix_free);
+        shared_ptr<gsl_matrix> basis(gsl_matrix_copy(derived->getBasis()), gsl_matrix_free);
+        enqueueSample([S, jacobian, basis, outSing, outJac, outNull]() -> string {
+          if (S)
+            gsl_vector_outtofile(S.get(), outSing);
+          for (auto const& matrix: {make_pair(jacobian, outJac), make_pair(basis, outNull)}) {
+            ofstream output(matrix.second.c_str());
+            if (!output.is_open())
+              return "Cannot write to " + matrix.second;
+            gsl_matrix_out(matrix.first.get(), output);
+          }
+          return string();
+        });
+      } else {
+        if (writeSingularValues)
+          gsl_vector_outtofile(derived->getSVD()->S, outSing);
+        gsl_matrix_outtofile(derived->getMatrix(), outJac);
+        gsl_matrix_outtofile(derived->getBasis(), outNull);
+      }
     }
     IO::writeRBs(protein, rbFile);
     IO::writeStats(protein, statFile);
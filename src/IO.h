@@ -31,6 +31,7 @@ IN THE SOFTWARE.
 #ifndef IO_H
 #define IO_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -53,6 +54,13 @@ class IO {
       const Molecule *reference = nullptr
   );
 
+  /**
+   * Read only the atom positions of a PDB file with the same atoms as `layout`, e.g. a sample of a KGS run.
+   * positions[i] receives the position of layout->getAtoms()[i]. Much cheaper than readPdb as no molecule,
+   * bonds or residue profiles are built. Exits if an atom of `layout` is missing.
+   */
+  static void readPdbPositions(const std::string &pdb_file, const Molecule *layout, std::vector<Coordinate> &positions);
+
   static void readHbonds(const std::string &hbondMethod, const std::string &hbondFile, Molecule *mol);
 
 //	static void readDssp (Molecule * protein, std::string dssp_file);
@@ -60,6 +68,24 @@ class IO {
 //  static void readRigidbody (Molecule * molecule, Selection& movingResidues);
   static void writePdb(Molecule *molecule, std::string output_file_name);
 
+  /** The parts of a molecule's ATOM/HETATM records that don't depend on its configuration */
+  struct PdbAtoms {
+    std::vector<std::string> prefixes;  ///< Record name through residue number, up to the coordinates
+    std::vector<std::string> types;     ///< Element symbol at the end of the record
+  };
+
+  static std::shared_ptr<PdbAtoms> pdbAtoms(Molecule *molecule);
+
+  /** The REMARK lines written at the top of the PDB-file of `conf` */
+  static std::string pdbRemarks(Configuration *conf);
+
+  /**
+   * Write a PDB-file using the atom records in `atoms` with the given positions and b-factors. Returns false if
+   * the file can't be written, so the sample writer can report it on the sampling thread.
+   */
+  static bool writePdb(const PdbAtoms &atoms, const std::string &remarks, const std::vector<Coordinate> &positions,
+                       const std::vector<float> &bFactors, const std::string &output_file_name);
+
   static void writePyMolScript(Molecule *rigidified, std::string pdb_file, std::string output_file_name, Molecule* iniMolecule = nullptr);
 
   static void writePyMolrigidScript(std::string pdb_file, std::string output_file_name, Molecule* iniMolecule = nullptr);
@@ -91,10 +117,34 @@ class IO {
   static std::vector<std::tuple<Atom *, Atom *, double> >
   readRelativeDistances(const std::string &fname, Molecule *mol);
 
+  /** Value of saveData that appends samples to a binary trajectory (see TrajectoryWriter) instead of writing files per sample */
+  static const int SAVE_TRAJECTORY = -1;
+  /** Value of saveData that appends the DOF-values of samples to a ConfigurationStore instead of writing files per sample */
+  static const int SAVE_CONFIGURATIONS = -2;
+
+  /**
+   * Write the output selected by `saveData` for a new sample. May be called from several threads as
+   * long as they sample different molecules (e.g. concurrent planner trees); calls are serialized.
+   */
   static void
   writeNewSample(Configuration *conf, Configuration *ref, int sample_num, const std::string &workingDir, int saveData);
 
+  /**
+   * When enabled (the default), writeNewSample copies the positions of new samples and writes their
+   * PDB-files and matrices on a background thread (see AsyncSampleWriter). A file that can't be written
+   * exits the program on the next call to writeNewSample or flushSamples.
+   */
+  static void setAsyncOutput(bool async);
+
+  /** Wait until all sample files queued by writeNewSample have been written */
+  static void flushSamples();
+
  private:
+  /** Create the missing directories on the path to `file` */
+  static void makeParentDirectories(const std::string &file);
+
+  static bool asyncOutput;
+
 //	static void makeCovBond (Residue* res1, Residue* res2, std::string atom_name1, std::string atom_name2);
   static void readHbonds_dssr(Molecule *molecule, std::string dssrFile);
 
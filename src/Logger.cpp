@@ -29,30 +29,90 @@ IN THE SOFTWARE.
 
 using namespace std;
 
-Logger::Logger() {}
+LockedBuffer::LockedBuffer(ostream* target, mutex& mutex, bool lineBuffered):
+    m_target(target),
+    m_mutex(mutex),
+    m_lineBuffered(lineBuffered)
+{}
+
+LockedBuffer::~LockedBuffer(){
+  writePending();
+}
+
+int LockedBuffer::overflow(int c){
+  if(c!=traits_type::eof()){
+    char ch = traits_type::to_char_type(c);
+    xsputn(&ch, 1);
+  }
+  return traits_type::not_eof(c);
+}
+
+streamsize LockedBuffer::xsputn(const char* s, streamsize n){
+  if(!m_lineBuffered){
+    lock_guard<mutex> lock(m_mutex);
+    m_target->write(s, n);
+    return n;
+  }
+  m_pending.append(s, n);
+  if(m_pending.find('\n', m_pending.size()-n)!=string::npos)
+    writePending();
+  return n;
+}
+
+int LockedBuffer::sync(){
+  writePending();
+  lock_guard<mutex> lock(m_mutex);
+  m_target->flush();
+  return 0;
+}
+
+void LockedBuffer::writePending(){
+  if(m_pending.empty()) return;
+  lock_guard<mutex> lock(m_mutex);
+  m_target->write(m_pending.data(), m_pending.size());
+  m_pending.clear();
+}
+
+Logger::Logger(): m_mainThread(this_thread::get_id()) {}
 
 void Logger::enableLogger(const string& name, ostream& stream){
+  lock_guard<mutex> lock(m_mutex);
   activeLoggers[name] = &stream;
 }
 
 void Logger::disableLogger(const string& name){
+  lock_guard<mutex> lock(m_mutex);
   activeLoggers.erase(name);
 }
 
 
 ostream& Logger::log(const string& name){
-  if( !loggerEnabled(name) )
-    return drain;
-
-  return *(activeLoggers[name]);
+  static thread_local onullstream drain;
+  static thread_local map<ostream*, unique_ptr<olockedstream> > streams;
+
+  ostream* target;
+  {
+    lock_guard<mutex> lock(m_mutex);
+    auto it = activeLoggers.find(name);
+    if( it==activeLoggers.end() )
+      return drain;
+    target = it->second;
+  }
+
+  unique_ptr<olockedstream>& stream = streams[target];
+  if(!stream)
+    stream.reset(new olockedstream(target, m_mutex, this_thread::get_id()!=m_mainThread));
+  return *stream;
 }
 
 Logger* Logger::getInstance(){
-  if(Logger::instance==nullptr) Logger::instance = new Logger();
+  static once_flag created;
+  call_once(created, [](){ Logger::instance = new Logger(); });
   return Logger::instance;
 }
 
 bool Logger::loggerEnabled(const string& name){
+  lock_guard<mutex> lock(m_mutex);
   return activeLoggers.count(name)!=0;
 }
 
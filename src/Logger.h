@@ -29,7 +29,10 @@ IN THE SOFTWARE.
 #define LOGGER_H
 
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <iostream>
 
 
@@ -112,6 +115,41 @@ class onullstream : public std::ostream {
   NullBuffer m_sb;
 };
 
+/**
+ * Forwards output to a stream shared by several threads while holding `mutex`. If `lineBuffered`
+ * output is collected until a newline or flush so lines of different threads are not interleaved.
+ */
+class LockedBuffer : public std::streambuf
+{
+ public:
+  LockedBuffer(std::ostream* target, std::mutex& mutex, bool lineBuffered);
+  ~LockedBuffer();
+ protected:
+  int overflow(int c) override;
+  std::streamsize xsputn(const char* s, std::streamsize n) override;
+  int sync() override;
+ private:
+  void writePending();
+
+  std::ostream* m_target;
+  std::mutex& m_mutex;
+  bool m_lineBuffered;
+  std::string m_pending;
+};
+
+class olockedstream : public std::ostream {
+ public:
+  //The base is constructed before m_sb, so the buffer is only attached once m_sb exists
+  olockedstream(std::ostream* target, std::mutex& mutex, bool lineBuffered) :
+      std::ostream(nullptr),
+      m_sb(target, mutex, lineBuffered)
+  {
+    rdbuf(&m_sb);
+  }
+ private:
+  LockedBuffer m_sb;
+};
+
 
 /* A logger class for maintaining log output. Each call to log returns an ostream associated with the
    supplied logger-name. Depending on the logger-name the message can be suppressed or propagated.
@@ -131,6 +169,10 @@ class onullstream : public std::ostream {
    log()<<"Message 6"<<endl;			//Will be printed to cout
 
    If no logger-name is supplied "default" is assumed. The "default" logger is DISABLED by default.
+
+   log may be called from several threads. Each thread gets its own stream for each target, and writes
+   to the target are serialized. Output from threads other than the one that created the logger is
+   held back until the end of each line.
 */
 class Logger{
 public:
@@ -152,7 +194,8 @@ public:
 private:
     Logger();
     std::map<std::string, std::ostream*> activeLoggers;
-    onullstream drain;
+    std::mutex m_mutex;           ///< Guards activeLoggers and writes to the streams in it
+    std::thread::id m_mainThread; ///< Thread whose output is not line buffered
     static Logger* instance;
 };
 
@@ -0,0 +1,121 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int numThreads):
+    m_task(nullptr),
+    m_count(0),
+    m_perThread(false),
+    m_next(0),
+    m_finished(0),
+    m_batch(0),
+    m_stop(false)
+{
+  if(numThreads==0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  for(unsigned int t=0; t<numThreads; t++)
+    m_threads.emplace_back(&ThreadPool::workerLoop, this, t);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for(auto& thread: m_threads)
+    thread.join();
+}
+
+unsigned int ThreadPool::size() const
+{
+  return m_threads.size();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, unsigned int)>& task)
+{
+  if(count==0) return;
+  runBatch(count, task, false);
+}
+
+void ThreadPool::forEachThread(const std::function<void(unsigned int)>& task)
+{
+  runBatch(m_threads.size(), [&task](size_t, unsigned int thread){ task(thread); }, true);
+}
+
+void ThreadPool::runBatch(size_t count, const std::function<void(size_t, unsigned int)>& task, bool perThread)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_task = &task;
+  m_count = count;
+  m_perThread = perThread;
+  m_next = 0;
+  m_finished = 0;
+  m_batch++;
+  m_wake.notify_all();
+
+  m_done.wait(lock, [this]{ return m_finished==m_threads.size(); });
+  m_task = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned int thread)
+{
+  unsigned long lastBatch = 0;
+  while(true){
+    const std::function<void(size_t, unsigned int)>* task;
+    size_t count;
+    bool perThread;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [&]{ return m_stop || m_batch!=lastBatch; });
+      if(m_stop) return;
+      lastBatch = m_batch;
+      task = m_task;
+      count = m_count;
+      perThread = m_perThread;
+    }
+
+    if(perThread){
+      (*task)(thread, thread);
+    }else{
+      for(size_t i = m_next++; i<count; i = m_next++)
+        (*task)(i, thread);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_finished++;
+    }
+    m_done.notify_one();
+  }
+}
@@ -0,0 +1,85 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#ifndef KGS_THREADPOOL_H
+#define KGS_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of worker threads that run batches of independent tasks. The workers are started
+ * once and sleep between batches, so planners can hand out a batch per iteration without paying
+ * for thread creation each time.
+ *
+ * Tasks are taken from a shared counter so a slow task (e.g. a move that needs many clash-avoiding
+ * trial steps) doesn't hold up the tasks queued behind it. Tasks must not throw.
+ */
+class ThreadPool {
+ public:
+  /** Start `numThreads` workers. 0 means one per hardware thread. */
+  explicit ThreadPool(unsigned int numThreads = 0);
+
+  ~ThreadPool();
+
+  /** Number of worker threads */
+  unsigned int size() const;
+
+  /**
+   * Call `task(i, thread)` for each i in [0, count) and return when all calls have finished. The
+   * `thread` argument is the index (in [0, size())) of the worker running the task, which callers
+   * use to pick per-thread state such as a KinematicWorkspace. Batches must not be nested.
+   */
+  void parallelFor(size_t count, const std::function<void(size_t, unsigned int)>& task);
+
+  /** Call `task(thread)` exactly once on every worker, e.g. to release per-thread state on the thread that made it. */
+  void forEachThread(const std::function<void(unsigned int)>& task);
+
+ private:
+  void workerLoop(unsigned int thread);
+  void runBatch(size_t count, const std::function<void(size_t, unsigned int)>& task, bool perThread);
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;     ///< Signals workers that a new batch (or shutdown) is ready
+  std::condition_variable m_done;     ///< Signals parallelFor that all workers finished the batch
+
+  const std::function<void(size_t, unsigned int)>* m_task;
+  size_t m_count;
+  bool m_perThread;                   ///< Each worker runs m_task once instead of claiming indices
+  std::atomic<size_t> m_next;         ///< Next unclaimed task of the current batch
+  unsigned int m_finished;            ///< Workers done with the current batch
+  unsigned long m_batch;              ///< Incremented for each batch so workers can tell it's new
+  bool m_stop;
+};
+
+#endif //KGS_THREADPOOL_H
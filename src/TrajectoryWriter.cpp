@@ -0,0 +1,139 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sys/stat.h>
+
+#include "TrajectoryWriter.h"
+#include "core/Atom.h"
+#include "core/Configuration.h"
+#include "core/Molecule.h"
+
+using namespace std;
+
+namespace {
+  const int DCD_HEADER_SIZE = 84;
+  const int DCD_NSET_OFFSET = 8;     ///< Frame count, after the record marker and "CORD"
+  const int DCD_NSTEP_OFFSET = 20;   ///< Number of steps, equal to the frame count here
+}
+
+TrajectoryWriter::TrajectoryWriter(const string& dcdFile, const string& tableFile, size_t numAtoms):
+    m_numAtoms(numAtoms),
+    m_numFrames(0),
+    m_buffer(new float[numAtoms])
+{
+  for(size_t i=0;i<dcdFile.length();i++){
+    if(dcdFile[i]=='/'){
+      mkdir(dcdFile.substr(0,i).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    }
+  }
+
+  m_dcd.open(dcdFile.c_str(), ios::binary | ios::trunc);
+  m_table.open(tableFile.c_str(), ios::trunc);
+  if(!m_dcd.is_open() || !m_table.is_open()){
+    cerr<<"TrajectoryWriter - error: Cannot write to "<<dcdFile<<" or "<<tableFile<<endl;
+    exit(-1);
+  }
+
+  //Header: "CORD" and 20 control words. Only frame count, steps between frames, atom count and version are set
+  char header[DCD_HEADER_SIZE];
+  memset(header, 0, DCD_HEADER_SIZE);
+  memcpy(header, "CORD", 4);
+  int* control = reinterpret_cast<int*>(header+4);
+  control[2] = 1;    //NSAVC: steps between frames
+  control[19] = 24;  //CHARMM version
+  writeRecord(header, DCD_HEADER_SIZE);
+
+  char titles[4+2*80];
+  memset(titles, ' ', sizeof(titles));
+  int numTitles = 2;
+  memcpy(titles, &numTitles, 4);
+  const char* title1 = "REMARKS KGS samples. Metadata of each frame is in the sample table";
+  const char* title2 = "REMARKS Atom order follows the initial structure";
+  memcpy(titles+4, title1, strlen(title1));
+  memcpy(titles+4+80, title2, strlen(title2));
+  writeRecord(titles, sizeof(titles));
+
+  int natom = (int)m_numAtoms;
+  writeRecord(&natom, 4);
+
+  m_table<<"frame\tid\tparent\tdepth\tdistance_initial\tdistance_parent\tdistance_target\tvdw_energy"<<endl;
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+  m_dcd.close();
+  m_table.close();
+  delete[] m_buffer;
+}
+
+void TrajectoryWriter::append(Configuration* conf)
+{
+  Molecule* mol = conf->updatedMolecule();
+  const vector<Atom*>& atoms = mol->getAtoms();
+  if(atoms.size()!=m_numAtoms){
+    cerr<<"TrajectoryWriter::append - error: Frame has "<<atoms.size()<<" atoms but trajectory has "<<m_numAtoms<<endl;
+    exit(-1);
+  }
+
+  for(size_t i=0;i<m_numAtoms;i++) m_buffer[i] = (float)atoms[i]->m_position.x;
+  writeRecord(m_buffer, (int)(m_numAtoms*sizeof(float)));
+  for(size_t i=0;i<m_numAtoms;i++) m_buffer[i] = (float)atoms[i]->m_position.y;
+  writeRecord(m_buffer, (int)(m_numAtoms*sizeof(float)));
+  for(size_t i=0;i<m_numAtoms;i++) m_buffer[i] = (float)atoms[i]->m_position.z;
+  writeRecord(m_buffer, (int)(m_numAtoms*sizeof(float)));
+  m_numFrames++;
+  updateHeader();
+
+  Configuration* parent = conf->getParent();
+  m_table<<m_numFrames-1<<"\t"<<conf->m_id<<"\t"<<(parent==nullptr?-1:parent->m_id)<<"\t"<<conf->m_treeDepth;
+  m_table<<setprecision(6)<<"\t"<<conf->m_distanceToIni<<"\t"<<conf->m_distanceToParent;
+  m_table<<"\t"<<conf->m_distanceToTarget<<"\t"<<conf->m_vdwEnergy<<"\n";
+  m_table.flush();
+}
+
+void TrajectoryWriter::writeRecord(const void* data, int bytes)
+{
+  //Fortran unformatted record: payload framed by its length
+  m_dcd.write(reinterpret_cast<const char*>(&bytes), 4);
+  m_dcd.write(reinterpret_cast<const char*>(data), bytes);
+  m_dcd.write(reinterpret_cast<const char*>(&bytes), 4);
+}
+
+void TrajectoryWriter::updateHeader()
+{
+  int frames = (int)m_numFrames;
+  m_dcd.seekp(DCD_NSET_OFFSET);
+  m_dcd.write(reinterpret_cast<const char*>(&frames), 4);
+  m_dcd.seekp(DCD_NSTEP_OFFSET);
+  m_dcd.write(reinterpret_cast<const char*>(&frames), 4);
+  m_dcd.seekp(0, ios::end);
+  m_dcd.flush();
+}
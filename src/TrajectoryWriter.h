@@ -0,0 +1,70 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#ifndef KGS_TRAJECTORYWRITER_H
+#define KGS_TRAJECTORYWRITER_H
+
+#include <fstream>
+#include <string>
+
+class Configuration;
+
+/**
+ * Appends sampled configurations as frames of a single binary trajectory in the CHARMM/NAMD DCD
+ * format, so large runs don't produce a PDB file per sample. Per-sample information that would
+ * otherwise be in the PDB REMARKs (id, parent, tree depth, distances, energy) goes to a tab-separated
+ * side table with one line per frame.
+ *
+ * The frame count in the header is updated after every frame so the trajectory stays readable
+ * (e.g. by VMD, MDAnalysis or catdcd) if sampling is interrupted. Atom order is that of
+ * Molecule::getAtoms(), so the initial PDB serves as topology.
+ */
+class TrajectoryWriter {
+ public:
+  /** Create `dcdFile` and `tableFile`, replacing existing files, for frames of `numAtoms` atoms. */
+  TrajectoryWriter(const std::string& dcdFile, const std::string& tableFile, size_t numAtoms);
+
+  ~TrajectoryWriter();
+
+  /** Append the atom positions of `conf` and a line with its metadata. */
+  void append(Configuration* conf);
+
+  size_t numFrames() const { return m_numFrames; }
+
+ private:
+  void writeRecord(const void* data, int bytes);
+  void updateHeader();
+
+  std::ofstream m_dcd;
+  std::ofstream m_table;
+  const size_t m_numAtoms;
+  size_t m_numFrames;
+  float* m_buffer;           ///< One coordinate axis of a frame
+};
+
+#endif //KGS_TRAJECTORYWRITER_H
@@ -354,6 +354,11 @@ int main( int argc, char* argv[] ) {
   }
   planner->initialize(randMove, metric, options.workingDirectory, options.saveData);
 
+  if(options.checkpointInterval > 0)
+    planner->setCheckpointing(options.workingDirectory + "output/" + protein->getName() + "_checkpoint.kgsckpt", options.checkpointInterval);
+  if(!options.resume.empty())
+    planner->resume(options.resume);
+
   //Use the planner "wrapper" function generateSamples() with its 3 stages approach, navigate, explore
   planner->generateSamples();
 
@@ -33,8 +33,10 @@ IN THE SOFTWARE.
 #include <sstream>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <gsl/gsl_math.h>
 #include <gsl/gsl_eigen.h>
+#include <gsl/gsl_blas.h>
 
 #include "metrics/RMSD.h"
 #include "IO.h"
@@ -52,7 +54,8 @@ Molecule * readProtein(char* path){
 	return protein;
 }
 
-double torsion(Bond * bond){
+/** The four atoms defining the torsion of `bond`, using the neighbors with the smallest names */
+void torsionAtoms(Bond * bond, Atom* quad[4]){
 	Atom *a1,*a2,*a3,*a4;
 	a2 = bond->m_atom1;
 	a3 = bond->m_atom2;
@@ -61,8 +64,13 @@ double torsion(Bond * bond){
 	for(int i=1;i<a2->Cov_neighbor_list.size();i++) if( a2->Cov_neighbor_list[i]!=a3 && a2->Cov_neighbor_list[i]->getName()<a1->getName() ) a1 = a2->Cov_neighbor_list[i];
 	a4 = a3->Cov_neighbor_list[0]; if(a4==a2) a4 = a3->Cov_neighbor_list[1];
 	for(int i=1;i<a3->Cov_neighbor_list.size();i++) if( a3->Cov_neighbor_list[i]!=a2 && a3->Cov_neighbor_list[i]->getName()<a4->getName() ) a4 = a3->Cov_neighbor_list[i];
+	quad[0] = a1; quad[1] = a2; quad[2] = a3; quad[3] = a4;
+}
 
-	double torsion = TorsionalAngle(a1->m_position, a2->m_position, a3->m_position, a4->m_position);
+double torsion(Bond * bond){
+	Atom* quad[4];
+	torsionAtoms(bond, quad);
+	double torsion = TorsionalAngle(quad[0]->m_position, quad[1]->m_position, quad[2]->m_position, quad[3]->m_position);
 	return torsion;
 }
 
@@ -140,10 +148,204 @@ void collectConfigurations(Molecule * native, int arrSz, char* fileList[], vecto
 	}
 }
 
+/** A torsional DOF of the native and the indices (in Molecule::getAtoms) of the atoms defining it */
+struct TorsionQuad {
+	int dof;
+	size_t atoms[4];
+	double nativeTorsion;
+};
+
+/** Add the scatter of the first `rows` rows of `block` to the running mean and scatter matrix (upper triangle) */
+void accumulateBlock(gsl_matrix* block, size_t rows, size_t& count, gsl_vector* mean, gsl_matrix* scatter){
+	if(rows==0) return;
+	size_t n = block->size2;
+	gsl_matrix_view X = gsl_matrix_submatrix(block, 0, 0, rows, n);
+	gsl_vector* blockMean = gsl_vector_calloc(n);
+	for(size_t r=0;r<rows;r++){
+		gsl_vector_view row = gsl_matrix_row(&X.matrix, r);
+		gsl_vector_add(blockMean, &row.vector);
+	}
+	gsl_vector_scale(blockMean, 1.0/rows);
+	for(size_t r=0;r<rows;r++){
+		gsl_vector_view row = gsl_matrix_row(&X.matrix, r);
+		gsl_vector_sub(&row.vector, blockMean);
+	}
+
+	//Chan et al.'s pairwise update: scatter += X^T X + (count*rows/(count+rows)) * delta delta^T
+	gsl_blas_dsyrk(CblasUpper, CblasTrans, 1.0, &X.matrix, 1.0, scatter);
+	gsl_vector_sub(blockMean, mean); //blockMean is now delta
+	gsl_blas_dsyr(CblasUpper, double(count)*rows/(count+rows), blockMean, scatter);
+	gsl_blas_daxpy(double(rows)/(count+rows), blockMean, mean);
+	count += rows;
+	gsl_vector_free(blockMean);
+}
+
+/** The torsional DOFs of `native` with the atoms defining them */
+vector<TorsionQuad> torsionQuads(Molecule * native){
+	unordered_map<Atom*, size_t> atomIndex;
+	for(size_t i=0;i<native->getAtoms().size();i++) atomIndex[native->getAtoms()[i]] = i;
+
+	vector<TorsionQuad> quads;
+	for(auto const& e: native->m_spanningTree->m_edges){
+		TorsionQuad quad;
+		Atom* atoms[4];
+		torsionAtoms(e->getBond(), atoms);
+		quad.dof = e->getDOF()->getIndex();
+		for(int k=0;k<4;k++) quad.atoms[k] = atomIndex[atoms[k]];
+		quad.nativeTorsion = torsion(e->getBond());
+		quads.push_back(quad);
+	}
+	return quads;
+}
+
+/** Read the torsions of `file` relative to the native into `row`, which has an entry per DOF */
+void readTorsions(char* file, Molecule * native, const vector<TorsionQuad>& quads, vector<Coordinate>& positions, gsl_vector* row){
+	IO::readPdbPositions(file, native, positions);
+	gsl_vector_set_zero(row);
+
+	for(auto const& quad: quads){
+		double strucTorsion = TorsionalAngle(positions[quad.atoms[0]], positions[quad.atoms[1]],
+		                                     positions[quad.atoms[2]], positions[quad.atoms[3]]);
+		double diff = strucTorsion-quad.nativeTorsion;
+		if(diff<-CTK_PI) diff+=2*CTK_PI;
+		if(diff>CTK_PI) diff-=2*CTK_PI;
+		if(diff>3.15){
+			cout<<"KinEdge: ";
+			cout<<quad.dof<<" .. "<<diff<<" .. "<<strucTorsion<<" .. "<<quad.nativeTorsion<<endl;
+			exit(-1);
+		}
+		gsl_vector_set(row, quad.dof, diff);
+	}
+}
+
+/**
+ * Same covariance and average as collectConfigurations followed by the covariance loops, but structures are
+ * read one at a time without building molecules or trees. Torsions are computed from the positions of atom
+ * quads found once on the native, and mean and covariance are updated in blocks of structures, so memory
+ * doesn't depend on the number of structures.
+ */
+size_t streamCovariance(Molecule * native, int arrSz, char* fileList[], int n, double* cov, double* avg){
+	vector<TorsionQuad> quads = torsionQuads(native);
+
+	const size_t blockSize = 64;
+	gsl_matrix* block = gsl_matrix_alloc(blockSize, n);
+	gsl_matrix_view scatter = gsl_matrix_view_array(cov, n, n);
+	gsl_vector_view mean = gsl_vector_view_array(avg, n);
+	gsl_matrix_set_zero(&scatter.matrix);
+	gsl_vector_set_zero(&mean.vector);
+
+	vector<Coordinate> positions;
+	size_t count = 0, rows = 0;
+	for(int i=0;i<arrSz;i++){
+		gsl_vector_view row = gsl_matrix_row(block, rows);
+		readTorsions(fileList[i], native, quads, positions, &row.vector);
+
+		if(++rows==blockSize){
+			accumulateBlock(block, rows, count, &mean.vector, &scatter.matrix);
+			rows = 0;
+		}
+		cout<<".";cout.flush();
+	}
+	accumulateBlock(block, rows, count, &mean.vector, &scatter.matrix);
+	gsl_matrix_free(block);
+
+	for(int i=0;i<n;i++)
+		for(int j=i;j<n;j++){
+			cov[i*n+j]/=count;
+			cov[j*n+i]=cov[i*n+j];
+		}
+	return count;
+}
+
+/** Modified Gram-Schmidt on the columns of A */
+void orthonormalizeColumns(gsl_matrix* A){
+	for(size_t c=0;c<A->size2;c++){
+		gsl_vector_view col = gsl_matrix_column(A, c);
+		for(size_t p=0;p<c;p++){
+			gsl_vector_view prev = gsl_matrix_column(A, p);
+			double dot;
+			gsl_blas_ddot(&prev.vector, &col.vector, &dot);
+			gsl_blas_daxpy(-dot, &prev.vector, &col.vector);
+		}
+		double norm = gsl_blas_dnrm2(&col.vector);
+		if(norm>1e-12) gsl_vector_scale(&col.vector, 1.0/norm);
+		else gsl_vector_set_zero(&col.vector);
+	}
+}
+
+/**
+ * Leading `eval->size` principal components of the column-centred data matrix X (samples x DOFs) by
+ * randomized SVD (Halko, Martinsson and Tropp 2011) with 10 extra samples and two power iterations.
+ * The covariance matrix is never formed. Eigenvalues of the covariance go to `eval` and the components
+ * to the columns of `evec` (DOFs x components).
+ */
+void randomizedPCA(gsl_matrix* X, gsl_vector* eval, gsl_matrix* evec){
+	size_t m = X->size1, n = X->size2, k = eval->size;
+	size_t l = std::min(k+10, std::min(m, n));
+
+	//Range of X from random projections
+	gsl_matrix* omega = gsl_matrix_alloc(n, l);
+	for(size_t i=0;i<n;i++) for(size_t j=0;j<l;j++) gsl_matrix_set(omega, i, j, RandomN1P1());
+	gsl_matrix* Y = gsl_matrix_alloc(m, l);
+	gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, X, omega, 0.0, Y);
+	for(int it=0;it<2;it++){
+		orthonormalizeColumns(Y);
+		gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, X, Y, 0.0, omega);
+		orthonormalizeColumns(omega);
+		gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, X, omega, 0.0, Y);
+	}
+	orthonormalizeColumns(Y);
+
+	//X ~ Y*B with B^T = X^T*Y (n x l). The right singular vectors of X come from the small l x l matrix B*B^T.
+	gsl_matrix* Bt = omega;
+	gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, X, Y, 0.0, Bt);
+	gsl_matrix* G = gsl_matrix_alloc(l, l);
+	gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, Bt, Bt, 0.0, G);
+	gsl_vector* lambda = gsl_vector_alloc(l);
+	gsl_matrix* W = gsl_matrix_alloc(l, l);
+	gsl_eigen_symmv_workspace* w = gsl_eigen_symmv_alloc(l);
+	gsl_eigen_symmv(G, lambda, W, w);
+	gsl_eigen_symmv_free(w);
+	gsl_eigen_symmv_sort(lambda, W, GSL_EIGEN_SORT_VAL_DESC);
+
+	gsl_matrix_set_zero(evec);
+	for(size_t c=0;c<k && c<l;c++){
+		double lambda_c = std::max(gsl_vector_get(lambda, c), 0.0);
+		gsl_vector_set(eval, c, lambda_c/m);
+		if(lambda_c<=0.0) continue;
+		gsl_vector_view w_c = gsl_matrix_column(W, c);
+		gsl_vector_view v_c = gsl_matrix_column(evec, c);
+		gsl_blas_dgemv(CblasNoTrans, 1.0/std::sqrt(lambda_c), Bt, &w_c.vector, 0.0, &v_c.vector);
+	}
+
+	gsl_matrix_free(W);
+	gsl_vector_free(lambda);
+	gsl_matrix_free(G);
+	gsl_matrix_free(Y);
+	gsl_matrix_free(omega);
+}
+
 int main(int argc, char* argv[]){
+	bool streaming = false;
+	int components = 0;
+	string program = argv[0];
+	while(argc>1 && string(argv[1]).compare(0, 2, "--")==0){
+		string arg = argv[1];
+		if(arg=="--streaming"){ streaming = true; argc--; argv++; }
+		else if(arg=="--components" && argc>2){ components = atoi(argv[2]); argc-=2; argv+=2; }
+		else{ cerr<<"Unknown option "<<arg<<endl; return -1; }
+	}
+	if(streaming && components>0){
+		//The randomized SVD needs the whole torsion matrix, which --streaming is meant to avoid
+		cerr<<"--streaming and --components can't be combined"<<endl;
+		return -1;
+	}
 	if(argc<3){
-        cout<<"Usage: "<<argv[0]<<" <native pdb> <pdb-list>"<<endl;
+        cout<<"Usage: "<<program<<" [--streaming] [--components <k>] <native pdb> <pdb-list>"<<endl;
         cout<<"Computes PCA of degrees of freedom. Outputs deformability and mobility as b-factors."<<endl;
+        cout<<"With --streaming only coordinates of the ensemble are read and memory doesn't grow with its size."<<endl;
+        cout<<"With --components only the k leading components are computed by randomized SVD of the ensemble"<<endl;
+        cout<<"torsions, without forming the covariance matrix. Suited for many DOFs. Can't be used with --streaming."<<endl;
         return -1;
     }
 	cout<<"Using "<<argv[1]<<" as native (wont be included in ensemble PCA)."<<endl;
@@ -152,55 +354,99 @@ int main(int argc, char* argv[]){
 	Molecule * native = readProtein(argv[1]);
 	//native->BackupAtomPos();
 
-	vector<Configuration*> configurations;
-	vector<Molecule *> proteins;
-	collectConfigurations(native, argc-2, &(argv[2]), configurations, proteins);
-	cout<<"done. Total: "<<configurations.size()<<endl;
-
-	cout<<"Calculating covariance matrix .. ";
 	int n = native->m_spanningTree->getNumDOFs();
-	double* cov = new double[n*n];
 	double* avg = new double[n];
-	for(int i=0;i<n;i++){ avg[i]=0; for(int j=0;j<n;j++) cov[i*n+j] = 0; }
-
-	for(vector<Configuration*>::iterator cit=configurations.begin(); cit!=configurations.end(); cit++){
-		for(int i=0;i<n;i++){
-			double val = (*cit)->m_dofs[i];
-			if(val>3.1416){
-				cerr<<"Error: dof["<<i<<"] = "<<val<<endl;
-				exit(-1);
-			}
-			avg[i]+= val;
+	double totalVariance = 0.0;
+	gsl_vector *eval;
+	gsl_matrix *evec;
+
+	if(components>0){
+		//Centred data matrix of torsions (structures x DOFs)
+		vector<TorsionQuad> quads = torsionQuads(native);
+		vector<Coordinate> positions;
+		int m = argc-2;
+		gsl_matrix* X = gsl_matrix_alloc(m, n);
+		for(int i=0;i<m;i++){
+			gsl_vector_view row = gsl_matrix_row(X, i);
+			readTorsions(argv[2+i], native, quads, positions, &row.vector);
+			cout<<".";cout.flush();
 		}
-	}
-	for(int i=0;i<n;i++){ avg[i]/=configurations.size();}
-	for(int i=0;i<n;i++)
-		for(int j=i;j<n;j++){
+		cout<<"done. Total: "<<m<<endl;
+
+		for(int j=0;j<n;j++){
+			gsl_vector_view col = gsl_matrix_column(X, j);
+			double mean = 0.0;
+			for(int i=0;i<m;i++) mean += gsl_vector_get(&col.vector, i);
+			avg[j] = mean/m;
+			gsl_vector_add_constant(&col.vector, -avg[j]);
+			double norm = gsl_blas_dnrm2(&col.vector);
+			totalVariance += norm*norm/m;
+		}
+
+		cout<<"Calculating "<<components<<" leading eigenvectors .. ";cout.flush();
+		components = std::min(components, std::min(m, n));
+		eval = gsl_vector_calloc(components);
+		evec = gsl_matrix_calloc(n, components);
+		randomizedPCA(X, eval, evec);
+		gsl_matrix_free(X);
+		cout<<"done"<<endl;
+	}else{
+		double* cov = new double[n*n];
+		if(streaming){
+			size_t count = streamCovariance(native, argc-2, &(argv[2]), n, cov, avg);
+			cout<<"done. Total: "<<count<<endl;
+		}else{
+			vector<Configuration*> configurations;
+			vector<Molecule *> proteins;
+			collectConfigurations(native, argc-2, &(argv[2]), configurations, proteins);
+			cout<<"done. Total: "<<configurations.size()<<endl;
+
+			cout<<"Calculating covariance matrix .. ";
+			for(int i=0;i<n;i++){ avg[i]=0; for(int j=0;j<n;j++) cov[i*n+j] = 0; }
+
 			for(vector<Configuration*>::iterator cit=configurations.begin(); cit!=configurations.end(); cit++){
-				cov[i*n+j] += ((*cit)->m_dofs[i] - avg[i]) * ((*cit)->m_dofs[j] - avg[j]);
+				for(int i=0;i<n;i++){
+					double val = (*cit)->m_dofs[i];
+					if(val>3.1416){
+						cerr<<"Error: dof["<<i<<"] = "<<val<<endl;
+						exit(-1);
+					}
+					avg[i]+= val;
+				}
 			}
-			cov[i*n+j]/=configurations.size();
-			cov[j*n+i]=cov[i*n+j];
+			for(int i=0;i<n;i++){ avg[i]/=configurations.size();}
+			for(int i=0;i<n;i++)
+				for(int j=i;j<n;j++){
+					for(vector<Configuration*>::iterator cit=configurations.begin(); cit!=configurations.end(); cit++){
+						cov[i*n+j] += ((*cit)->m_dofs[i] - avg[i]) * ((*cit)->m_dofs[j] - avg[j]);
+					}
+					cov[i*n+j]/=configurations.size();
+					cov[j*n+i]=cov[i*n+j];
+				}
+			cout<<" done"<<endl;
 		}
-	cout<<" done"<<endl;
-
 
-	cout<<"Calculating eigenvectors .. ";cout.flush();
-	gsl_matrix_view m = gsl_matrix_view_array (cov, n, n);
+		for(int i=0;i<n;i++) totalVariance += cov[i*n+i];
 
-	gsl_vector *eval = gsl_vector_alloc (n);
-	gsl_matrix *evec = gsl_matrix_alloc (n, n);
-	gsl_eigen_symmv_workspace * w = gsl_eigen_symmv_alloc (n);
-	gsl_eigen_symmv (&m.matrix, eval, evec, w);
-	gsl_eigen_symmv_free (w);
-	gsl_eigen_symmv_sort (eval, evec, GSL_EIGEN_SORT_ABS_DESC);
-	cout<<"done"<<endl;
+		cout<<"Calculating eigenvectors .. ";cout.flush();
+		gsl_matrix_view m = gsl_matrix_view_array (cov, n, n);
 
+		eval = gsl_vector_alloc (n);
+		evec = gsl_matrix_alloc (n, n);
+		gsl_eigen_symmv_workspace * w = gsl_eigen_symmv_alloc (n);
+		gsl_eigen_symmv (&m.matrix, eval, evec, w);
+		gsl_eigen_symmv_free (w);
+		gsl_eigen_symmv_sort (eval, evec, GSL_EIGEN_SORT_ABS_DESC);
+		cout<<"done"<<endl;
+	}
 
-		for (int i = 0; i < n; i++)
+		double explained = 0.0;
+		for (size_t i = 0; i < eval->size; i++)
 		{
 			double eval_i = gsl_vector_get (eval, i);
-			printf ("eigenvalue = %g\n", eval_i);
+			explained += eval_i;
+			printf ("eigenvalue = %g .. explained variance %.2f%% (cumulative %.2f%%)\n", eval_i,
+			        100.0*eval_i/totalVariance, 100.0*explained/totalVariance);
 
 			//gsl_vector_view evec_i = gsl_matrix_column (evec, i);
 			//printf ("eigenvector = \n");
@@ -54,6 +54,7 @@ IN THE SOFTWARE.
 #include <planners/PoissonPlanner2.h>
 #include <applications/options/ExploreOptions.h>
 #include <math/NullspaceSVD.h>
+#include <core/NullspaceCache.h>
 #include <planners/MCMCPlanner.h>
 
 using namespace std;
@@ -210,6 +211,28 @@ void randomSampling(ExploreOptions& options) {
     exit(-1);
   }
   planner->initialize(move, metric, options.workingDirectory, options.saveData);
+  if(options.numThreads!=1){
+    if(options.collapseRigid > 0){
+      cerr<<"--threads can't be combined with --collapseRigidEdges"<<endl;
+      exit(-1);
+    }
+    //Worker configurations can't be tracked by the NullspaceCache, the budget only bounds the bases RRT keeps
+    RRTPlanner* rrt = dynamic_cast<RRTPlanner*>(planner);
+    if(options.nullspaceBudget > 0 && rrt==nullptr){
+      cerr<<"--threads can only be combined with --nullspaceBudget for the binnedrrt planner"<<endl;
+      exit(-1);
+    }
+    planner->setParallel(protein, (unsigned int)options.numThreads, movingResidues, options.collisionFactor, options.roots);
+    if(rrt!=nullptr) {
+      rrt->setBatchSize(options.batchSize);
+      rrt->setBasisBudget((size_t)(options.nullspaceBudget*1024*1024));
+    }
+  }
+
+  if(options.checkpointInterval > 0)
+    planner->setCheckpointing(options.workingDirectory + "output/" + protein->getName() + "_checkpoint.kgsckpt", options.checkpointInterval);
+  if(!options.resume.empty())
+    planner->resume(options.resume);
   protein->m_conf->rigidityAnalysis();///for correct output on "rigidified angles"
   protein->writeRigidbodyIDToBFactor();///if collapse == 0, this will give initial distribution of rigid bodies
 
@@ -246,6 +269,10 @@ void randomSampling(ExploreOptions& options) {
   std::list<Configuration*>& m_samples = planner->getSamples();
   log("samplingStatus")<< "Took "<<(end_time-start_time)<<" seconds to generate "<<(m_samples.size()-1)<<" valid samples\n";
   log("samplingStatus")<< "Jacobian and null space computation took "<<jacobianAndNullspaceTime<<" seconds\n";
+  if(options.incrementalNullspace)
+    log("samplingStatus")<< "Incremental null space updates: "<<NullspaceSVD::getNumIncrementalUpdates()<<", fell back to full SVD: "<<NullspaceSVD::getNumIncrementalFallbacks()<<"\n";
+  if(options.nullspaceBudget>0 && options.numThreads==1)
+    log("samplingStatus")<< "Null space cache: "<<NullspaceCache::getNumCompressions()<<" compressed, "<<NullspaceCache::getNumEvictions()<<" evicted\n";
   log("samplingStatus")<< "Rigidity analysis took "<<rigidityTime<<" seconds\n";
   log("samplingStatus")<< "Node selection took "<<selectNodeTime<<" seconds\n";
 
@@ -290,6 +317,11 @@ int main( int argc, char* argv[] ) {
   // Set SVD cutoff
 //  SINGVAL_TOL = options.svdCutoff;
   NullspaceSVD::setSingularValueTolerance(options.svdCutoff);
+  Nullspace::setMethod(options.nullspaceMethod);
+  NullspaceSVD::setIncrementalUpdates(options.incrementalNullspace);
+  NullspaceCache::setFloatStorage(options.nullspaceFloat);
+  if(options.numThreads==1)
+    NullspaceCache::setBudget((size_t)(options.nullspaceBudget*1024*1024));
 
   randomSampling(options);
 
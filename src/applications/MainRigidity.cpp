@@ -68,6 +68,9 @@ int main( int argc, char* argv[] ){
   enableLogger("so"); //print options
   options.print();
 
+  NullspaceSVD::setSingularValueTolerance(options.svdCutoff);
+  Nullspace::setMethod(options.nullspaceMethod);
+
   string out_path = options.workingDirectory;
   Selection movingResidues(options.residueNetwork);
   Molecule* protein = IO::readPdb(
@@ -94,10 +97,10 @@ int main( int argc, char* argv[] ){
   log("rigidity") << "> " << protein->m_spanningTree->getNumDOFs() << " DOFs of which " << protein->m_spanningTree->getNumCycleDOFs() << " are cycle-DOFs\n" << endl;
 
   Configuration* conf = protein->m_conf;
-  NullspaceSVD ns = *(dynamic_cast<NullspaceSVD*>(conf->getNullspace()));
-  int numRows = ns.getMatrix()->size1;
-  int numCols = ns.getMatrix()->size2;
-  int nullspaceCols = ns.getNullspaceSize();
+  Nullspace* ns = conf->getNullspace();
+  int numRows = ns->getMatrix()->size1;
+  int numCols = ns->getMatrix()->size2;
+  int nullspaceCols = ns->getNullspaceSize();
   int rankJacobian = numCols - nullspaceCols;
   int numRedundantCons = numRows-rankJacobian;
 
@@ -114,7 +117,7 @@ int main( int argc, char* argv[] ){
     Selection source(options.source);
     Selection sink(options.sink);
     double mutInfo = protein->m_conf->siteDOFTransfer(source, sink,
-                                                                ns.getBasis()); /// change this to V-matrix for whole sliding mechanism
+                                                                ns->getBasis()); /// change this to V-matrix for whole sliding mechanism
   }
   /// Create larger rigid substructures for rigid cluster decomposition
   Molecule* rigidified = protein->collapseRigidBonds(options.collapseRigid);
@@ -154,7 +157,8 @@ int main( int argc, char* argv[] ){
   ///save singular values
   //NullspaceSVD* derived = dynamic_cast<NullspaceSVD*>(conf->getNullspace());
   string outSing = out_path + "output/singVals.txt";
-  gsl_vector_outtofile(ns.getSVD()->S, outSing);
+  if(NullspaceSVD* nsSVD = dynamic_cast<NullspaceSVD*>(ns))
+    gsl_vector_outtofile(nsSVD->getSVD()->S, outSing);
 
   ///save Jacobian and Nullspace to file
   string outJac=out_path + "output/" +  name + "_jac_" +
@@ -164,8 +168,8 @@ int main( int argc, char* argv[] ){
                  std::to_string((long long)sample_id)
                  + ".txt";
 
-  gsl_matrix_outtofile(ns.getBasis(),outNull);
-  gsl_matrix_outtofile(ns.getMatrix(),outJac);
+  gsl_matrix_outtofile(ns->getBasis(),outNull);
+  gsl_matrix_outtofile(ns->getMatrix(),outJac);
 
   if(options.saveData <= 2) return 0;
 
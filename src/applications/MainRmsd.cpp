@@ -31,6 +31,7 @@ IN THE SOFTWARE.
 
 #include <string>
 #include <iostream>
+#include <fstream>
 #include <metrics/Dihedral.h>
 
 #include "core/Molecule.h"
@@ -40,7 +41,9 @@ IN THE SOFTWARE.
 #include "IO.h"
 #include "Logger.h"
 #include "metrics/RMSD.h"
+#include "metrics/PairwiseRMSD.h"
 #include "CTKTimer.h"
+#include "ThreadPool.h"
 
 using namespace std;
 
@@ -56,9 +59,61 @@ Molecule * myReadFile(string pdbFile){
 }
 
 
+/**
+ * kgs_rmsd --matrix <output> [--threads <n>] [--selection <selection>] <pdb-files>
+ * Writes the RMSD between all pairs of pdb-files in the binary format of metrics::PairwiseRMSD::write and
+ * the file names, one per line in matrix order, to <output>.names.
+ */
+int rmsdMatrix( int argc, char* argv[] ){
+  string outFile = argv[2];
+  unsigned int numThreads = 0;
+  string selection = "all";
+
+  int first = 3;
+  while(first+1<argc && string(argv[first]).compare(0, 2, "--")==0){
+    string arg = argv[first];
+    if     (arg=="--threads")   numThreads = atoi(argv[first+1]);
+    else if(arg=="--selection") selection  = argv[first+1];
+    else{ cerr<<"Unknown option "<<arg<<endl; exit(-1); }
+    first += 2;
+  }
+  if(first+1>=argc){ cerr<<"Too few arguments. Please specify at least two PDB-files"<<endl; exit(-1); }
+
+  CTKTimer timer;
+  timer.Reset();
+  double start_time = timer.LastElapsedTime();
+
+  //Structures are read one at a time and only their selected coordinates are kept
+  Selection sel(selection);
+  Molecule* reference = myReadFile(argv[first]);
+  metrics::PairwiseRMSD pairwise(reference, sel);
+  ofstream names((outFile+".names").c_str());
+  for(int i=first;i<argc;i++){
+    Molecule* p = i==first ? reference : myReadFile(argv[i]);
+    pairwise.addStructure(p);
+    names<<argv[i]<<endl;
+    if(p!=reference) delete p;
+  }
+  delete reference;
+  names.close();
+  double read_time = timer.ElapsedTime();
+
+  ThreadPool pool(numThreads);
+  pairwise.compute(pool);
+  pairwise.write(outFile);
+  double end_time = timer.ElapsedTime();
+
+  log("rmsd")<<"Read "<<pairwise.numStructures()<<" structures with "<<pairwise.numAtoms()<<" selected atoms in ";
+  log("rmsd")<<read_time-start_time<<"s"<<endl;
+  log("rmsd")<<"Computed "<<pairwise.getDistances().size()<<" distances on "<<pool.size()<<" threads in ";
+  log("rmsd")<<end_time-read_time<<"s"<<endl;
+  return 0;
+}
+
 int main( int argc, char* argv[] ){
   enableLogger("rmsd");
   if(argc<3){ cerr<<"Too few arguments. Please specify PDB-file in arguments"<<endl; exit(-1);}
+  if(string(argv[1])=="--matrix") return rmsdMatrix(argc, argv);
   
   Selection sel("all");
 //  Configuration* reference = new Configuration(myReadFile(argv[1]));
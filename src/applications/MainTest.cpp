@@ -50,6 +50,7 @@ IN THE SOFTWARE.
 #include <math/QRGSL.h>
 #include <math/NullspaceSVD.h>
 #include <math/NullspaceQR.h>
+#include <math/ProjectionWorkspace.h>
 
 #include "core/Chain.h"
 #include "IO.h"
@@ -65,9 +66,14 @@ void testGlobalGradient();
 void testQR();
 void testSelection();
 void testIncDOFs();
+void benchmarkNullspace(const std::string& pdbFile);
 
 int main( int argc, char* argv[] ) {
   enableLogger("default");
+  if(argc>2 && string(argv[1])=="--benchmarkNullspace"){
+    benchmarkNullspace(argv[2]);
+    return 0;
+  }
 //  testGlobalMSD();
 //  testGlobalGradient();
 //  testQR();
@@ -333,3 +339,73 @@ void testCuda(){
 ////  gsl_matrix_cout( gsl_matrix_mul(cudasvd->U, gsl_matrix_mul(S, gsl_matrix_trans(cudasvd->V))) );
 //
 //}
+
+
+/**
+ * Time the nullspace backends on the cycle Jacobian of `pdbFile`, e.g.
+ * kgs_test --benchmarkNullspace ../examples/ADK/init.kgs.pdb
+ */
+void benchmarkNullspace(const std::string& pdbFile){
+  Selection all("all");
+  Molecule* mol = IO::readPdb(pdbFile);
+  mol->initializeTree(all);
+
+  Nullspace* ns = mol->m_conf->getNullspace();
+  if(ns==nullptr){
+    cerr<<pdbFile<<" has no constraint cycles"<<endl;
+    delete mol;
+    return;
+  }
+  gsl_matrix* J = ns->getMatrix();
+  cout<<pdbFile<<": Jacobian is "<<J->size1<<" x "<<J->size2<<endl;
+
+  const int repeats = 10;
+  for(const std::string method: {"svd", "sparse", "qr"}) {
+    Nullspace::setMethod(method);
+    Nullspace* bench = Nullspace::create(J);
+
+    double start = get_wall_time();
+    for(int r=0; r<repeats; r++)
+      bench->updateFromMatrix();
+    double duration = ( get_wall_time() - start ) / repeats;
+
+    gsl_matrix* JN = gsl_matrix_mul(J, bench->getBasis());
+    cout<<method<<" took "<<duration<<"secs. Nullspace size: "<<bench->getNullspaceSize();
+    cout<<", |J*N|_F: "<<frobenius_norm(JN)<<endl;
+    gsl_matrix_free(JN);
+    delete bench;
+  }
+  Nullspace::setMethod("svd");
+
+  //Project a batch of random gradients one at a time and in one dgemm
+  const size_t numGradients = 64;
+  const int numDofs = mol->m_conf->getNumDOFs();
+  gsl_matrix* gradients = gsl_matrix_alloc(numDofs, numGradients);
+  gsl_matrix* projected = gsl_matrix_alloc(numDofs, numGradients);
+  for(int i=0; i<numDofs; i++)
+    for(size_t c=0; c<numGradients; c++)
+      gsl_matrix_set(gradients, i, c, 2.0*rand()/RAND_MAX - 1.0);
+  ProjectionWorkspace workspace;
+
+  double start = get_wall_time();
+  for(int r=0; r<repeats; r++) {
+    for (size_t c = 0; c < numGradients; c++) {
+      gsl_vector_view in = gsl_matrix_column(gradients, c);
+      gsl_vector_view out = gsl_matrix_column(projected, c);
+      mol->m_conf->projectOnCycleNullSpace(&in.vector, &out.vector, workspace);
+    }
+  }
+  double durationSingle = ( get_wall_time() - start ) / repeats;
+
+  start = get_wall_time();
+  for(int r=0; r<repeats; r++)
+    mol->m_conf->projectOnCycleNullSpace(gradients, projected, workspace);
+  double durationBatched = ( get_wall_time() - start ) / repeats;
+
+  cout<<"Projecting "<<numGradients<<" gradients took "<<durationSingle<<"secs one at a time and ";
+  cout<<durationBatched<<"secs batched"<<endl;
+
+  gsl_matrix_free(projected);
+  gsl_matrix_free(gradients);
+  delete mol;
+}
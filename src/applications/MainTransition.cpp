@@ -64,6 +64,67 @@ extern double selectNodeTime;
 
 using namespace std;
 
+/**
+ * Create the direction selected by options.gradient. Relative distances are read for atoms of
+ * `molecule`. The selections are referenced by the direction and must outlive it.
+ */
+Direction* createDirection(TransitionOptions& options, Molecule* molecule, Selection& gradientSelection,
+                           Selection& blendedSelection, bool& blendedDir){
+  Direction* direction = nullptr;
+  blendedDir = false;
+  if(options.gradient == 0)
+    direction = new RandomDirection(gradientSelection);
+  else if(options.gradient == 1)
+    direction = new DihedralDirection(gradientSelection);
+  else if(options.gradient == 2){
+    BlendedDirection* bdir = new BlendedDirection();
+    bdir->addDirection(new DihedralDirection(gradientSelection),0);
+    bdir->addDirection(new RandomDirection(blendedSelection,options.maxRotation), 1);
+    direction = bdir;
+    blendedDir = true;
+  }
+  else if(options.gradient == 3)
+    direction = new MSDDirection(gradientSelection, options.alignAlways);
+  else if(options.gradient == 4){
+    BlendedDirection* bdir = new BlendedDirection();
+    bdir->addDirection(new MSDDirection(gradientSelection, options.alignAlways),0);
+    bdir->addDirection(new RandomDirection(blendedSelection,options.maxRotation), 1);
+    direction = bdir;
+    blendedDir = true;
+  }
+  else if(options.gradient <= 5) {
+    direction = new LSNullspaceDirection(gradientSelection);
+  }
+  else if(options.gradient <= 6) {
+    std::vector< std::tuple<Atom*, Atom*, double> > goal_distances =
+        IO::readRelativeDistances(options.relativeDistances, molecule);
+    Direction* d1 = new LSNrelativeDirection(gradientSelection, goal_distances);
+  }
+  else if(options.gradient <= 7) {
+    std::vector< std::tuple<Atom*, Atom*, double> > goal_distances =
+        IO::readRelativeDistances(options.relativeDistances, molecule);
+    Direction* d1 = new LSNrelativeDirection(gradientSelection, goal_distances);
+    Direction* d2 = new RandomDirection(blendedSelection, options.maxRotation);
+    BlendedDirection* bdir = new BlendedDirection();
+    bdir->addDirection(d1, 0);
+    bdir->addDirection(d2, 1);
+    direction = bdir;
+    blendedDir = true;
+  }
+  else if(options.gradient <= 8) {
+    std::vector< std::tuple<Atom*, Atom*, double> > goal_distances =
+        IO::readRelativeDistances(options.relativeDistances, molecule);
+    Direction* d1 = new RelativeMSDDirection(goal_distances);
+    Direction* d2 = new RandomDirection(blendedSelection, options.maxRotation);
+    BlendedDirection* bdir = new BlendedDirection();
+    bdir->addDirection(d1, 0);
+    bdir->addDirection(d2, 1);
+    direction = bdir;
+    blendedDir = true;
+  }
+  return direction;
+}
+
 void targetedSampling(TransitionOptions& options){
   string pdb_file = options.initialStructureFile;
   Selection resNetwork(options.residueNetwork);
@@ -167,60 +228,10 @@ void targetedSampling(TransitionOptions& options){
   }
 
   //Initialize m_direction
-  Direction* direction;
   bool blendedDir = false;
   Selection blendedSelection("all");
   Selection gradientSelection(options.gradientSelection);
-  if(options.gradient == 0)
-    direction = new RandomDirection(gradientSelection);
-  else if(options.gradient == 1)
-    direction = new DihedralDirection(gradientSelection);
-  else if(options.gradient == 2){
-    BlendedDirection* bdir = new BlendedDirection();
-    bdir->addDirection(new DihedralDirection(gradientSelection),0);
-    bdir->addDirection(new RandomDirection(blendedSelection,options.maxRotation), 1);
-    direction = bdir;
-    blendedDir = true;
-  }
-  else if(options.gradient == 3)
-    direction = new MSDDirection(gradientSelection, options.alignAlways);
-  else if(options.gradient == 4){
-    BlendedDirection* bdir = new BlendedDirection();
-    bdir->addDirection(new MSDDirection(gradientSelection, options.alignAlways),0);
-    bdir->addDirection(new RandomDirection(blendedSelection,options.maxRotation), 1);
-    direction = bdir;
-    blendedDir = true;
-  }
-  else if(options.gradient <= 5) {
-    direction = new LSNullspaceDirection(gradientSelection);
-  }
-  else if(options.gradient <= 6) {
-    std::vector< std::tuple<Atom*, Atom*, double> > goal_distances =
-        IO::readRelativeDistances(options.relativeDistances, protein);
-    Direction* d1 = new LSNrelativeDirection(gradientSelection, goal_distances);
-  }
-  else if(options.gradient <= 7) {
-    std::vector< std::tuple<Atom*, Atom*, double> > goal_distances =
-        IO::readRelativeDistances(options.relativeDistances, protein);
-    Direction* d1 = new LSNrelativeDirection(gradientSelection, goal_distances);
-    Direction* d2 = new RandomDirection(blendedSelection, options.maxRotation);
-    BlendedDirection* bdir = new BlendedDirection();
-    bdir->addDirection(d1, 0);
-    bdir->addDirection(d2, 1);
-    direction = bdir;
-    blendedDir = true;
-  }
-  else if(options.gradient <= 8) {
-    std::vector< std::tuple<Atom*, Atom*, double> > goal_distances =
-        IO::readRelativeDistances(options.relativeDistances, protein);
-    Direction* d1 = new RelativeMSDDirection(goal_distances);
-    Direction* d2 = new RandomDirection(blendedSelection, options.maxRotation);
-    BlendedDirection* bdir = new BlendedDirection();
-    bdir->addDirection(d1, 0);
-    bdir->addDirection(d2, 1);
-    direction = bdir;
-    blendedDir = true;
-  }
+  Direction* direction = createDirection(options, protein, gradientSelection, blendedSelection, blendedDir);
 
   //Initialize planner
   SamplingPlanner* planner;
@@ -276,6 +287,26 @@ void targetedSampling(TransitionOptions& options){
   }
   planner->initialize(move, metric, options.workingDirectory, options.saveData);
 
+  //The reverse tree gets its own direction and selections as selections cache atoms per molecule
+  Direction* reverseDirection = nullptr;
+  Selection reverseBlendedSelection("all");
+  Selection reverseGradientSelection(options.gradientSelection);
+  if(options.concurrentTrees){
+    BidirectionalMovingFront* bidirectional = dynamic_cast<BidirectionalMovingFront*>(planner);
+    if(bidirectional==nullptr){
+      cerr<<"--concurrentTrees requires the dccrrt planner"<<endl;
+      exit(-1);
+    }
+    bool reverseBlended;
+    reverseDirection = createDirection(options, target, reverseGradientSelection, reverseBlendedSelection, reverseBlended);
+    bidirectional->setConcurrentTrees(reverseDirection, resNetwork, options.collisionFactor, options.roots);
+  }
+
+  if(options.checkpointInterval > 0)
+    planner->setCheckpointing(options.workingDirectory + "output/" + protein->getName() + "_checkpoint.kgsckpt", options.checkpointInterval);
+  if(!options.resume.empty())
+    planner->resume(options.resume);
+
   if(options.saveData > 0){
 
     std::string out = options.workingDirectory + "output/" + target->getName() + "_lengths";
@@ -348,6 +379,7 @@ void targetedSampling(TransitionOptions& options){
   delete planner;
   delete move;
   delete direction;
+  delete reverseDirection;
   delete target;
   delete protein;
 }
@@ -383,6 +415,7 @@ int main( int argc, char* argv[] ) {
 
   // Set SVD cutoff
   NullspaceSVD::setSingularValueTolerance(options.svdCutoff);
+  Nullspace::setMethod(options.nullspaceMethod);
 
   // Do the same for the target
   string target_file = options.targetStructureFile;
@@ -99,6 +99,8 @@ DeerOptions::DeerOptions(int argc, char* argv[]):
     if(arg=="--frontSize"){                     frontSize = atoi(argv[++i]);                        continue; }
     if(arg=="--svdCutoff"){                     svdCutoff = atof(argv[++i]);                        continue; }
     if(arg=="--collapseRigidEdges"){            collapseRigid = atoi(argv[++i]);                    continue; }
+    if(arg=="--checkpointInterval"){            checkpointInterval = atoi(argv[++i]);               continue; }
+    if(arg=="--resume"){                        resume = argv[++i];                                 continue; }
     if(arg=="--relativeDistances"){             relativeDistances = argv[++i];                      continue; }
     if(arg=="--predictStrain"){                 predictStrain = Util::stob(argv[++i]);              continue; }
     if(arg=="--logger"){                        ++i;                                                continue; }
@@ -205,6 +207,8 @@ void DeerOptions::initializeVariables(){
   frontSize                 = 50;
   svdCutoff                 = 1.0e-12;
   collapseRigid             = false;
+  checkpointInterval        = 0;
+  resume                    = "";
   relativeDistances         = "";
   predictStrain             = false;
   explorationRadius         = 2.0;
@@ -244,6 +248,8 @@ void DeerOptions::print(){
   log("so")<<"\t--frontSize "<<frontSize<<endl;
   log("so")<<"\t--svdCutoff "<<svdCutoff<<endl;
   log("so")<<"\t--collapseRigidEdges "<<collapseRigid<<endl;
+  log("so")<<"\t--checkpointInterval "<<checkpointInterval<<endl;
+  if(!resume.empty()) log("so")<<"\t--resume "<<resume<<endl;
   log("so")<<"\t--relativeDistances "<<relativeDistances<<endl;
   log("so")<<"\t--predictStrain "<<predictStrain<<endl;
   log("so")<<"\t--radius "<<explorationRadius<<endl;
@@ -276,7 +282,7 @@ void DeerOptions::printUsage(char* pname){
   log("so")<<"  --seed <integer>\t: The seed used for random number generation (Standard: 418)"<<endl;
   log("so")<<"  --biasToTarget, -bias <real number> \t: Percentage of using target as 'random seed configuration'. Default 0.1."<<endl;
   log("so")<<"  --convergeDistance <real number> \t: The distance under which the goal conformation is considered reached. Default is 0.1 for RMSD and 1e-8 for Dihedral metric."<<endl;
-  log("so")<<"  --saveData <0|1|2>\t: Indicate whether files shall be saved! 0=none, 1=pdb and q, 2=all. Default: 1"<<endl;
+  log("so")<<"  --saveData <-2|-1|0|1|2>\t: Indicate whether files shall be saved! -2=DOF-values of all samples in one file, -1=one DCD trajectory and sample table, 0=none, 1=pdb and q, 2=all. Default: 1"<<endl;
   log("so")<<"  --preventClashes "<<(preventClashes?"true":"false: Use clashing atoms to define additional constraints and prevent clash. Default true.")<<endl;
   log("so")<<"  --alignSelection < A pymol-like pattern that indicates which subset of atoms are used during alignment (if specified). Default is 'heavy'."<<endl;
   log("so")<<"  --gradientSelection <selection-pattern>\t: A pymol-like pattern that pecifies the residues of the molecule that are used to determine the gradient. Default is 'heavy'."<<endl;
@@ -287,6 +293,8 @@ void DeerOptions::printUsage(char* pname){
   log("so")<<"  --frontSize <integer>\t: Size of the propagating front of samples in directed sampling."<<endl;
   log("so")<<"  --svdCutoff <real number> \t: Smallest singular value considered as part of the nullspace, default 1.0e-12."<<endl;
   log("so")<<"  --collapseRigidEdges <0|1|2> \t: Indicates whether to speed up null-space computation by collapsing rigid edges. 0: Dont collapse. 1: Collapse covalent bonds. 2: Collapse covalent and hydrogen bonds. Default 0."<<endl;
+  log("so")<<"  --checkpointInterval <integer> \t: Write the planner state to output/<name>_checkpoint.kgsckpt every this many samples, so sampling can be continued with --resume. Supported by the deer planner. Default 0 (no checkpoints)."<<endl;
+  log("so")<<"  --resume <checkpoint-file> \t: Continue sampling from a checkpoint written by a run with the same structures and options."<<endl;
   log("so")<<"  --relativeDistances <list of double> \t: has to begin by 'double ' followed by doubles seprated by '+' .It corresponds of the desired distance between atoms of residueNetwork option. "<<endl;
   log("so")<<"  --relativeDistances <file name> \t: File with the desired distance between atoms of residueNetwork option. Each line is one couple 'id atom_id2,id atom_id2,distance'. Each line should contain only two spaces, one after each word 'id'"<<endl;
   log("so")<<"  --predictStrain <true|false> \t: Indicate whether strain on constraints should be printed."<<endl;
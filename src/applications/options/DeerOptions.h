@@ -82,6 +82,10 @@ class DeerOptions : ApplicationOptions {
   double svdCutoff;
   /** Option for collapsing rigid edges. */
   int collapseRigid;
+  /** Samples between checkpoints of the planner state (0: no checkpoints). */
+  int checkpointInterval;
+  /** Checkpoint file to continue sampling from. */
+  std::string resume;
   /** Specified distance to reach between couple of atoms */
   std::string relativeDistances;
   /** Indicates if constraint strain should be predicted and printed */
@@ -103,7 +103,15 @@ ExploreOptions::ExploreOptions(int argc, char* argv[]):
     if(arg=="--projectConstraints"){            projectConstraints = Util::stob(argv[++i]);         continue; }
     if(arg=="--collisionCheck"){                collisionCheck = argv[++i];                         continue; }
     if(arg=="--svdCutoff"){                     svdCutoff = atof(argv[++i]);                        continue; }
+    if(arg=="--nullspaceMethod"){               nullspaceMethod = argv[++i];                        continue; }
+    if(arg=="--incrementalNullspace"){          incrementalNullspace = Util::stob(argv[++i]);       continue; }
+    if(arg=="--nullspaceBudget"){               nullspaceBudget = atof(argv[++i]);                  continue; }
+    if(arg=="--nullspaceFloat"){                nullspaceFloat = Util::stob(argv[++i]);             continue; }
+    if(arg=="--threads"){                       numThreads = atoi(argv[++i]);                       continue; }
+    if(arg=="--batchSize"){                     batchSize = atoi(argv[++i]);                        continue; }
     if(arg=="--collapseRigidEdges"){             collapseRigid = atoi(argv[++i]);                   continue; }
+    if(arg=="--checkpointInterval"){            checkpointInterval = atoi(argv[++i]);               continue; }
+    if(arg=="--resume"){                        resume = argv[++i];                                 continue; }
     if(arg=="--enableBVH"){                     enableBVH = Util::stob(argv[++i]);                  continue; }
 //    if(arg=="--relativeDistances"){             relativeDistances = argv[++i];                      continue; }
     if(arg=="--logger"){                        ++i;                                                continue; }
@@ -275,7 +283,15 @@ void ExploreOptions::initializeVariables(){
   projectConstraints        = true;
   collisionCheck            = "all";
   svdCutoff                 = 1.0e-12;
+  nullspaceMethod           = "svd";
+  incrementalNullspace      = false;
+  nullspaceBudget           = 0.0;
+  nullspaceFloat            = false;
+  numThreads                = 1;
+  batchSize                 = 0;
   collapseRigid             = false;
+  checkpointInterval        = 0;
+  resume                    = "";
   enableBVH                 = true;
 }
 
@@ -327,7 +343,15 @@ void ExploreOptions::print(){
 //  log("so")<<"\t--frontSize "<<frontSize<<endl;
 //  log("so")<<"\t--switchAfter "<<switchAfter<<endl;
   log("so")<<"\t--svdCutoff "<<svdCutoff<<endl;
+  log("so")<<"\t--nullspaceMethod "<<nullspaceMethod<<endl;
+  log("so")<<"\t--incrementalNullspace "<<incrementalNullspace<<endl;
+  log("so")<<"\t--nullspaceBudget "<<nullspaceBudget<<endl;
+  log("so")<<"\t--nullspaceFloat "<<nullspaceFloat<<endl;
+  log("so")<<"\t--threads "<<numThreads<<endl;
+  log("so")<<"\t--batchSize "<<batchSize<<endl;
   log("so")<<"\t--collapseRigidEdges "<<collapseRigid<<endl;
+  log("so")<<"\t--checkpointInterval "<<checkpointInterval<<endl;
+  if(!resume.empty()) log("so")<<"\t--resume "<<resume<<endl;
 }
 
 void ExploreOptions::printUsage(char* pname){
@@ -373,7 +397,7 @@ void ExploreOptions::printUsage(char* pname){
   log("so")<<"  --seed <integer>\t: The seed used for random number generation (Standard: 418)"<<endl;
 //  log("so")<<"  --biasToTarget, -bias <real number> \t: Percentage of using target as 'random seed configuration'. Default 0.1."<<endl;
 //  log("so")<<"  --convergeDistance <real number> \t: The distance under which the goal conformation is considered reached. Default is 0.1 for RMSD and 1e-8 for Dihedral metric."<<endl;
-//  log("so")<<"  --saveData <0|1|2>\t: Indicate whether files shall be saved! 0=none, 1=pdb and q, 2=all. Default: 1"<<endl;
+//  log("so")<<"  --saveData <-2|-1|0|1|2>\t: Indicate whether files shall be saved! -2=DOF-values of all samples in one file, -1=one DCD trajectory and sample table, 0=none, 1=pdb and q, 2=all. Default: 1"<<endl;
 //  log("so")<<"  --sampleReverse <true/false>\t: If true, iterative sampling from ini to goal and reverse"<<endl;
   log("so")<<"  --alignIni "<<(alignIni?"true":"false: Align initial and target configuration in the beginning. Default false.")<<endl;
   log("so")<<"  --preventClashes <true|false>\t: Use clashing atoms to define additional constraints and prevent clash. Default true."<<endl;
@@ -386,7 +410,15 @@ void ExploreOptions::printUsage(char* pname){
 //  log("so")<<"  --frontSize <integer>\t: Size of the propagating front of samples in directed sampling."<<endl;
 //  log("so")<<"  --switchAfter <integer>\t: Max number of steps before switching search directions (if bidirectional is active)."<<endl;
   log("so")<<"  --svdCutoff <real number> \t: Smallest singular value considered as part of the nullspace, default 1.0e-12."<<endl;
+  log("so")<<"  --nullspaceMethod <svd|sparse|qr> \t: Backend for constraint nullspaces. 'sparse' drops zero rows/columns of the Jacobian and computes an SVD per independent block. 'qr' uses a column-pivoted QR decomposition. Default svd."<<endl;
+  log("so")<<"  --incrementalNullspace <true|false> \t: Compute nullspaces by correcting the parent configuration's nullspace, falling back to a full SVD if the residual is too large. Only used with the svd method. Default false."<<endl;
+  log("so")<<"  --nullspaceBudget <real number> \t: Memory in MB available for nullspaces of samples. Least recently used nullspaces are evicted and recomputed on demand. With --threads only supported by the binnedrrt planner, where it bounds the nullspaces kept for seeds. Default 0 (unlimited)."<<endl;
+  log("so")<<"  --nullspaceFloat <true|false> \t: With --nullspaceBudget, first store evicted nullspaces in single precision. Default false."<<endl;
+  log("so")<<"  --threads <integer> \t: Number of threads computing perturbations, each on its own copy of the molecule. 0 uses one per core. Used by the poisson planner, whose samples are the same as with 1 thread, and the binnedrrt planner, which then extends the tree in batches. Default 1."<<endl;
+  log("so")<<"  --batchSize <integer> \t: With --threads, number of extensions per batch of the binnedrrt planner. Samples depend on the batch size but not the number of threads. Default 0 (four per thread)."<<endl;
   log("so")<<"  --collapseRigidEdges <0|1|2> \t: Indicates whether to speed up null-space computation by collapsing rigid edges. 0: Dont collapse. 1: Collapse covalent bonds. 2: Collapse covalent and hydrogen bonds. Default 0."<<endl;
+  log("so")<<"  --checkpointInterval <integer> \t: Write the planner state to output/<name>_checkpoint.kgsckpt every this many samples, so sampling can be continued with --resume. Supported by the binnedrrt and poisson planners. Default 0 (no checkpoints)."<<endl;
+  log("so")<<"  --resume <checkpoint-file> \t: Continue sampling from a checkpoint written by a run with the same structures and options."<<endl;
 //  log("so")<<"  --relativeDistances <list of double> \t: has to begin by 'double ' followed by doubles seprated by '+' .It corresponds of the desired distance between atoms of residueNetwork option. "<<endl;
 
 }
@@ -136,8 +136,24 @@ class ExploreOptions: ApplicationOptions
 //  int switchAfter;
   /** Cut-off for svd computation (magnitude of smallest singular value in the nullspace)*/
   double svdCutoff;
+  /** Nullspace backend: svd (dense), sparse or qr. */
+  std::string nullspaceMethod;
+  /** Warm-start nullspaces of new configurations from the parent's nullspace. */
+  bool incrementalNullspace;
+  /** Memory budget in MB for nullspaces of sampled configurations (0: unlimited). */
+  double nullspaceBudget;
+  /** Compress cold nullspaces to single precision before deleting them. */
+  bool nullspaceFloat;
+  /** Number of threads evaluating perturbations (1: sequential, 0: one per core). */
+  int numThreads;
+  /** Extensions per batch of the binned RRT planner with more than one thread (0: four per thread). */
+  int batchSize;
   /** Option for collapsing rigid edges. */
   int collapseRigid;
+  /** Samples between checkpoints of the planner state (0: no checkpoints). */
+  int checkpointInterval;
+  /** Checkpoint file to continue sampling from. */
+  std::string resume;
 
 //  /** Specified distance to reach between couple of atoms */
 //  std::string relativeDistances;
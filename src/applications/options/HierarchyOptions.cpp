@@ -172,7 +172,7 @@ void HierarchyOptions::printUsage(char* pname){
   log("so")<<"  --collisionFactor, -c <real number> \t: A number that is multiplied with the van der Waals radius when ";
   log("so")<<"checking for collisions. The default is 0.75."<<endl;
   log("so")<<"  --stepSize, <real number> \t: Step size to scale move along motion modes when computing samples. "<<endl;
-  log("so")<<"  --saveData <0|1|2|3>\t: Indicate whether files shall be saved! 0=none, 1=pdb, 2=pdb and q, 3=all. Default: 1"<<endl;
+  log("so")<<"  --saveData <-2|-1|0|1|2|3>\t: Indicate whether files shall be saved! -2=DOF-values of all samples in one file, -1=one DCD trajectory and sample table, 0=none, 1=pdb, 2=pdb and q, 3=all. Default: 1"<<endl;
   log("so")<<"  --residueNetwork <selection-pattern>\t: A pymol-like pattern that specifies deformable residues during sampling. Default is 'all'."<<endl;
   log("so")<<"  --roots <int>[,<int>..]\t: Atom IDs of chain roots. Defaults to first atom of each chain."<<endl;
   log("so")<<"  --collisionCheck <string>\t: Atoms used for collision detection: all (default), heavy, backbone"<<endl;
@@ -75,6 +75,8 @@ class RigidityOptions {
   std::string collisionCheck;
   /** Cut-off for svd computation (magnitude of smallest singular value in the nullspace)*/
   double svdCutoff;
+  /** Nullspace backend: svd (dense), sparse or qr. */
+  std::string nullspaceMethod;
   /** Option for collapsing rigid edges. */
   int collapseRigid;
   /** Sink/Source to identify transferred DoF between different areas. */
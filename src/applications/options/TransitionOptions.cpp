@@ -98,7 +98,11 @@ TransitionOptions::TransitionOptions(int argc, char* argv[])
     if(arg=="--frontSize"){                     frontSize = atoi(argv[++i]);                        continue; }
     if(arg=="--switchAfter"){                   switchAfter = atoi(argv[++i]);                      continue; }
     if(arg=="--svdCutoff"){                     svdCutoff = atof(argv[++i]);                        continue; }
+    if(arg=="--nullspaceMethod"){               nullspaceMethod = argv[++i];                        continue; }
+    if(arg=="--concurrentTrees"){               concurrentTrees = Util::stob(argv[++i]);            continue; }
     if(arg=="--collapseRigidEdges"){            collapseRigid = atoi(argv[++i]);                    continue; }
+    if(arg=="--checkpointInterval"){            checkpointInterval = atoi(argv[++i]);               continue; }
+    if(arg=="--resume"){                        resume = argv[++i];                                 continue; }
     if(arg=="--relativeDistances"){             relativeDistances = argv[++i];                      continue; }
     if(arg=="--hbondIntersect"){                hbondIntersect = Util::stob(argv[++i]);                         continue; }
 
@@ -283,7 +287,11 @@ void TransitionOptions::initializeVariables(){
   frontSize                 = 50;
   switchAfter               = 20000;
   svdCutoff                 = 1.0e-12;
+  nullspaceMethod           = "svd";
+  concurrentTrees           = false;
   collapseRigid             = false;
+  checkpointInterval        = 0;
+  resume                    = "";
   relativeDistances         = "";
   hbondIntersect            = false;
 }
@@ -330,7 +338,11 @@ void TransitionOptions::print(){
   log("so")<<"\t--frontSize "<<frontSize<<endl;
   log("so")<<"\t--switchAfter "<<switchAfter<<endl;
   log("so")<<"\t--svdCutoff "<<svdCutoff<<endl;
+  log("so")<<"\t--nullspaceMethod "<<nullspaceMethod<<endl;
+  log("so")<<"\t--concurrentTrees "<<concurrentTrees<<endl;
   log("so")<<"\t--collapseRigidEdges "<<collapseRigid<<endl;
+  log("so")<<"\t--checkpointInterval "<<checkpointInterval<<endl;
+  if(!resume.empty()) log("so")<<"\t--resume "<<resume<<endl;
   log("so")<<"\t--hbondIntersect "<<hbondIntersect<<endl <<endl;
 }
 
@@ -378,7 +390,7 @@ void TransitionOptions::printUsage(char* pname){
   log("so")<<"  --seed <integer>\t: The seed used for random number generation (Standard: 418)"<<endl;
   log("so")<<"  --biasToTarget, -bias <real number> \t: Percentage of using target as 'random seed configuration'. Default 0.1."<<endl;
   log("so")<<"  --convergeDistance <real number> \t: The distance under which the goal conformation is considered reached. Default is 0.1 for RMSD and 1e-8 for Dihedral metric."<<endl;
-  log("so")<<"  --saveData <0|1|2>\t: Indicate whether files shall be saved! 0=none, 1=pdb and q, 2=all. Default: 1"<<endl;
+  log("so")<<"  --saveData <-2|-1|0|1|2>\t: Indicate whether files shall be saved! -2=DOF-values of all samples in one file, -1=one DCD trajectory and sample table, 0=none, 1=pdb and q, 2=all. Default: 1"<<endl;
   log("so")<<"  --sampleReverse <true/false>\t: If true, iterative sampling from ini to goal and reverse"<<endl;
   log("so")<<"  --alignIni "<<(alignIni?"true":"false: Align initial and target configuration in the beginning. Default false.")<<endl;
   log("so")<<"  --preventClashes "<<(preventClashes?"true":"false: Use clashing atoms to define additional constraints and prevent clash. Default true.")<<endl;
@@ -391,7 +403,11 @@ void TransitionOptions::printUsage(char* pname){
   log("so")<<"  --frontSize <integer>\t: Size of the propagating front of samples in directed sampling."<<endl;
   log("so")<<"  --switchAfter <integer>\t: Max number of steps before switching search directions (if bidirectional is active)."<<endl;
   log("so")<<"  --svdCutoff <real number> \t: Smallest singular value considered as part of the nullspace, default 1.0e-12."<<endl;
+  log("so")<<"  --nullspaceMethod <svd|sparse|qr> \t: Backend for constraint nullspaces. 'sparse' drops zero rows/columns of the Jacobian and computes an SVD per independent block. 'qr' uses a column-pivoted QR decomposition. Default svd."<<endl;
+  log("so")<<"  --concurrentTrees <true|false> \t: With the dccrrt planner, grow the forward and reverse trees at the same time on two threads instead of alternating. Not reproducible and not combinable with --alignAlways. Default false."<<endl;
   log("so")<<"  --collapseRigidEdges <0|1|2> \t: Indicates whether to speed up null-space computation by collapsing rigid edges. 0: Dont collapse. 1: Collapse covalent bonds. 2: Collapse covalent and hydrogen bonds. Default 0."<<endl;
+  log("so")<<"  --checkpointInterval <integer> \t: Write the planner state to output/<name>_checkpoint.kgsckpt every this many samples, so sampling can be continued with --resume. Supported by the binnedrrt, poisson and dccrrt planners. Default 0 (no checkpoints)."<<endl;
+  log("so")<<"  --resume <checkpoint-file> \t: Continue sampling from a checkpoint written by a run with the same structures and options."<<endl;
   log("so")<<"  --relativeDistances <list of double> \t: has to begin by 'double ' followed by doubles seprated by '+' .It corresponds of the desired distance between atoms of residueNetwork option. "<<endl;
   log("so")<<"  --hbondIntersect <bool> \t: limit hydrogen bonds to intersection between initial and target structure"<<endl;
 }
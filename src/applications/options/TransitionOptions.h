@@ -120,8 +120,16 @@ class TransitionOptions {
   int switchAfter;
   /** Cut-off for svd computation (magnitude of smallest singular value in the nullspace)*/
   double svdCutoff;
+  /** Nullspace backend: svd (dense), sparse or qr. */
+  std::string nullspaceMethod;
+  /** Grow forward and reverse trees of the dccrrt planner on separate threads. */
+  bool concurrentTrees;
   /** Option for collapsing rigid edges. */
   int collapseRigid;
+  /** Samples between checkpoints of the planner state (0: no checkpoints). */
+  int checkpointInterval;
+  /** Checkpoint file to continue sampling from. */
+  std::string resume;
   /** Specified distance to reach between couple of atoms */
   std::string relativeDistances;
   /** Limit hydrogen bonds to intersection of initial and target hbonds */
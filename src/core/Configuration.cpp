@@ -40,10 +40,12 @@ IN THE SOFTWARE.
 #include <gsl/gsl_sort_vector_double.h> //provides vector sorting
 #include <math/gsl_helpers.h>
 #include <math/NullspaceSVD.h>
+#include <math/SparseMatrix.h>
 #include <math/Eigenvalue.h>
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_vector.h>
 #include "Grid.h"
+#include "NullspaceCache.h"
 
 #include "Configuration.h"
 #include "Molecule.h"
@@ -59,21 +61,22 @@ using namespace std;
 double jacobianAndNullspaceTime = 0;
 double rigidityTime = 0;
 
-gsl_matrix* Configuration::CycleJacobian = nullptr;
+thread_local gsl_matrix* Configuration::CycleJacobian = nullptr;
 //gsl_matrix* Configuration::CycleJacobianligand = nullptr;
 //gsl_matrix* Configuration::CycleJacobianentropy = nullptr;
-gsl_matrix* Configuration::CycleJacobiannocoupling = nullptr;
-gsl_matrix* Configuration::HBondJacobian = nullptr;
-gsl_matrix* Configuration::HydrophobicBondJacobian = nullptr;
-gsl_matrix* Configuration::DBondJacobian = nullptr;
-Configuration* Configuration::CycleJacobianOwner = nullptr;
-SVD* Configuration::JacobianSVD = nullptr;
-SVD* Configuration::JacobianSVDnocoupling = nullptr;
+thread_local gsl_matrix* Configuration::CycleJacobiannocoupling = nullptr;
+thread_local gsl_matrix* Configuration::HBondJacobian = nullptr;
+thread_local gsl_matrix* Configuration::HydrophobicBondJacobian = nullptr;
+thread_local gsl_matrix* Configuration::DBondJacobian = nullptr;
+thread_local Configuration* Configuration::CycleJacobianOwner = nullptr;
+thread_local SVD* Configuration::JacobianSVD = nullptr;
+thread_local SparseMatrix* Configuration::CycleJacobianSparse = nullptr;
+thread_local SVD* Configuration::JacobianSVDnocoupling = nullptr;
 //SVD* Configuration::JacobianSVDligand = nullptr;
 //gsl_matrix* Configuration::Hessianmatrix_cartesian = nullptr;
-gsl_matrix* Configuration::Massmatrix=nullptr;
-gsl_matrix* Configuration::distancematrix=nullptr;
-gsl_matrix* Configuration::coefficientmatrix=nullptr;
+thread_local gsl_matrix* Configuration::Massmatrix=nullptr;
+thread_local gsl_matrix* Configuration::distancematrix=nullptr;
+thread_local gsl_matrix* Configuration::coefficientmatrix=nullptr;
 
 //gsl_matrix* Configuration::ClashAvoidingJacobian = nullptr;
 //Nullspace* Configuration::ClashAvoidingNullSpace = nullptr;
@@ -106,6 +109,7 @@ Configuration::Configuration(Molecule * mol):
   m_numClusters            = 0;
   m_minCollisionFactor     = 0;
   m_usedClashPrevention    = false;
+  m_rigidityAnalyzed       = false;
   m_clashFreeDofs          = m_molecule->m_spanningTree->getNumDOFs();
 
   // Set up DOF-values and set them to 0
@@ -141,6 +145,7 @@ Configuration::Configuration(Configuration* parent_):
   m_numClusters            = 0;
   m_minCollisionFactor     = 0;
   m_usedClashPrevention    = false;
+  m_rigidityAnalyzed       = false;
   m_clashFreeDofs          = m_molecule->m_spanningTree->getNumDOFs();
 
   parent_->m_children.push_back(this);
@@ -171,6 +176,11 @@ Configuration::~Configuration(){
 //    delete rbPair.second;
 
   //m_sortedRBs.clear();
+  //Don't let a later configuration allocated at the same address reuse this one's jacobian
+  if(CycleJacobianOwner==this)
+    CycleJacobianOwner = nullptr;
+
+  NullspaceCache::remove(this);
   if(nullspace)
     delete nullspace;
 
@@ -220,8 +230,15 @@ void Configuration::computeCycleJacobianAndNullSpace() {
   computeJacobians();
 
   if (JacobianSVD!=nullptr) {
-    nullspace = new NullspaceSVD(JacobianSVD);
-    nullspace->updateFromMatrix();
+    nullspace = Nullspace::create(CycleJacobian, JacobianSVD, CycleJacobianSparse);
+    if(m_parent!=nullptr && m_parent->nullspace!=nullptr)
+      nullspace->updateFromPrior(m_parent->nullspace);
+    else
+      nullspace->updateFromMatrix();
+
+    //The nullspace may have been evicted by the NullspaceCache after rigidityAnalysis
+    if(m_rigidityAnalyzed)
+      nullspace->performRigidityAnalysis(HBondJacobian,DBondJacobian,HydrophobicBondJacobian);
   }
 
   double new_time = timer.ElapsedTime();
@@ -241,15 +258,14 @@ void Configuration::rigidityAnalysis() {
   //Checks if Jacobians need update
   computeJacobians();
 
-  if(nullspace==nullptr && nullspace==nullptr){ //update nullspace if necessary
-    computeCycleJacobianAndNullSpace();
-  }
+  getNullspace(); //update nullspace if necessary
   CTKTimer timer;
   timer.Reset();
   double old_time = timer.LastElapsedTime();
 
   if(CycleJacobian!=nullptr) {///identifies rigid/rotatable hbonds and bonds based on set cut-off
     nullspace->performRigidityAnalysis(HBondJacobian,DBondJacobian,HydrophobicBondJacobian);
+    m_rigidityAnalyzed = true;
   }
 
   int hIdx=0; //indexing for hBonds
@@ -299,6 +315,7 @@ void Configuration::rigidityAnalysis() {
 }
 
 void Configuration::deleteNullspace(){
+  NullspaceCache::remove(this);
   if(nullspace) {
     delete nullspace;
     nullspace = nullptr;
@@ -653,16 +670,30 @@ void Configuration::computeJacobians() {
 
   if(CycleJacobian==nullptr){
     CycleJacobian = gsl_matrix_calloc(row_num,col_num);
-    JacobianSVD = SVD::createSVD(CycleJacobian);//new SVDMKL(CycleJacobian);
+    JacobianSVD = SVD::createSVD(CycleJacobian, true);//new SVDMKL(CycleJacobian);
   }else if(CycleJacobian->size1==row_num && CycleJacobian->size2==col_num){
     gsl_matrix_set_zero(CycleJacobian);
   }else{
     gsl_matrix_free(CycleJacobian);
     delete JacobianSVD;
     CycleJacobian = gsl_matrix_calloc(row_num,col_num);
-    JacobianSVD = SVD::createSVD(CycleJacobian);//new SVDMKL(CycleJacobian);
+    JacobianSVD = SVD::createSVD(CycleJacobian, true);//new SVDMKL(CycleJacobian);
   }
 
+  //The sparse nullspace takes the non-zeros as they are set instead of scanning the dense matrix
+  SparseMatrix* sparse = nullptr;
+  if(Nullspace::getMethod()=="sparse"){
+    if(CycleJacobianSparse==nullptr)
+      CycleJacobianSparse = new SparseMatrix(row_num, col_num);
+    CycleJacobianSparse->reset(row_num, col_num);
+    sparse = CycleJacobianSparse;
+  }
+  auto setCycleJacobianEntry = [sparse](int row, int col, double value){
+    gsl_matrix_set(CycleJacobian, row, col, value);
+    if(sparse!=nullptr)
+      sparse->add(row, col, value);
+  };
+
   ///HBond Jacobian
   if(hConstraint_row_num != 0) {
     if (HBondJacobian == nullptr) {
@@ -772,9 +803,8 @@ void Configuration::computeJacobians() {
     t2.getNormalized(t2);
 
     // trace back until the common ancestor from vertex1
-    while ( vertex1 != common_ancestor ) {
-      KinVertex* parent = vertex1->m_parent;
-      KinEdge* p_edge = parent->findEdge(vertex1);
+    for ( ; vertex1 != common_ancestor; vertex1 = vertex1->m_parent ) {
+      KinEdge* p_edge = vertex1->m_parentEdge;
 
       //int dof_id = p_edge->Cycle_DOF_id;
       int dof_id = p_edge->getDOF()->getCycleIndex();
@@ -794,7 +824,7 @@ void Configuration::computeJacobians() {
           double HydroTranslationEntry1= dot(t1,derivativeP1);
           double HydroTranslationEntry2= dot(t2,derivativeP1);
 
-          gsl_matrix_set(CycleJacobian,i + 0, dof_id, jacobianEntry1D); //set: Matrix, row, column, what to set
+          setCycleJacobianEntry(i + 0, dof_id, jacobianEntry1D); //set: Matrix, row, column, what to set
           gsl_matrix_set(HydrophobicBondJacobian, hydroidx + 0,dof_id,HydroTranslationEntry1);
           gsl_matrix_set(HydrophobicBondJacobian, hydroidx + 1,dof_id,HydroTranslationEntry2);
           gsl_matrix_set(HydrophobicBondJacobian, hydroidx + 2,dof_id,jacobianEntryRot1);
@@ -803,9 +833,9 @@ void Configuration::computeJacobians() {
         }
         else {
             /// These three constraints are equal for distance and hydrogen bond
-            gsl_matrix_set(CycleJacobian, i + 0, dof_id, jacobianEntryTrans.x); //set: Matrix, row, column, what to set
-            gsl_matrix_set(CycleJacobian, i + 1, dof_id, jacobianEntryTrans.y);
-            gsl_matrix_set(CycleJacobian, i + 2, dof_id, jacobianEntryTrans.z);
+            setCycleJacobianEntry(i + 0, dof_id, jacobianEntryTrans.x); //set: Matrix, row, column, what to set
+            setCycleJacobianEntry(i + 1, dof_id, jacobianEntryTrans.y);
+            setCycleJacobianEntry(i + 2, dof_id, jacobianEntryTrans.z);
 
             if (bond_ptr->isDBond()) {//Dbonds
               gsl_matrix_set(DBondJacobian, didx + 0, dof_id, jacobianEntryRot1);
@@ -813,20 +843,18 @@ void Configuration::computeJacobians() {
               gsl_matrix_set(DBondJacobian, didx + 2, dof_id, hBondEntry);
             }
             else{ //HBonds and default
-              gsl_matrix_set(CycleJacobian, i + 3, dof_id, jacobianEntryRot1);
-              gsl_matrix_set(CycleJacobian, i + 4, dof_id, jacobianEntryRot2);
+              setCycleJacobianEntry(i + 3, dof_id, jacobianEntryRot1);
+              setCycleJacobianEntry(i + 4, dof_id, jacobianEntryRot2);
               ///Matrix to check hBond Rotation
               gsl_matrix_set(HBondJacobian, hbidx, dof_id, hBondEntry);
             }
         }
 
       }
-      vertex1 = parent;
     }
     // trace back until the common ancestor from vertex2
-    while ( vertex2 != common_ancestor ) {
-      KinVertex *parent = vertex2->m_parent;
-      KinEdge *p_edge = parent->findEdge(vertex2);
+    for ( ; vertex2 != common_ancestor; vertex2 = vertex2->m_parent ) {
+      KinEdge *p_edge = vertex2->m_parentEdge;
 
 //			int dof_id = p_edge->Cycle_DOF_id;
       int dof_id = p_edge->getDOF()->getCycleIndex();
@@ -846,7 +874,7 @@ void Configuration::computeJacobians() {
             double HydroTranslationEntry1= -dot(t1,derivativeP2);
             double HydroTranslationEntry2= -dot(t2,derivativeP2);
 
-            gsl_matrix_set(CycleJacobian, i + 0, dof_id, jacobianEntry1D); //set: Matrix, row, column, what to set
+            setCycleJacobianEntry(i + 0, dof_id, jacobianEntry1D); //set: Matrix, row, column, what to set
             gsl_matrix_set(HydrophobicBondJacobian, hydroidx + 0,dof_id,HydroTranslationEntry1);
             gsl_matrix_set(HydrophobicBondJacobian, hydroidx + 1,dof_id,HydroTranslationEntry2);
             gsl_matrix_set(HydrophobicBondJacobian, hydroidx + 2,dof_id,jacobianEntryRot1);
@@ -855,9 +883,9 @@ void Configuration::computeJacobians() {
         }
         else {//DBond or HBond or Default
           /// These three constraints are equal for distance and hydrogen bond
-          gsl_matrix_set(CycleJacobian, i + 0, dof_id, jacobianEntryTrans.x); //set: Matrix, row, column, what to set
-          gsl_matrix_set(CycleJacobian, i + 1, dof_id, jacobianEntryTrans.y);
-          gsl_matrix_set(CycleJacobian, i + 2, dof_id, jacobianEntryTrans.z);
+          setCycleJacobianEntry(i + 0, dof_id, jacobianEntryTrans.x); //set: Matrix, row, column, what to set
+          setCycleJacobianEntry(i + 1, dof_id, jacobianEntryTrans.y);
+          setCycleJacobianEntry(i + 2, dof_id, jacobianEntryTrans.z);
 
           if (bond_ptr->isDBond()) {//Dbonds
             gsl_matrix_set(DBondJacobian, didx + 0, dof_id, jacobianEntryRot1);
@@ -865,14 +893,13 @@ void Configuration::computeJacobians() {
             gsl_matrix_set(DBondJacobian, didx + 2, dof_id, hBondEntry);
           }
           else{ //HBonds and default
-            gsl_matrix_set(CycleJacobian, i + 3, dof_id, jacobianEntryRot1);
-            gsl_matrix_set(CycleJacobian, i + 4, dof_id, jacobianEntryRot2);
+            setCycleJacobianEntry(i + 3, dof_id, jacobianEntryRot1);
+            setCycleJacobianEntry(i + 4, dof_id, jacobianEntryRot2);
             ///Matrix to check hBond Rotation
             gsl_matrix_set(HBondJacobian, hbidx, dof_id, hBondEntry);
           }
         }
       }
-      vertex2 = parent;
     }
 
     if(bond_ptr->isDBond()){//3 constraints, 3 rel. DOF
@@ -888,6 +915,9 @@ void Configuration::computeJacobians() {
       hbidx++;
     }
   }
+
+  if(sparse!=nullptr)
+    sparse->compress();
 }
 
 
@@ -961,14 +991,14 @@ void Configuration::computeClashAvoidingJacobian (std::map< std::pair<Atom*,Atom
 
   if(ClashAvoidingJacobian==nullptr){
     ClashAvoidingJacobian = gsl_matrix_calloc(rowNum,colNum);
-    JacobianSVD = SVD::createSVD(ClashAvoidingJacobian);//new SVDMKL(ClashAvoidingJacobian);
+    JacobianSVD = SVD::createSVD(ClashAvoidingJacobian, true);//new SVDMKL(ClashAvoidingJacobian);
   }else if(ClashAvoidingJacobian->size1==rowNum && ClashAvoidingJacobian->size2==colNum){
     gsl_matrix_set_zero(ClashAvoidingJacobian);
   }else{
     gsl_matrix_free(ClashAvoidingJacobian);
     ClashAvoidingJacobian = gsl_matrix_calloc(rowNum,colNum);
     delete JacobianSVD;
-    JacobianSVD = SVD::createSVD(ClashAvoidingJacobian);//new SVDMKL(ClashAvoidingJacobian);
+    JacobianSVD = SVD::createSVD(ClashAvoidingJacobian, true);//new SVDMKL(ClashAvoidingJacobian);
   }
 
   //Convert the cycle Jacobian to a full Jacobian
@@ -1104,9 +1134,12 @@ void Configuration::convertCycleDofsToAllDofs( gsl_vector *allDofsAfter, gsl_vec
 }
 
 void Configuration::projectOnCycleNullSpace (gsl_vector *to_project, gsl_vector *after_project) {
+  ProjectionWorkspace workspace;
+  projectOnCycleNullSpace(to_project, after_project, workspace);
+}
+
+void Configuration::projectOnCycleNullSpace (gsl_vector *to_project, gsl_vector *after_project, ProjectionWorkspace& workspace) {
   Nullspace* N = getNullspace();
-  //Since we're only using this for converting Cycle-DOF ids the mol doesnt have to be updated
-  Molecule* M = getMolecule();
 
   if(N==nullptr){
     gsl_vector_memcpy(after_project, to_project);
@@ -1117,33 +1150,76 @@ void Configuration::projectOnCycleNullSpace (gsl_vector *to_project, gsl_vector
     // The input vectors contain all DOFs, however, the null space only contains DOFs in cycles.
     // Convert the DOFs in the input vectors to DOFs in cycles.
 
-    gsl_vector *to_proj_short = gsl_vector_calloc(N->getNumDOFs());
-    convertAllDofsToCycleDofs(to_proj_short, to_project);
+    gsl_vector_view to_proj_short = workspace.vector(ProjectionWorkspace::CYCLE_INPUT, N->getNumDOFs());
+    gsl_vector_set_zero(&to_proj_short.vector);
+    convertAllDofsToCycleDofs(&to_proj_short.vector, to_project);
 
     // Project onto the null space
-    double normBefore = gsl_vector_length(to_proj_short);
-    gsl_vector *after_proj_short = gsl_vector_calloc(N->getNumDOFs());
-    N->projectOnNullSpace(to_proj_short, after_proj_short);
-    double normAfter = gsl_vector_length(after_proj_short);
+    double normBefore = gsl_vector_length(&to_proj_short.vector);
+    gsl_vector_view after_proj_short = workspace.vector(ProjectionWorkspace::CYCLE_OUTPUT, N->getNumDOFs());
+    N->projectOnNullSpace(&to_proj_short.vector, &after_proj_short.vector, workspace);
+    double normAfter = gsl_vector_length(&after_proj_short.vector);
 
     //Scale projected gradient to same norm as unprojected
     if(normAfter>0.0000001)
-      gsl_vector_scale(after_proj_short, normBefore/normAfter);
+      gsl_vector_scale(&after_proj_short.vector, normBefore/normAfter);
 
     // Convert back to full length DOFs vector
-    convertCycleDofsToAllDofs(after_project,after_proj_short,to_project);
-
-    gsl_vector_free(to_proj_short);
-    gsl_vector_free(after_proj_short);
+    convertCycleDofsToAllDofs(after_project,&after_proj_short.vector,to_project);
   }
   else {
     double normBefore = gsl_vector_length(to_project);
-    N->projectOnNullSpace(to_project, after_project);
+    N->projectOnNullSpace(to_project, after_project, workspace);
     double normAfter = gsl_vector_length(after_project);
     gsl_vector_scale(after_project, normBefore/normAfter);
   }
 }
 
+void Configuration::projectOnCycleNullSpace (gsl_matrix *to_project, gsl_matrix *after_project, ProjectionWorkspace& workspace) {
+  Nullspace* N = getNullspace();
+
+  if(N==nullptr){
+    gsl_matrix_memcpy(after_project, to_project);
+    return;
+  }
+
+  const size_t numGradients = to_project->size2;
+  const bool allDofs = to_project->size1 > N->getNumDOFs();
+  gsl_matrix* to_proj_short = to_project;
+  gsl_matrix* after_proj_short = after_project;
+  gsl_matrix_view to_proj_view, after_proj_view;
+  if(allDofs) {
+    to_proj_view = workspace.matrix(ProjectionWorkspace::CYCLE_INPUT, N->getNumDOFs(), numGradients);
+    after_proj_view = workspace.matrix(ProjectionWorkspace::CYCLE_OUTPUT, N->getNumDOFs(), numGradients);
+    to_proj_short = &to_proj_view.matrix;
+    after_proj_short = &after_proj_view.matrix;
+    gsl_matrix_set_zero(to_proj_short);
+    for (size_t c = 0; c < numGradients; c++) {
+      gsl_vector_view in = gsl_matrix_column(to_project, c);
+      gsl_vector_view in_short = gsl_matrix_column(to_proj_short, c);
+      convertAllDofsToCycleDofs(&in_short.vector, &in.vector);
+    }
+  }
+
+  N->projectOnNullSpace(to_proj_short, after_proj_short, workspace);
+
+  //Scale each projected gradient to the norm of the unprojected and convert back to all DOFs
+  for (size_t c = 0; c < numGradients; c++) {
+    gsl_vector_view in_short = gsl_matrix_column(to_proj_short, c);
+    gsl_vector_view out_short = gsl_matrix_column(after_proj_short, c);
+    double normBefore = gsl_blas_dnrm2(&in_short.vector);
+    double normAfter = gsl_blas_dnrm2(&out_short.vector);
+    if(normAfter>0.0000001)
+      gsl_vector_scale(&out_short.vector, normBefore/normAfter);
+
+    if(allDofs) {
+      gsl_vector_view in = gsl_matrix_column(to_project, c);
+      gsl_vector_view out = gsl_matrix_column(after_project, c);
+      convertCycleDofsToAllDofs(&out.vector, &out_short.vector, &in.vector);
+    }
+  }
+}
+
 double Configuration::siteDOFTransfer(Selection& source,Selection& sink,gsl_matrix* baseMatrix){
   ///Identify "allostery" through degrees of freedom shared/linked between two sites
   double ret=0.0;
@@ -1329,11 +1405,25 @@ Nullspace* Configuration::getNullspace()
 {
   if(nullspace==nullptr){
       computeCycleJacobianAndNullSpace();
+  }else if(nullspace->isCompressed()){
+      nullspace->decompress();
   }
+  NullspaceCache::touch(this);
 
   return nullspace;
 }
 
+void Configuration::copyNullspace(const gsl_matrix* basis, int nullspaceSize)
+{
+  deleteNullspace();
+  computeJacobians();
+  if (CycleJacobian==nullptr) return;
+
+  nullspace = Nullspace::create(CycleJacobian, JacobianSVD, CycleJacobianSparse);
+  nullspace->copyBasis(basis, nullspaceSize);
+  NullspaceCache::touch(this);
+}
+
 Nullspace* Configuration::getNullspacenocoupling()
 {
     if(nullspacenocoupling==nullptr){
@@ -1535,9 +1625,9 @@ void Configuration::computeCycleJacobianentropyforall(){
         //if (!(*itr)->getligand()) {
         KinVertex *vertex1 = (*itr)->getRigidbody()->getVertex();
         Coordinate p1 = (*itr)->m_position;
-        while (vertex1->m_parent->m_rigidbody != nullptr && vertex1->m_parent != nullptr) {
-            KinVertex *parent = vertex1->m_parent;
-            KinEdge *p_edge = parent->findEdge(vertex1);
+        for (KinVertex* v = vertex1; v->m_parentEdge != nullptr; v = v->m_parent) {
+            KinEdge* p_edge = v->m_parentEdge;
+            if (p_edge->StartVertex->m_rigidbody == nullptr) break; //Global DOFs are not included
             int dof_id = p_edge->getDOF()->getIndex();
             int cycle_dof_id = p_edge->getDOF()->getCycleIndex();
             if (dof_id != -1) { // this edge is a DOF  && !p_edge->getDOF()->isDOFligand()
@@ -1546,7 +1636,6 @@ void Configuration::computeCycleJacobianentropyforall(){
                 gsl_matrix_set(CycleJacobianentropy, 3 * t + 1, dof_id, derivativeP1.y);
                 gsl_matrix_set(CycleJacobianentropy, 3 * t + 2, dof_id, derivativeP1.z);
             }
-            vertex1 = parent;
         }
         t++;
         //}
@@ -89,6 +89,10 @@ class Configuration
 //  void identifyBiggerRigidBodies();      ///< Identify clusters
 //  void readBiggerSet();                  ///< read the set of clusters, related to identifying clusters
   void projectOnCycleNullSpace (gsl_vector *to_project, gsl_vector *after_project);
+  /** Same as above, but temporaries are taken from `workspace` so repeated calls don't allocate. */
+  void projectOnCycleNullSpace (gsl_vector *to_project, gsl_vector *after_project, ProjectionWorkspace& workspace);
+  /** Project each column of `to_project` (one gradient per column) in one batch. */
+  void projectOnCycleNullSpace (gsl_matrix *to_project, gsl_matrix *after_project, ProjectionWorkspace& workspace);
 
   void convertAllDofsToCycleDofs( gsl_vector *cycleDofs, gsl_vector *allDofs);
   void convertCycleDofsToAllDofs( gsl_vector *allDofsAfter, gsl_vector *cycleDofs, gsl_vector *allDofsBefore = nullptr);
@@ -125,6 +129,13 @@ class Configuration
   /** Return the cycle jacobian. Calls computeJacobians if CycleJacobian is not up to date */
   gsl_matrix* getCycleJacobian();
   Nullspace* getNullspace();    ///< Compute the nullspace (if it wasn't already) and return it
+
+  /**
+   * Use a copy of `basis` as nullspace instead of decomposing the cycle jacobian. `basis` must be the
+   * nullspace basis of a configuration with the same DOF-values of an identical molecule, e.g. the
+   * configuration a KinematicWorkspace imported this one from.
+   */
+  void copyNullspace(const gsl_matrix* basis, int nullspaceSize);
   //Nullspace* getNullspaceligand();  ///< Compute the nullspace for ligand (if it wasn't already) and return it
   Nullspace* getNullspacenocoupling();
   void Hessianmatrixentropy(double cutoff=20.0, double coefficientvalue=1.0, double vdwenergyvalue=10000.0, Nullspace* Nu=nullptr, Molecule* mol=nullptr, bool proteinonly=false, std::string nocoupling="true");  ///< Compute the nullspace for vibrational entropy (if it wasn't already) and return it
@@ -165,31 +176,36 @@ class Configuration
   void computeJacobians();               ///< Compute non-redundant cycle jacobian and hbond-jacobian // and also HydrophobicBond-jacobian
   // Jacobian matrix of all the cycles of rigid bodies
   void computeJacobiansnocoupling();
-  static gsl_matrix* CycleJacobian; // column dimension is the number of DOFs; row dimension is 5 times the number of cycles because 2 atoms on each cycle-closing edge
+  // The jacobians and their SVD are scratch space shared by all configurations of a thread. They are
+  // thread_local so configurations of different molecules (see KinematicWorkspace) can be evaluated in parallel.
+  static thread_local gsl_matrix* CycleJacobian; // column dimension is the number of DOFs; row dimension is 5 times the number of cycles because 2 atoms on each cycle-closing edge
   //static gsl_matrix* CycleJacobianligand;// column dimension is the number of DOFS; row dimension is the number of cycles\//
   //static gsl_matrix* ClashAvoidingJacobian;
   //Nullspace* nullspaceligand;
   //static SVD* JacobianSVDligand;
-  static gsl_matrix* CycleJacobiannocoupling;
+  static thread_local gsl_matrix* CycleJacobiannocoupling;
   gsl_matrix* CycleJacobianentropy;// column dimension is the number of DOFS; row dimension is the number of cycles\//
   gsl_matrix* CycleJacobianentropycoupling;
   gsl_matrix* CycleJacobianentropynocoupling;
   gsl_matrix* Hessianmatrix_cartesian;
-  static gsl_matrix* Massmatrix;
-  static gsl_matrix* distancematrix;
-  static gsl_matrix* coefficientmatrix;
+  static thread_local gsl_matrix* Massmatrix;
+  static thread_local gsl_matrix* distancematrix;
+  static thread_local gsl_matrix* coefficientmatrix;
   Eigenvalue* Entropyeigen;
-  static gsl_matrix* HBondJacobian; // column dimension is the number of DOFS; row dimension is the number of cycles\//
-  static gsl_matrix* HydrophobicBondJacobian; //column dimension is the number of DOFs; row dimension is the 5 times the number of Hydrophobic bond
-  static gsl_matrix* DBondJacobian; //column dimension is the number of DOFs; row dimension is the 5 times the number of Hydrophobic bond
-  static Configuration* CycleJacobianOwner;
-
-  static SVD* JacobianSVD;
-  static SVD* JacobianSVDnocoupling;
+  static thread_local gsl_matrix* HBondJacobian; // column dimension is the number of DOFS; row dimension is the number of cycles\//
+  static thread_local gsl_matrix* HydrophobicBondJacobian; //column dimension is the number of DOFs; row dimension is the 5 times the number of Hydrophobic bond
+  static thread_local gsl_matrix* DBondJacobian; //column dimension is the number of DOFs; row dimension is the 5 times the number of Hydrophobic bond
+  static thread_local Configuration* CycleJacobianOwner;
+
+  static thread_local SVD* JacobianSVD;
+  static thread_local SparseMatrix* CycleJacobianSparse; ///< Non-zeros of CycleJacobian. Only assembled for the sparse nullspace
+  static thread_local SVD* JacobianSVDnocoupling;
   Nullspace* nullspace;                  ///< Nullspace of hbond of this configuration
   Nullspace* nullspacenocoupling;
   Nullspace* nullspaceHydro;
-  
+  bool m_rigidityAnalyzed;               ///< Whether rigidityAnalysis ran, so a recomputed nullspace must repeat it
+
+  friend class NullspaceCache;
 };
 
 
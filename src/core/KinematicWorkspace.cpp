@@ -0,0 +1,102 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#include <cassert>
+#include <cstring>
+
+#include "KinematicWorkspace.h"
+#include "Molecule.h"
+#include "Configuration.h"
+#include "Selection.h"
+#include "Logger.h"
+
+using namespace std;
+
+KinematicWorkspace::KinematicWorkspace(Molecule* prototype,
+                                       Selection& movingResidues,
+                                       double collisionFactor,
+                                       const std::vector<int>& roots,
+                                       Molecule* target)
+{
+  //Hydrogen bonds take their ideal geometry from the positions at the time they're cloned
+  Configuration* current = prototype->m_conf;
+  prototype->setConfiguration(nullptr);
+  m_molecule = prototype->deepClone();
+  if(current!=nullptr)
+    prototype->setConfiguration(current);
+
+  m_molecule->initializeTree(movingResidues, collisionFactor, roots, target);
+
+  unsigned int expected = prototype->m_spanningTree->getNumDOFs();
+  if(m_molecule->m_spanningTree->getNumDOFs()!=expected){
+    cerr<<"KinematicWorkspace::KinematicWorkspace - workspace molecule has "<<m_molecule->m_spanningTree->getNumDOFs();
+    cerr<<" DOFs but "<<prototype->getName()<<" has "<<expected<<". Use the arguments passed to initializeTree."<<endl;
+    exit(-1);
+  }
+  log("debug")<<"KinematicWorkspace - cloned "<<prototype->getName()<<" with "<<expected<<" DOFs"<<endl;
+}
+
+KinematicWorkspace::~KinematicWorkspace()
+{
+  delete m_molecule;
+}
+
+Molecule* KinematicWorkspace::getMolecule() const
+{
+  return m_molecule;
+}
+
+ProjectionWorkspace& KinematicWorkspace::getProjectionWorkspace()
+{
+  return m_projectionWorkspace;
+}
+
+Configuration* KinematicWorkspace::importConfiguration(const Configuration* conf)
+{
+  assert(conf->getNumDOFs()==m_molecule->m_spanningTree->getNumDOFs());
+
+  Configuration* ret = new Configuration(m_molecule);
+  memcpy(ret->m_dofs, conf->m_dofs, sizeof(double)*conf->getNumDOFs());
+  ret->m_id = conf->m_id;
+  return ret;
+}
+
+void KinematicWorkspace::exportConfiguration(const Configuration* conf, Configuration* target) const
+{
+  assert(conf->getNumDOFs()==target->getNumDOFs());
+
+  memcpy(target->m_dofs, conf->m_dofs, sizeof(double)*conf->getNumDOFs());
+  target->m_vdwEnergy           = conf->m_vdwEnergy;
+  target->m_deltaH              = conf->m_deltaH;
+  target->m_distanceToTarget    = conf->m_distanceToTarget;
+  target->m_distanceToParent    = conf->m_distanceToParent;
+  target->m_distanceToIni       = conf->m_distanceToIni;
+  target->m_minCollisionFactor  = conf->m_minCollisionFactor;
+  target->m_usedClashPrevention = conf->m_usedClashPrevention;
+  target->m_clashFreeDofs       = conf->m_clashFreeDofs;
+}
@@ -0,0 +1,86 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#ifndef KGS_KINEMATICWORKSPACE_H
+#define KGS_KINEMATICWORKSPACE_H
+
+#include <vector>
+
+#include "math/ProjectionWorkspace.h"
+
+class Molecule;
+class Configuration;
+class Selection;
+
+/**
+ * Everything a thread needs to evaluate moves independently of other threads. A Molecule holds a
+ * single set of atom positions, a collision grid and a kinematic tree, so configurations of one
+ * molecule can't be updated concurrently. A workspace owns a private copy of the molecule built
+ * with the same moving residues and roots, which gives it identical DOFs, along with projection
+ * scratch buffers. The jacobians and their SVD kept by Configuration are thread_local, so each
+ * thread using its own workspace also has its own jacobian state.
+ *
+ * Configurations are moved between the shared molecule and a workspace by DOF values:
+ * `importConfiguration` gives a workspace configuration to evaluate moves from, and
+ * `exportConfiguration` copies a result into a configuration of the shared molecule. A workspace
+ * must only be used by one thread at a time, and its configurations should be deleted on that
+ * thread as the jacobian cache of Configuration is per thread.
+ */
+class KinematicWorkspace {
+ public:
+  /**
+   * Clone `prototype` at its reference positions and build its tree with the same arguments as
+   * were passed to Molecule::initializeTree for the prototype.
+   */
+  KinematicWorkspace(Molecule* prototype,
+                     Selection& movingResidues,
+                     double collisionFactor,
+                     const std::vector<int>& roots = {},
+                     Molecule* target = nullptr);
+
+  ~KinematicWorkspace();
+
+  Molecule* getMolecule() const;                      ///< The private molecule of this workspace
+  ProjectionWorkspace& getProjectionWorkspace();      ///< Scratch buffers for nullspace projections
+
+  /** Return a new configuration of the workspace molecule with the DOF-values of `conf`. */
+  Configuration* importConfiguration(const Configuration* conf);
+
+  /**
+   * Copy the DOF-values and evaluation results (energy, distances, clash info) of the workspace
+   * configuration `conf` to `target`, usually a configuration of the prototype. Only `target` is
+   * modified so this is safe while other threads work on the prototype's other configurations.
+   */
+  void exportConfiguration(const Configuration* conf, Configuration* target) const;
+
+ private:
+  Molecule* m_molecule;
+  ProjectionWorkspace m_projectionWorkspace;
+};
+
+#endif //KGS_KINEMATICWORKSPACE_H
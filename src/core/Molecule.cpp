@@ -70,7 +70,13 @@ const double VDW_R_MAX = 8; // only compute vdw energy if R_ab <= 8A
 using namespace std;
 
 
+std::atomic<unsigned long> Molecule::m_nextUniqueId(0);
+std::map<int, std::function<void(unsigned long)> > Molecule::m_destructionListeners;
+int Molecule::m_nextListenerHandle = 0;
+std::mutex Molecule::m_listenerMutex;
+
 Molecule::Molecule():
+  m_uniqueId(m_nextUniqueId++),
   m_name("UNKNOWN"),
   m_grid(nullptr),
   m_spanningTree(nullptr),
@@ -80,6 +86,12 @@ Molecule::Molecule():
 }
 
 Molecule::~Molecule() {
+  {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    for (auto const &listener: m_destructionListeners)
+      listener.second(m_uniqueId);
+  }
+
   // delete all atoms
   for (vector<Atom *>::iterator it = m_atoms.begin(); it != m_atoms.end(); ++it) {
     delete (*it);
@@ -128,6 +140,21 @@ string Molecule::getName () const {
   return m_name;
 }
 
+unsigned long Molecule::getUniqueId () const {
+  return m_uniqueId;
+}
+
+int Molecule::addDestructionListener (const std::function<void(unsigned long)>& listener) {
+  std::lock_guard<std::mutex> lock(m_listenerMutex);
+  m_destructionListeners[m_nextListenerHandle] = listener;
+  return m_nextListenerHandle++;
+}
+
+void Molecule::removeDestructionListener (int handle) {
+  std::lock_guard<std::mutex> lock(m_listenerMutex);
+  m_destructionListeners.erase(handle);
+}
+
 Atom* Molecule::addAtom(
     const bool& hetatm,
     const std::string& chainName,
@@ -777,8 +804,7 @@ void Molecule::_SetConfiguration(Configuration *q ){
     m_spanningTree->getDOF(id)->setValue(q->m_dofs[id]);
   }
 
-  KinVertex *root = m_spanningTree->m_root;
-  root->forwardPropagate();
+  m_spanningTree->forwardPropagate();
 
 //  indexAtoms();
   m_grid = nullptr;
@@ -33,6 +33,9 @@ IN THE SOFTWARE.
 #include <string>
 #include <list>
 #include <set>
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <core/graph/KinTree.h>
 
 #include "Rigidbody.h"
@@ -60,6 +63,14 @@ class Molecule {
 
   void setName(const std::string& name);
   std::string getName() const;
+  /** Id that no other molecule of this process has, unlike the address, which can be reused after deletion */
+  unsigned long getUniqueId() const;
+  /**
+   * Call `listener` with the unique id of each molecule destroyed from now on, so caches keyed by molecule can
+   * drop their entries. Listeners run on the destroying thread. Returns a handle for removeDestructionListener.
+   */
+  static int addDestructionListener(const std::function<void(unsigned long)>& listener);
+  static void removeDestructionListener(int handle);
   Chain* getChain (const std::string& chainName) const;
   const std::vector<Chain*>  getChains () const { return m_chains;};
   Atom* getAtom (int atom_id) const;
@@ -128,6 +139,11 @@ class Molecule {
   void initializeTree(Selection& movingResidues,double collisionFactor = 1.0, const std::vector<int> &roots = {},Molecule* target = nullptr);
 
  private:
+  static std::atomic<unsigned long> m_nextUniqueId;
+  static std::map<int, std::function<void(unsigned long)> > m_destructionListeners;
+  static int m_nextListenerHandle;
+  static std::mutex m_listenerMutex;
+  const unsigned long m_uniqueId;
   std::string m_name;
   std::set< std::pair<Atom*,Atom*> > m_initialCollisions; ///< Colliding atom-pairs in the initial conformation
   Grid *m_grid;
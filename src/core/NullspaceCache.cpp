@@ -0,0 +1,132 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#include "NullspaceCache.h"
+#include "Configuration.h"
+#include "Logger.h"
+
+using namespace std;
+
+size_t NullspaceCache::m_budget = 0;
+bool NullspaceCache::m_floatStorage = false;
+size_t NullspaceCache::m_usage = 0;
+long NullspaceCache::m_evictions = 0;
+long NullspaceCache::m_compressions = 0;
+std::list<Configuration*> NullspaceCache::m_lru;
+std::unordered_map<Configuration*, NullspaceCache::Entry> NullspaceCache::m_entries;
+std::recursive_mutex NullspaceCache::m_mutex;
+
+void NullspaceCache::setBudget(size_t bytes)
+{
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
+  m_budget = bytes;
+  evict();
+}
+
+void NullspaceCache::setFloatStorage(bool enable)
+{
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
+  m_floatStorage = enable;
+}
+
+void NullspaceCache::touch(Configuration* conf)
+{
+  if(conf->nullspace==nullptr) return;
+
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
+  if(m_budget==0) return;
+
+  size_t bytes = conf->nullspace->getMemoryUsage();
+  auto it = m_entries.find(conf);
+  if(it==m_entries.end()){
+    m_lru.push_front(conf);
+    m_entries[conf] = {m_lru.begin(), bytes};
+  }else{
+    m_lru.splice(m_lru.begin(), m_lru, it->second.position);
+    m_usage -= it->second.bytes;
+    it->second.bytes = bytes;
+  }
+  m_usage += bytes;
+
+  evict();
+}
+
+void NullspaceCache::remove(Configuration* conf)
+{
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
+  auto it = m_entries.find(conf);
+  if(it==m_entries.end()) return;
+
+  m_usage -= it->second.bytes;
+  m_lru.erase(it->second.position);
+  m_entries.erase(it);
+}
+
+void NullspaceCache::evict()
+{
+  if(m_budget==0) return;
+
+  //Compress the coldest nullspaces first. The most recently used one is never evicted.
+  if(m_floatStorage){
+    for(auto it = m_lru.rbegin(); m_usage>m_budget && std::next(it)!=m_lru.rend(); ++it){
+      Configuration* conf = *it;
+      if(conf->nullspace->isCompressed()) continue;
+      Entry& entry = m_entries[conf];
+      conf->nullspace->compress();
+      size_t bytes = conf->nullspace->getMemoryUsage();
+      m_usage = m_usage - entry.bytes + bytes;
+      entry.bytes = bytes;
+      m_compressions++;
+    }
+  }
+
+  //Then delete them. Configuration::deleteNullspace calls remove
+  while(m_usage>m_budget && m_lru.size()>1){
+    log("debug")<<"NullspaceCache::evict - deleting nullspace of "<<m_lru.back()<<endl;
+    m_lru.back()->deleteNullspace();
+    m_evictions++;
+  }
+}
+
+size_t NullspaceCache::getMemoryUsage()
+{
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
+  return m_usage;
+}
+
+long NullspaceCache::getNumEvictions()
+{
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
+  return m_evictions;
+}
+
+long NullspaceCache::getNumCompressions()
+{
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
+  return m_compressions;
+}
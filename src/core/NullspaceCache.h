@@ -0,0 +1,94 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+#ifndef KGS_NULLSPACECACHE_H
+#define KGS_NULLSPACECACHE_H
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <cstddef>
+
+class Configuration;
+
+/**
+ * Keeps the memory held by the nullspaces of configurations below a budget. Configurations
+ * report use of their nullspace with `touch`. When the budget is exceeded the least recently
+ * used nullspaces are evicted: They are first compressed to single precision (if enabled) and
+ * otherwise deleted, in which case Configuration::getNullspace recomputes them (and repeats a
+ * rigidity analysis done on them) on demand.
+ *
+ * The budget is 0 (unlimited) by default, in which case nothing is tracked. With a budget, a
+ * pointer returned by Configuration::getNullspace should not be kept across calls to
+ * getNullspace of other configurations.
+ *
+ * All methods may be called from several threads. Eviction can however delete the nullspace of a
+ * configuration another thread is projecting onto, so a budget must not be set while configurations
+ * are worked on in parallel (with --threads kgs_explore only bounds the bases kept by RRTPlanner).
+ */
+class NullspaceCache {
+ public:
+  /** Set the memory budget in bytes. 0 disables the cache. */
+  static void setBudget(size_t bytes);
+
+  /** Compress cold nullspaces to single precision before deleting them */
+  static void setFloatStorage(bool enable);
+
+  /** Mark the nullspace of `conf` as most recently used and evict others if over budget */
+  static void touch(Configuration* conf);
+
+  /** Stop tracking `conf`, e.g. because its nullspace or the configuration itself is deleted */
+  static void remove(Configuration* conf);
+
+  /** Bytes held by tracked nullspaces */
+  static size_t getMemoryUsage();
+
+  /** Number of nullspaces deleted to stay below the budget */
+  static long getNumEvictions();
+
+  /** Number of nullspaces compressed to stay below the budget */
+  static long getNumCompressions();
+
+ private:
+  struct Entry {
+    std::list<Configuration*>::iterator position; ///< Position in m_lru
+    size_t bytes;                                 ///< Memory of the nullspace when last measured
+  };
+
+  static void evict();
+
+  static size_t m_budget;
+  static bool m_floatStorage;
+  static size_t m_usage;
+  static long m_evictions;
+  static long m_compressions;
+  static std::list<Configuration*> m_lru;                    ///< Most recently used first
+  static std::unordered_map<Configuration*, Entry> m_entries;
+  static std::recursive_mutex m_mutex;                       ///< Recursive as evict calls remove through deleteNullspace
+};
+
+#endif //KGS_NULLSPACECACHE_H
@@ -59,6 +59,11 @@ unsigned int DOF::getCycleIndex() const
   return (unsigned int)m_cycleIndex;
 }
 
+void DOF::updateEndVertexTransformation()
+{
+  m_edge->EndVertex->m_transformation = m_edge->StartVertex->m_transformation * getLocalTransformation();
+}
+
 void DOF::setIndex(unsigned int idx)
 {
   m_index = idx;
@@ -99,7 +99,13 @@ class DOF {
    * Update the m_transformation matrix in `m_edge->EndVertex` based on the one in `m_edge->StartVertex` and
    * the value for this DOF.
    */
-  virtual void updateEndVertexTransformation() = 0;
+  void updateEndVertexTransformation();
+
+  /**
+   * Return the transformation this DOF applies relative to `m_edge->StartVertex`. The transformation of
+   * `m_edge->EndVertex` is the one of `m_edge->StartVertex` multiplied by this.
+   */
+  virtual Math3D::RigidTransform getLocalTransformation() const = 0;
 
   /** Set the DOF index. Only called from KinTree. */
   void setIndex(unsigned int idx);
@@ -63,7 +63,9 @@ double FixedLink::getMaxPerturbation() const
   return m_maxValue;
 }
 
-void FixedLink::updateEndVertexTransformation()
+Math3D::RigidTransform FixedLink::getLocalTransformation() const
 {
-  m_edge->EndVertex->m_transformation = m_edge->StartVertex->m_transformation;
+  Math3D::RigidTransform tr;
+  tr.setIdentity();
+  return tr;
 }
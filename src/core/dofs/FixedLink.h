@@ -51,7 +51,7 @@ class FixedLink: public DOF {
 
  protected:
 
-  void updateEndVertexTransformation();
+  Math3D::RigidTransform getLocalTransformation() const;
 
  private:
   static const double m_maxValue;
@@ -78,7 +78,7 @@ double GlobalRotateDOF::getMaxPerturbation() const
   return m_maxValue;
 }
 
-void GlobalRotateDOF::updateEndVertexTransformation()
+Math3D::RigidTransform GlobalRotateDOF::getLocalTransformation() const
 {
   //if( std::fabs(m_value)<0.000001 ) {
   //  m_edge->EndVertex->m_transformation = m_edge->StartVertex->m_transformation;
@@ -109,6 +109,5 @@ void GlobalRotateDOF::updateEndVertexTransformation()
 
   ///New: Closed-form expression
   tr.setTranslation(m_firstAtom->m_position - tr.R*m_firstAtom->m_position);
-  m_edge->EndVertex->m_transformation =
-      m_edge->StartVertex->m_transformation * tr;
+  return tr;
 }
@@ -50,7 +50,7 @@ class GlobalRotateDOF: public DOF {
 
  protected:
 
-  void updateEndVertexTransformation() override;
+  Math3D::RigidTransform getLocalTransformation() const override;
 
  private:
   int m_axis;
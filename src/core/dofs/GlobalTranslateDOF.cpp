@@ -68,7 +68,7 @@ double GlobalTranslateDOF::getMaxPerturbation() const
   return m_maxValue;
 }
 
-void GlobalTranslateDOF::updateEndVertexTransformation()
+Math3D::RigidTransform GlobalTranslateDOF::getLocalTransformation() const
 {
   //if( std::fabs(m_value)<0.000001 ) {
   //  m_edge->EndVertex->m_transformation = m_edge->StartVertex->m_transformation;
@@ -78,6 +78,5 @@ void GlobalTranslateDOF::updateEndVertexTransformation()
   Math3D::RigidTransform tr;
   tr.setIdentity();
   tr.t.data[m_axis]=m_value;
-
-  m_edge->EndVertex->m_transformation = m_edge->StartVertex->m_transformation * tr;
+  return tr;
 }
@@ -60,7 +60,7 @@ double TorsionDOF::getMaxPerturbation() const
   return m_maxValue;
 }
 
-void TorsionDOF::updateEndVertexTransformation()
+Math3D::RigidTransform TorsionDOF::getLocalTransformation() const
 {
   //if( std::fabs(m_value)<0.000001 ) {
   //  m_edge->EndVertex->m_transformation = m_edge->StartVertex->m_transformation;
@@ -90,6 +90,5 @@ void TorsionDOF::updateEndVertexTransformation()
   m.setIdentity();
   m.setRotation(FindRotationMatrix(axis, -m_value));
   m.setTranslation(p1 - m.R * p1 );
-
-  m_edge->EndVertex->m_transformation = m_edge->StartVertex->m_transformation * m;
+  return m;
 }
@@ -49,7 +49,7 @@ class TorsionDOF: public DOF {
 
  protected:
 
-  void updateEndVertexTransformation() override;
+  Math3D::RigidTransform getLocalTransformation() const override;
 
  private:
   static const double m_maxValue;
@@ -184,6 +184,7 @@ KinTree::KinTree( const std::vector<Rigidbody*>& rigidbodies, const std::vector<
   }
 
   collectDOFs();
+  compile();
 
   //Sort cycle anchor edges to maintain constant row order for different roots
   //This is important for the hydrogen-bond hierarchy analysis!
@@ -195,14 +196,9 @@ KinTree::KinTree( const std::vector<Rigidbody*>& rigidbodies, const std::vector<
     KinVertex *lca = findCommonAncestor(h_edge->StartVertex, h_edge->EndVertex);
     m_cycleAnchorEdges.push_back(std::make_pair(h_edge, lca));
 
-    for( KinVertex *v = h_edge->StartVertex; v != lca; v = v->m_parent ) {
-      KinEdge *edge = v->m_parent->findEdge(v);
-      addCycleDOF(edge->getDOF());
-    }
-
-    for( KinVertex *v = h_edge->EndVertex; v != lca; v = v->m_parent ) {
-      KinEdge *edge = v->m_parent->findEdge(v);
-      addCycleDOF(edge->getDOF());
+    for( KinVertex *v: {h_edge->StartVertex, h_edge->EndVertex} ) {
+      for( ; v != lca; v = v->m_parent )
+        addCycleDOF(v->m_parentEdge->getDOF());
     }
   }
   setliganddofid();
@@ -365,6 +361,46 @@ KinVertex* KinTree::findCommonAncestor (KinVertex *v1, KinVertex *v2) {
   return ancestor;
 }
 
+void KinTree::compile()
+{
+  m_bfsVertices.clear();
+  m_bfsParent.clear();
+  m_bfsEdge.clear();
+
+  m_bfsVertices.push_back(m_root);
+  m_bfsParent.push_back(-1);
+  m_bfsEdge.push_back(nullptr);
+  m_root->m_parentEdge = nullptr;
+
+  //The vector itself is the queue: entries before `i` have been expanded
+  for(size_t i=0; i<m_bfsVertices.size(); ++i){
+    for(auto const& edge: m_bfsVertices[i]->m_edges){
+      m_bfsVertices.push_back(edge->EndVertex);
+      m_bfsParent.push_back(i);
+      m_bfsEdge.push_back(edge);
+      edge->EndVertex->m_parentEdge = edge;
+    }
+  }
+
+  m_bfsTransformation.resize(m_bfsVertices.size());
+  m_bfsTransformation[0] = m_root->m_transformation;
+}
+
+void KinTree::forwardPropagate()
+{
+  // Local transformations are defined using the positions of the axis atoms before the update, so all vertex
+  // transformations are computed before any atom is moved.
+  for(size_t i=1; i<m_bfsVertices.size(); ++i){
+    m_bfsTransformation[i] = m_bfsTransformation[m_bfsParent[i]] * m_bfsEdge[i]->getDOF()->getLocalTransformation();
+  }
+
+  for(size_t i=1; i<m_bfsVertices.size(); ++i){
+    KinVertex* v = m_bfsVertices[i];
+    v->m_transformation = m_bfsTransformation[i];
+    v->transformAtoms();
+  }
+}
+
 void KinTree::collectDOFs()
 {
   collectDOFs(m_root);
@@ -44,6 +44,15 @@ class KinTree: public KinGraph
   KinVertex *m_root;
   std::vector< std::pair<KinEdge*,KinVertex*> > m_cycleAnchorEdges; // pair<edge,common anchor>; each edge closes a cycle
 
+  /**
+   * Flattened copy of the tree in breadth-first order. The parent of entry i is always stored before i, so
+   * forward kinematics is a single loop over contiguous arrays. Entry 0 is the super-root. Built by `compile`.
+   */
+  std::vector<KinVertex*> m_bfsVertices;                 ///< Vertices in breadth-first order
+  std::vector<int> m_bfsParent;                          ///< Position of the parent in m_bfsVertices (-1 for root)
+  std::vector<KinEdge*> m_bfsEdge;                       ///< Tree-edge leading into the vertex (nullptr for root)
+  std::vector<Math3D::RigidTransform> m_bfsTransformation; ///< Global transformation of each vertex
+
   /** Build a tree that spans the rigid bodies with the specified roots */
   KinTree( const std::vector<Rigidbody*>& rigidbodies, const std::vector<Atom*>& roots );
 
@@ -69,6 +78,18 @@ class KinTree: public KinGraph
 
   /** Find the lowest common ancestor for v1 and v2 */
   KinVertex* findCommonAncestor (KinVertex *v1, KinVertex *v2);
+
+  /**
+   * Rebuild the flattened breadth-first arrays and the `m_parentEdge` of every vertex.
+   * Must be called again if tree-edges are added.
+   */
+  void compile();
+
+  /**
+   * Update all vertex transformations from the current DOF values and move atoms accordingly.
+   * Iterative replacement of `m_root->forwardPropagate()` that runs over the flattened arrays.
+   */
+  void forwardPropagate();
     
     void setliganddofid();
     std::vector<unsigned int> ligand_dof_id;
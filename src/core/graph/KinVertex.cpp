@@ -39,6 +39,7 @@ KinVertex::KinVertex (Rigidbody* rb_ptr):
     m_vertexligand(false)
 {
   m_parent = nullptr;
+  m_parentEdge = nullptr;
   Visited = false;
 
   if(rb_ptr!=nullptr)
@@ -38,6 +38,7 @@ public:
   Rigidbody * const m_rigidbody;
   std::vector<KinEdge*> m_edges;             ///< Child-m_edges after spanning tree has been created
   KinVertex *m_parent;                       ///< m_parent-vertex after spanning tree has been created
+  KinEdge *m_parentEdge;                     ///< Tree-edge from m_parent to this vertex (nullptr for the root). Set by KinTree::compile
   //TODO: Visited should be a local variable, not accessible to everyone here
   bool Visited;   ///< When finding common ancestor, vertices are marked as visited up to the m_root
   Math3D::RigidTransform m_transformation;   ///< The transformation to apply to atoms in the rigid body
@@ -55,6 +56,8 @@ public:
 
   void forwardPropagate();
 private:
+  friend class KinTree;
+
   void transformAtoms();
   bool m_vertexligand;
 };
@@ -63,15 +63,14 @@ void AtomPairDistanceDirection::computeGradient(Configuration* conf, Configurati
   KinVertex* nca = mol->m_spanningTree->findCommonAncestor(v1, v2);
 
   // Compute gradient contribution of DoFs between v1 and nca
-  while (v1 != nca){
-    KinEdge* parentEdge = v1->m_parent->findEdge(v1);
+  for ( ; v1 != nca; v1 = v1->m_parent ) {
+    KinEdge* parentEdge = v1->m_parentEdge;
     int dof_id = parentEdge->getDOF()->getIndex();
     Math3D::Vector3 deriv = parentEdge->getDOF()->getDerivative(a1->m_position);
 
     gradient[dof_id] += deriv.dot(diff);
     assert(!std::isnan(gradient[dof_id]));
 
-    v1 = v1->m_parent;
     dofCount++;
   }
 
@@ -79,15 +78,14 @@ void AtomPairDistanceDirection::computeGradient(Configuration* conf, Configurati
   diff *= (dist - desiredDist) / dist;
 
   // Compute gradient contribution of DoFs between v2 and nca
-  while (v2 != nca){
-    KinEdge* parentEdge = v2->m_parent->findEdge(v2);
+  for ( ; v2 != nca; v2 = v2->m_parent ) {
+    KinEdge* parentEdge = v2->m_parentEdge;
     int dof_id = parentEdge->getDOF()->getIndex();
     Math3D::Vector3 deriv = parentEdge->getDOF()->getDerivative(a2->m_position);
 
     gradient[dof_id] += deriv.dot(diff);
     assert( !std::isnan(gradient[dof_id]) );
 
-    v2 = v2->m_parent;
     dofCount++;
   }
 
@@ -172,8 +172,8 @@ void LSNrelativeDirection::fillmatrices(Configuration* current_q,
     KinVertex* currVertex2 = atom2->getRigidbody()->getVertex();
 
     //Trace back until the m_root from currVertex
-    while ( currVertex1->m_parent != NULL){
-      KinEdge* p_edge = currVertex1->m_parent->findEdge(currVertex1);
+    for (KinVertex* v = currVertex1; v->m_parentEdge != nullptr; v = v->m_parent) {
+      KinEdge* p_edge = v->m_parentEdge;
 
       int dof_id = p_edge->getDOF()->getIndex();
       if (dof_id!=-1) { // this edge is a DOF
@@ -186,11 +186,10 @@ void LSNrelativeDirection::fillmatrices(Configuration* current_q,
         gsl_matrix_set(targetJacobian,2*i*3+1,dof_id,derivativeP.y);
         gsl_matrix_set(targetJacobian,2*i*3+2,dof_id,derivativeP.z);
       }
-      currVertex1 = currVertex1->m_parent;
     }
     //Trace back until the m_root from currVertex
-    while ( currVertex2->m_parent != NULL){
-      KinEdge* p_edge = currVertex2->m_parent->findEdge(currVertex2);
+    for (KinVertex* v = currVertex2; v->m_parentEdge != nullptr; v = v->m_parent) {
+      KinEdge* p_edge = v->m_parentEdge;
 
       int dof_id = p_edge->getDOF()->getIndex();
       if (dof_id!=-1) { // this edge is a DOF
@@ -203,7 +202,6 @@ void LSNrelativeDirection::fillmatrices(Configuration* current_q,
         gsl_matrix_set(targetJacobian,2*i*3+4,dof_id,derivativeP.y);
         gsl_matrix_set(targetJacobian,2*i*3+5,dof_id,derivativeP.z);
       }
-      currVertex2 = currVertex2->m_parent;
     }
   }
   gsl_vector_free(u);
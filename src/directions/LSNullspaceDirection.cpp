@@ -140,8 +140,8 @@ void LSNullspaceDirection::fillmatrices(Configuration* current_q,
     gsl_matrix_set(targetPosition,i*3+2,0, aTarget->m_position.z - p.z);
 
     //Trace back until the m_root from currVertex
-    while ( currVertex->m_parent != NULL){
-      KinEdge* p_edge = currVertex->m_parent->findEdge(currVertex);
+    for (KinVertex* v = currVertex; v->m_parentEdge != nullptr; v = v->m_parent) {
+      KinEdge* p_edge = v->m_parentEdge;
 
       int dof_id = p_edge->getDOF()->getIndex();
       if (dof_id!=-1) { // this edge is a DOF
@@ -154,7 +154,6 @@ void LSNullspaceDirection::fillmatrices(Configuration* current_q,
         gsl_matrix_set(targetJacobian,i*3+1,dof_id,derivativeP.y);
         gsl_matrix_set(targetJacobian,i*3+2,dof_id,derivativeP.z);
       }
-      currVertex = currVertex->m_parent;
     }
     i++;
   }
@@ -82,17 +82,14 @@ void MSDDirection::computeGradient(Configuration* conf, Configuration* c_target,
     Math3D::Vector3 diff = aTarget->m_position - atom->m_position;
 
     //Compute gradient contribution all the way to the root
-    KinVertex* v = atom->getRigidbody()->getVertex();
-    while(v!=protein->m_spanningTree->m_root){
-      KinEdge* parentEdge = v->m_parent->findEdge(v);
+    for(KinVertex* v = atom->getRigidbody()->getVertex(); v->m_parentEdge!=nullptr; v = v->m_parent){
+      KinEdge* parentEdge = v->m_parentEdge;
       int dof_id = parentEdge->getDOF()->getIndex();
       Math3D::Vector3 deriv = parentEdge->getDOF()->getDerivative(atom->m_position);
 
       gradient[dof_id] += deriv.dot(diff);
       assert( !std::isnan(gradient[dof_id]) );
       counts[dof_id]++;
-
-      v = v->m_parent;
     }
 //    count++;
   }
@@ -98,8 +98,8 @@ void VDWDirection::computeAtomJacobian (Atom* atom, gsl_matrix* jacobian) {
   Molecule * protein = atom->getResidue()->getChain()->getMolecule();
   //KinVertex *vertex = protein->getRigidbodyGraphVertex(atom);
   KinVertex *vertex = atom->getRigidbody()->getVertex();
-  while (vertex->m_parent!=nullptr) {
-    KinEdge* edge = vertex->m_parent->findEdge(vertex);
+  for (KinVertex* v = vertex; v->m_parentEdge != nullptr; v = v->m_parent) {
+    KinEdge* edge = v->m_parentEdge;
     int dof_id = edge->getDOF()->getIndex();
 //    Bond * bond_ptr = edge->getBond();
 //    Coordinate bp1 = bond_ptr->Atom1->m_position;
@@ -109,7 +109,6 @@ void VDWDirection::computeAtomJacobian (Atom* atom, gsl_matrix* jacobian) {
     gsl_matrix_set(jacobian,0,dof_id,jacobian_entry.x);
     gsl_matrix_set(jacobian,1,dof_id,jacobian_entry.y);
     gsl_matrix_set(jacobian,2,dof_id,jacobian_entry.z);
-    vertex = vertex->m_parent;
   }
 
   //Todo: This should be optimizable using the sorted vertices and the Abé implementation of the MSD gradient
@@ -9,12 +9,17 @@
 //#include "QRGSL.h"
 //#include "QRMKL.h"
 #include "NullspaceSVD.h"
-//#include "NullspaceQR.h"
+#include "NullspaceSparse.h"
+#include "NullspaceQR.h"
 #include <iostream>
 #include <stdio.h>
+#include <cassert>
+#include <algorithm>
 
 using namespace std;
 
+std::string Nullspace::m_method = "svd";
+
 Nullspace::Nullspace(gsl_matrix* M) :
     m_matrix(M),
     m(M->size1),
@@ -25,10 +30,11 @@ Nullspace::Nullspace(gsl_matrix* M) :
     numRigidDBonds( 0 ),
     numRigidHydrophobicBonds( 0 ),
     m_nullspaceBasis(nullptr),
-    m_rigidCovBonds(gsl_vector_alloc(n)),///for allocation, use maximum size of all n covalent edges
-    m_rigidHBonds(gsl_vector_alloc(m)),///for allocation, use maximum size of all m constraints
-    m_rigidDBonds(gsl_vector_alloc(m)),
-    m_rigidHydrophobicBonds(gsl_vector_alloc(m))
+    m_compressedCols(0),
+    m_rigidCovBonds(gsl_vector_calloc(n)),///for allocation, use maximum size of all n covalent edges
+    m_rigidHBonds(gsl_vector_calloc(m)),///for allocation, use maximum size of all m constraints
+    m_rigidDBonds(gsl_vector_calloc(m)),
+    m_rigidHydrophobicBonds(gsl_vector_calloc(m))
 {
 }
 
@@ -42,6 +48,69 @@ Nullspace::~Nullspace ()
   gsl_vector_free(m_rigidHydrophobicBonds);
 }
 
+void Nullspace::compress()
+{
+  if(m_nullspaceBasis==nullptr) return;
+
+  const size_t rows = m_nullspaceBasis->size1;
+  m_compressedCols = m_nullspaceBasis->size2;
+  m_compressedBasis.resize(rows*m_compressedCols);
+  for(size_t i=0; i<rows; i++)
+    for(size_t j=0; j<m_compressedCols; j++)
+      m_compressedBasis[i*m_compressedCols+j] = (float)gsl_matrix_get(m_nullspaceBasis, i, j);
+
+  gsl_matrix_free(m_nullspaceBasis);
+  m_nullspaceBasis = nullptr;
+}
+
+void Nullspace::decompress()
+{
+  if(m_nullspaceBasis==nullptr && !m_compressedBasis.empty()) {
+    const size_t rows = m_compressedBasis.size() / m_compressedCols;
+    m_nullspaceBasis = gsl_matrix_alloc(rows, m_compressedCols);
+    for (size_t i = 0; i < rows; i++)
+      for (size_t j = 0; j < m_compressedCols; j++)
+        gsl_matrix_set(m_nullspaceBasis, i, j, m_compressedBasis[i * m_compressedCols + j]);
+  }
+  m_compressedBasis.clear();
+  m_compressedBasis.shrink_to_fit();
+}
+
+size_t Nullspace::getMemoryUsage() const
+{
+  size_t bytes = m_compressedBasis.capacity()*sizeof(float);
+  if(m_nullspaceBasis)
+    bytes += m_nullspaceBasis->size1*m_nullspaceBasis->size2*sizeof(double);
+  bytes += (m_rigidCovBonds->size + m_rigidHBonds->size + m_rigidDBonds->size + m_rigidHydrophobicBonds->size)*sizeof(double);
+  return bytes;
+}
+
+Nullspace* Nullspace::create(gsl_matrix* M, SVD* svd, const SparseMatrix* sparse)
+{
+  if(m_method=="sparse")
+    return new NullspaceSparse(M, sparse);
+  if(m_method=="qr")
+    return new NullspaceQR(M);
+
+  if(svd==nullptr)
+    return new NullspaceSVD(SVD::createSVD(M, true), true);
+  return new NullspaceSVD(svd);
+}
+
+void Nullspace::setMethod(const std::string& method)
+{
+  if(method!="svd" && method!="sparse" && method!="qr"){
+    cerr<<"Nullspace::setMethod - unknown nullspace method: "<<method<<endl;
+    exit(-1);
+  }
+  m_method = method;
+}
+
+const std::string& Nullspace::getMethod()
+{
+  return m_method;
+}
+
 
 /*void Nullspace::performHydroRigidityAnalysis(gsl_matrix *HydrophobicBondJacobian)
 {
@@ -284,6 +353,43 @@ void Nullspace::projectOnNullSpace(gsl_vector *to_project, gsl_vector *after_pro
 //	gsl_blas_dgemv (CblasNoTrans, 1.0, nullspace->P, to_project, 0.0, after_project);
 }
 
+void Nullspace::projectOnNullSpace(const gsl_vector *to_project, gsl_vector *after_project, ProjectionWorkspace& workspace) const {
+  if(m_nullspaceSize==0){
+    gsl_vector_set_zero(after_project);
+    return;
+  }
+
+  gsl_vector_view firstResult = workspace.vector(ProjectionWorkspace::COEFFICIENTS, m_nullspaceSize);
+  gsl_blas_dgemv (CblasTrans, 1.0, m_nullspaceBasis, to_project, 0.0, &firstResult.vector);
+  gsl_blas_dgemv (CblasNoTrans, 1.0, m_nullspaceBasis, &firstResult.vector, 0.0, after_project);
+}
+
+void Nullspace::projectOnNullSpace(const gsl_matrix *to_project, gsl_matrix *after_project, ProjectionWorkspace& workspace) const {
+  if(m_nullspaceSize==0){
+    gsl_matrix_set_zero(after_project);
+    return;
+  }
+
+  //Same as the vector version with [n x b] gradients: N * (N^T * G)
+  gsl_matrix_view firstResult = workspace.matrix(ProjectionWorkspace::COEFFICIENTS, m_nullspaceSize, to_project->size2);
+  gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1.0, m_nullspaceBasis, to_project, 0.0, &firstResult.matrix);
+  gsl_blas_dgemm (CblasNoTrans, CblasNoTrans, 1.0, m_nullspaceBasis, &firstResult.matrix, 0.0, after_project);
+}
+
+void Nullspace::copyBasis(const gsl_matrix* basis, int nullspaceSize)
+{
+  assert(basis->size1==(size_t)n);
+  if(m_nullspaceBasis)
+    gsl_matrix_free(m_nullspaceBasis);
+  m_compressedBasis.clear();
+
+  m_nullspaceSize = nullspaceSize;
+  m_nullspaceBasis = gsl_matrix_calloc(n, std::max(nullspaceSize, 1));
+  if(nullspaceSize>0) {
+    gsl_matrix_const_view columns = gsl_matrix_const_submatrix(basis, 0, 0, n, nullspaceSize);
+    gsl_matrix_memcpy(m_nullspaceBasis, &columns.matrix);
+  }
+}
 
 gsl_matrix *Nullspace::getBasis() const {
   return m_nullspaceBasis;
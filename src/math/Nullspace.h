@@ -8,9 +8,11 @@
 #include <vector>
 
 #include "math/SVD.h"
+#include "math/ProjectionWorkspace.h"
 //#include "math/QR.h"
 
 class Molecule; //Forward declaration
+class SparseMatrix;
 
 /**
  * Computes, stores, and maintains the nullspace of a gsl_matrix.
@@ -32,15 +34,48 @@ class Nullspace {
 
   virtual ~Nullspace();
 
+  /**
+   * Create a nullspace of `M` using the backend selected with `setMethod`. The "svd" backend uses
+   * `svd` (which must decompose `M` and is not owned by the nullspace) or creates its own if `svd`
+   * is null. The "sparse" backend uses the non-zeros in `sparse` if given (see NullspaceSparse).
+   * Other backends ignore `svd` and `sparse`.
+   */
+  static Nullspace* create(gsl_matrix* M, SVD* svd = nullptr, const SparseMatrix* sparse = nullptr);
+
+  /** Select the backend used by `create`: "svd" (default), "sparse" or "qr". */
+  static void setMethod(const std::string& method);
+
+  /** Return the backend used by `create` */
+  static const std::string& getMethod();
+
   /** Projects a vector on the nullspace */
   void projectOnNullSpace(gsl_vector *to_project, gsl_vector *after_project) const;
 
+  /** Projects a vector on the nullspace using buffers from `workspace` instead of allocating */
+  void projectOnNullSpace(const gsl_vector *to_project, gsl_vector *after_project, ProjectionWorkspace& workspace) const;
+
+  /** Projects each column of `to_project` on the nullspace with two matrix-matrix products */
+  void projectOnNullSpace(const gsl_matrix *to_project, gsl_matrix *after_project, ProjectionWorkspace& workspace) const;
+
   /** Analyzes which dihedrals and hydrogen bonds are rigidified by constraints */
   void performRigidityAnalysis(gsl_matrix *HBondJacobian,gsl_matrix *DBondJacobian,gsl_matrix *HydrophobicBondJacobian);
 
   /** Update the Nullspace (and underlying SVD/QR) to reflect an updated state of the matrix */
   virtual void updateFromMatrix() = 0;
 
+  /**
+   * Update the Nullspace to reflect an updated state of the matrix, using `prior` (typically the
+   * nullspace of the parent configuration) as a starting point. Backends that can not make use of
+   * a prior perform a full update.
+   */
+  virtual void updateFromPrior(const Nullspace* prior) { updateFromMatrix(); }
+
+  /**
+   * Use a copy of the first `nullspaceSize` columns of `basis` instead of decomposing the matrix, e.g. the
+   * basis of an identical matrix computed on another thread. Rigidity information is not copied.
+   */
+  void copyBasis(const gsl_matrix* basis, int nullspaceSize);
+
   /** Return the nullspace size */
   int getNullspaceSize() const { return m_nullspaceSize; }
 
@@ -63,6 +98,18 @@ class Nullspace {
   /** Return the basis of the nullspace as columns of a matrix */
   gsl_matrix *getBasis() const;
 
+  /** Store the basis in single precision and free the double precision basis. getBasis returns null until decompress is called. */
+  void compress();
+
+  /** Restore a double precision basis from the single precision copy (lossy) */
+  void decompress();
+
+  /** Return true if the basis is only available in single precision */
+  bool isCompressed() const { return m_nullspaceBasis==nullptr && !m_compressedBasis.empty(); }
+
+  /** Approximate number of bytes held by the basis, rigidity vectors and owned decompositions */
+  virtual size_t getMemoryUsage() const;
+
   /**
    * Returns true iff the angle specified by the argument is rigidified.
    * This result is only accurate if UpdateFromMatrix and RigidityAnalysis have both
@@ -82,6 +129,8 @@ class Nullspace {
   gsl_matrix* m_matrix;        ///< Original matrix. Only set if using QR decomp (as it needs to be transposed)
 
   gsl_matrix* m_nullspaceBasis;///< Basis of the nullspace
+  std::vector<float> m_compressedBasis; ///< Row-major single precision basis while compressed
+  size_t m_compressedCols;     ///< Columns of m_compressedBasis
 
  private:
   gsl_vector* m_rigidCovBonds; ///< Binary vector indicating which m_dofs are rigid
@@ -97,6 +146,8 @@ class Nullspace {
 //  static constexpr double SINGVAL_TOL = 1.0e-12; //0.000000000001; // only generic 10^-12
   static constexpr double RIGID_TOL =   1.0e-9; //0.0000000001; //most molecules work between 1e-4 and 1e-10, exceptions only between 1e-8 and 1e-9
 
+  static std::string m_method;  ///< Backend used by `create`
+
 //  friend class Configuration;
 };
 
@@ -1,30 +1,56 @@
 
 #include "NullspaceQR.h"
+#include "NullspaceSVD.h"
 #include "Logger.h"
 
-double RDIAVAL_TOL = 1.0e-6;
-
 using namespace std;
 
-NullspaceQR::NullspaceQR(TransposeQR * qr) :
+NullspaceQR::NullspaceQR(TransposeQR * qr, bool ownsQR) :
     Nullspace(qr->getMatrix()),
-    m_qr(qr)
+    m_qr(qr),
+    m_ownsQR(ownsQR)
+{
+}
+
+NullspaceQR::NullspaceQR(gsl_matrix* M) :
+    Nullspace(M),
+    m_qr(nullptr),
+    m_ownsQR(false)
 {
 }
 
 NullspaceQR::~NullspaceQR()
 {
+  if(m_ownsQR)
+    delete m_qr;
+}
+
+size_t NullspaceQR::getMemoryUsage() const
+{
+  size_t bytes = Nullspace::getMemoryUsage();
+  if(m_ownsQR){
+    const gsl_matrix* Q = m_qr->getQ();
+    const gsl_matrix* R = m_qr->getR();
+    bytes += (Q->size1*Q->size2 + 2*R->size1*R->size2)*sizeof(double); //R and the transposed matrix are both n x m
+  }
+  return bytes;
 }
 
 void NullspaceQR::updateFromMatrix()
 {
-  m_qr->updateFromMatrix();
+  //Q, R and the transposed matrix are n x n and n x m, so they are not kept unless the QR was given
+  TransposeQR* qr = m_qr!=nullptr ? m_qr : new TransposeQR(m_matrix);
+  qr->updateFromMatrix();
 
-  //Compute rank and nullspace size
+  //Compute rank and nullspace size. Pivoting orders |R_ii| decreasingly so R_00 plays the role
+  //of the largest singular value.
   int rank = 0;
+  double maxDiagonal = std::min(m,n)>0 ? fabs(gsl_matrix_get(qr->getR(), 0, 0)) : 0.0;
+  double tol = NullspaceSVD::getSingularValueTolerance();
   for(int i=0;i<std::min(m,n);i++) {
-    double val = gsl_matrix_get(m_qr->getR(), i, i);
-    if (fabs(val) > RDIAVAL_TOL) rank++;
+    double val = fabs(gsl_matrix_get(qr->getR(), i, i));
+    if (maxDiagonal==0.0 || val/maxDiagonal < tol) break;
+    rank++;
   }
   m_nullspaceSize = n-rank;
 
@@ -34,7 +60,7 @@ void NullspaceQR::updateFromMatrix()
 
   //Extract nullspace from last columns of Q-matrix
   if (m_nullspaceSize > 0) {
-    gsl_matrix_view nullspaceBasis_view = gsl_matrix_submatrix(m_qr->getQ(),
+    gsl_matrix_view nullspaceBasis_view = gsl_matrix_submatrix(qr->getQ(),
                                                                0,                                     //Row
                                                                n - m_nullspaceSize, //Col
                                                                n,                   //Height
@@ -46,5 +72,8 @@ void NullspaceQR::updateFromMatrix()
   }else {
     m_nullspaceBasis = gsl_matrix_calloc(m_matrix->size2, 1);//1-dim vector with zeros as entries
   }
+
+  if(qr!=m_qr)
+    delete qr;
 }
 
@@ -11,23 +11,36 @@
 #include "TransposeQR.h"
 
 /**
- * An implementation of Nullspace backed by a QR decomposition
+ * An implementation of Nullspace backed by a column-pivoted QR decomposition of the transpose
+ * of the matrix. The trailing columns of Q span the nullspace. The rank is the number of
+ * diagonal entries of R with |R_ii|/|R_00| at or above the NullspaceSVD singular value tolerance,
+ * so the --svdCutoff option applies to both backends.
  */
 class NullspaceQR: public Nullspace {
  public:
-  /** Will construct a nullspace using a QR (transpose) decomposition */
-  NullspaceQR(TransposeQR* qr);
+  /** Will construct a nullspace using a QR (transpose) decomposition. If `ownsQR` the QR is deleted with this. */
+  NullspaceQR(TransposeQR* qr, bool ownsQR = false);
+
+  /**
+   * Will construct a nullspace of `M` using a QR (transpose) decomposition that only exists during
+   * updateFromMatrix, so only the basis is kept between updates.
+   */
+  NullspaceQR(gsl_matrix* M);
 
   ~NullspaceQR();
 
-  /** Update the Nullspace (and underlying SVD) to reflect an updated state of the matrix */
+  /** Update the Nullspace (and underlying QR) to reflect an updated state of the matrix */
   void updateFromMatrix() override;
 
+  /** Also counts Q, R and the transposed matrix if the QR is owned by this nullspace */
+  size_t getMemoryUsage() const override;
+
 private:
-  TransposeQR* m_qr;                  ///< SVD underlying this nullspace
+  TransposeQR* m_qr;                  ///< QR underlying this nullspace. Null if it is created per update
+  bool m_ownsQR;                      ///< Whether m_qr is deleted on destruction
 
   friend class Configuration;
 };
 
 
-#endif //KGS_nullptrSPACE_H
+#endif //KGS_NULLSPACEQR_H
@@ -1,6 +1,9 @@
 
 #include <gsl/gsl_matrix_double.h>
 #include <gsl/gsl_blas.h>
+#include <gsl/gsl_linalg.h>
+#include <gsl/gsl_errno.h>
+#include <mutex>
 
 #include "NullspaceSVD.h"
 #include "Logger.h"
@@ -11,18 +14,44 @@
 
 //double SINGVAL_TOL = 1.0e-12; //0.000000000001; // only generic 10^-12
 double NullspaceSVD::SINGVAL_TOL = 1.0e-12; //0.000000000001; // only generic 10^-12
+bool NullspaceSVD::INCREMENTAL = false;
+std::atomic<long> NullspaceSVD::numIncrementalUpdates(0);
+std::atomic<long> NullspaceSVD::numIncrementalFallbacks(0);
+
+static std::mutex errorHandlerMutex;
 
 using namespace std;
 
-NullspaceSVD::NullspaceSVD(SVD * svd) :
+NullspaceSVD::NullspaceSVD(SVD * svd, bool ownsSVD) :
   Nullspace(svd->matrix),
-  m_svd(svd)
+  m_svd(svd),
+  m_ownsSVD(ownsSVD),
+  m_svdCurrent(false)
+{
+}
+
+NullspaceSVD::~NullspaceSVD()
 {
+  if(m_ownsSVD)
+    delete m_svd;
+}
+
+size_t NullspaceSVD::getMemoryUsage() const
+{
+  size_t bytes = Nullspace::getMemoryUsage();
+  if(m_ownsSVD){
+    if(m_svd->U)
+      bytes += m_svd->U->size1*m_svd->U->size2*sizeof(double);
+    bytes += m_svd->V->size1*m_svd->V->size2*sizeof(double);
+    bytes += m_svd->S->size*sizeof(double);
+  }
+  return bytes;
 }
 
 void NullspaceSVD::updateFromMatrix()
 {
   m_svd->UpdateFromMatrix();
+  m_svdCurrent = true;
 
   //Compute nullspacesize
   double maxSingularValue = gsl_vector_get(m_svd->S, 0);
@@ -58,6 +87,124 @@ void NullspaceSVD::updateFromMatrix()
   }
 }
 
+void NullspaceSVD::updateFromPrior(const Nullspace* prior)
+{
+  if(!INCREMENTAL || prior==nullptr || prior==this){
+    updateFromMatrix();
+    return;
+  }
+
+  //The prior must describe a nullspace of a matrix with the same columns. If it is smaller than n-m
+  //the rank of the matrix must have dropped, which a correction of the prior can not capture.
+  gsl_matrix* priorBasis = prior->getBasis();
+  int k = prior->getNullspaceSize();
+  if(priorBasis==nullptr || priorBasis->size1!=n || k<=0 || k<n-m){
+    updateFromMatrix();
+    return;
+  }
+
+  numIncrementalUpdates++;
+  gsl_matrix* basis = gsl_matrix_alloc(n, k);
+  gsl_matrix_const_view priorBasis_view = gsl_matrix_const_submatrix(priorBasis, 0, 0, n, k);
+  gsl_matrix_memcpy(basis, &priorBasis_view.matrix);
+
+  if(!correctBasis(basis)){
+    numIncrementalFallbacks++;
+    log("debug")<<"NullspaceSVD::updateFromPrior - rank or residual check failed, falling back to full SVD"<<endl;
+    gsl_matrix_free(basis);
+    updateFromMatrix();
+    return;
+  }
+
+  if (m_nullspaceBasis)
+    gsl_matrix_free(m_nullspaceBasis);
+  m_nullspaceBasis = basis;
+  m_nullspaceSize = k;
+  m_svdCurrent = false;
+}
+
+/** Orthonormalize the columns of N with modified Gram-Schmidt. Returns false if a column mostly vanishes. */
+static bool orthonormalizeColumns(gsl_matrix* N)
+{
+  for(size_t j=0; j<N->size2; j++){
+    gsl_vector_view v = gsl_matrix_column(N, j);
+    for(size_t i=0; i<j; i++){
+      gsl_vector_view q = gsl_matrix_column(N, i);
+      double dot;
+      gsl_blas_ddot(&q.vector, &v.vector, &dot);
+      gsl_blas_daxpy(-dot, &q.vector, &v.vector);
+    }
+    double norm = gsl_blas_dnrm2(&v.vector);
+    if(norm<0.5)
+      return false;
+    gsl_vector_scale(&v.vector, 1.0/norm);
+  }
+  return true;
+}
+
+bool NullspaceSVD::correctBasis(gsl_matrix* basis)
+{
+  double normJ = frobenius_norm(m_matrix);
+  if(normJ==0.0)
+    return false;
+
+  //Damped normal matrix J*J^T + lambda*I. Damping keeps it positive definite for rank deficient J
+  //and suppresses corrections along directions below the singular value cut-off.
+  gsl_matrix* normal = gsl_matrix_alloc(m, m);
+  gsl_blas_dsyrk(CblasLower, CblasNoTrans, 1.0, m_matrix, 0.0, normal);
+  double lambda = SINGVAL_TOL*normJ*normJ;
+  for(int i=0; i<m; i++)
+    gsl_matrix_set(normal, i, i, gsl_matrix_get(normal, i, i)+lambda);
+
+  //The GSL error handler is process wide, so concurrent updates must not interleave the swap
+  int status;
+  {
+    std::lock_guard<std::mutex> lock(errorHandlerMutex);
+    gsl_error_handler_t* handler = gsl_set_error_handler_off();
+    status = gsl_linalg_cholesky_decomp(normal);
+    gsl_set_error_handler(handler);
+  }
+
+  //Without damping a row that is a combination of the previous rows has a zero Cholesky pivot L_ii^2.
+  //With damping such pivots stay close to lambda, so counting them gives the rank of J for free. The
+  //correction keeps the number of basis columns, which must be the nullspace size of J.
+  int rankDeficiency = 0;
+  if(status==GSL_SUCCESS) {
+    for (int i = 0; i < m; i++) {
+      double Lii = gsl_matrix_get(normal, i, i);
+      if (Lii*Lii < RANK_PIVOT_FACTOR*lambda)
+        rankDeficiency++;
+    }
+  }
+
+  bool accepted = false;
+  if(status==GSL_SUCCESS && (int)basis->size2==n-m+rankDeficiency) {
+    gsl_matrix* residual = gsl_matrix_alloc(m, basis->size2);
+    for (int step = 0; step <= INCREMENTAL_MAX_STEPS; step++) {
+      gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, m_matrix, basis, 0.0, residual);
+      if (frobenius_norm(residual) / normJ < INCREMENTAL_RESIDUAL_TOL) {
+        accepted = true;
+        break;
+      }
+      if (step == INCREMENTAL_MAX_STEPS)
+        break;
+
+      //basis -= J^T * (J*J^T + lambda*I)^-1 * J*basis
+      for (size_t j = 0; j < residual->size2; j++) {
+        gsl_vector_view col = gsl_matrix_column(residual, j);
+        gsl_linalg_cholesky_svx(normal, &col.vector);
+      }
+      gsl_blas_dgemm(CblasTrans, CblasNoTrans, -1.0, m_matrix, residual, 1.0, basis);
+      if (!orthonormalizeColumns(basis))
+        break;
+    }
+    gsl_matrix_free(residual);
+  }
+
+  gsl_matrix_free(normal);
+  return accepted;
+}
+
 SVD *NullspaceSVD::getSVD() const {
   return m_svd;
 }
@@ -66,3 +213,23 @@ void NullspaceSVD::setSingularValueTolerance(double val)
 {
   NullspaceSVD::SINGVAL_TOL = val;
 }
+
+double NullspaceSVD::getSingularValueTolerance()
+{
+  return NullspaceSVD::SINGVAL_TOL;
+}
+
+void NullspaceSVD::setIncrementalUpdates(bool enable)
+{
+  NullspaceSVD::INCREMENTAL = enable;
+}
+
+long NullspaceSVD::getNumIncrementalUpdates()
+{
+  return numIncrementalUpdates;
+}
+
+long NullspaceSVD::getNumIncrementalFallbacks()
+{
+  return numIncrementalFallbacks;
+}
@@ -5,6 +5,7 @@
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_vector.h>
 #include <string>
+#include <atomic>
 
 #include "math/SVD.h"
 #include "math/Nullspace.h"
@@ -14,19 +15,60 @@
  */
 class NullspaceSVD: public Nullspace {
  public:
-  /** Will construct a nullspace of `matrix` using the SVD decomposition */
-  NullspaceSVD(SVD* svd);
+  /** Will construct a nullspace of `matrix` using the SVD decomposition. If `ownsSVD` the SVD is deleted with this. */
+  NullspaceSVD(SVD* svd, bool ownsSVD = false);
+
+  ~NullspaceSVD();
 
   /** Update the Nullspace (and underlying SVD) to reflect an updated state of the matrix */
   void updateFromMatrix() override;
 
+  /**
+   * If incremental updates are enabled the basis of `prior` is corrected towards the nullspace of the
+   * current matrix with a few damped Gauss-Newton steps instead of computing the SVD. A correction can
+   * not add or remove basis directions, so the prior is only used if its size matches the rank of the
+   * matrix, which is read off the pivots of the Cholesky decomposition the correction needs anyway.
+   * If the rank differs or the corrected basis does not pass the residual check a full update is performed.
+   * The SVD returned by getSVD is only current after a full update (see isSVDCurrent).
+   */
+  void updateFromPrior(const Nullspace* prior) override;
+
   /** Return the SVD of the nullspace as columns of a matrix */
   SVD *getSVD() const;
 
+  /** False if the nullspace was last updated from a prior, in which case getSVD holds an older decomposition */
+  bool isSVDCurrent() const { return m_svdCurrent; }
+
+  /** Also counts the SVD if it is owned by this nullspace */
+  size_t getMemoryUsage() const override;
+
   static void setSingularValueTolerance(double val);
 
+  static double getSingularValueTolerance();
+
+  /** Enable or disable warm-started updates in updateFromPrior (disabled by default) */
+  static void setIncrementalUpdates(bool enable);
+
+  /** Number of updateFromPrior calls that attempted a warm start */
+  static long getNumIncrementalUpdates();
+
+  /** Number of warm starts that failed the residual check and fell back to a full SVD */
+  static long getNumIncrementalFallbacks();
+
 private:
   SVD* m_svd;                  ///< SVD underlying this nullspace
+  bool m_ownsSVD;              ///< Whether m_svd is deleted on destruction
+  bool m_svdCurrent;           ///< Whether m_svd decomposes the matrix the basis was computed for
+
+  /** Try to correct `basis` (n x k, overwritten) into an orthonormal nullspace basis of m_matrix. */
+  bool correctBasis(gsl_matrix* basis);
+
+  static bool INCREMENTAL;
+  static std::atomic<long> numIncrementalUpdates;   ///< Atomic as nullspaces may be updated from several threads
+  static std::atomic<long> numIncrementalFallbacks;
+  static constexpr int INCREMENTAL_MAX_STEPS = 3;
+  static constexpr double INCREMENTAL_RESIDUAL_TOL = 1.0e-10; ///< Max |J*N|_F / |J|_F of an accepted basis
+  static constexpr double RANK_PIVOT_FACTOR = 100.0;          ///< Cholesky pivots below this times the damping count as rank deficient
 
   /// These values have to be chosen according to the numerical analysis
   static double SINGVAL_TOL;
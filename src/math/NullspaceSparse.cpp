@@ -0,0 +1,145 @@
+#include <algorithm>
+
+#include "NullspaceSparse.h"
+#include "NullspaceSVD.h"
+#include "DisjointSets.h"
+#include "Logger.h"
+
+using namespace std;
+
+NullspaceSparse::NullspaceSparse(gsl_matrix* M, const SparseMatrix* sparse) :
+    Nullspace(M),
+    m_sparse(sparse),
+    m_numBlocks(0)
+{
+}
+
+void NullspaceSparse::findBlocks(const SparseMatrix& sparse, vector<Block>& blocks, vector<int>& freeCols) const
+{
+  //Columns sharing a row end up in the same set
+  DisjointSets ds(n);
+  vector<bool> activeCol(n, false);
+  for(int r=0; r<m; r++){
+    int first = sparse.m_rowPtr[r];
+    for(int k=first; k<sparse.m_rowPtr[r+1]; k++){
+      activeCol[sparse.m_colIdx[k]] = true;
+      ds.Union(sparse.m_colIdx[first], sparse.m_colIdx[k]);
+    }
+  }
+
+  //Number blocks by their lowest column
+  vector<int> setToBlock(n, -1);
+  blocks.clear();
+  freeCols.clear();
+  for(int c=0; c<n; c++){
+    if(!activeCol[c]){
+      freeCols.push_back(c);
+      continue;
+    }
+    int set = ds.FindSet(c);
+    if(setToBlock[set]<0){
+      setToBlock[set] = blocks.size();
+      blocks.push_back(Block());
+    }
+    blocks[setToBlock[set]].cols.push_back(c);
+  }
+  for(int r=0; r<m; r++){
+    if(sparse.m_rowPtr[r]==sparse.m_rowPtr[r+1]) continue;
+    int set = ds.FindSet(sparse.m_colIdx[sparse.m_rowPtr[r]]);
+    blocks[setToBlock[set]].rows.push_back(r);
+  }
+}
+
+void NullspaceSparse::updateFromMatrix()
+{
+  SparseMatrix scanned(m, n);
+  const SparseMatrix* sparse = m_sparse;
+  if(sparse==nullptr || sparse->rows()!=m || sparse->cols()!=n){
+    scanned.updateFromDense(m_matrix);
+    sparse = &scanned;
+  }
+  m_sparse = nullptr; //The caller may reuse it once this update is done
+
+  vector<Block> blocks;
+  vector<int> freeCols;
+  findBlocks(*sparse, blocks, freeCols);
+  m_numBlocks = blocks.size();
+
+  //Dense SVD of each block. Only S and V are needed, and they are kept until the global cut-off is known
+  vector<int> colInBlock(n, -1);
+  vector<gsl_vector*> blockS(blocks.size());
+  vector<gsl_matrix*> blockV(blocks.size());
+  double maxSingularValue = 0.0;
+  for(size_t b=0; b<blocks.size(); b++){
+    const Block& block = blocks[b];
+    const int mb = block.rows.size();
+    const int nb = block.cols.size();
+    gsl_matrix* matrix = gsl_matrix_calloc(mb, nb);
+    for(int j=0; j<nb; j++)
+      colInBlock[block.cols[j]] = j;
+    for(int i=0; i<mb; i++){
+      int r = block.rows[i];
+      for(int k=sparse->m_rowPtr[r]; k<sparse->m_rowPtr[r+1]; k++)
+        gsl_matrix_set(matrix, i, colInBlock[sparse->m_colIdx[k]], sparse->m_values[k]);
+    }
+
+    SVD* svd = SVD::createSVD(matrix, true);
+    svd->UpdateFromMatrix();
+    blockS[b] = gsl_vector_alloc(svd->S->size);
+    gsl_vector_memcpy(blockS[b], svd->S);
+    blockV[b] = gsl_matrix_alloc(svd->V->size1, svd->V->size2);
+    gsl_matrix_memcpy(blockV[b], svd->V);
+    delete svd;
+    gsl_matrix_free(matrix);
+
+    if(blockS[b]->size>0)
+      maxSingularValue = std::max(maxSingularValue, gsl_vector_get(blockS[b], 0));
+  }
+
+  //Same rule as NullspaceSVD::updateFromMatrix, with the cut-off relative to the whole matrix
+  const double tol = NullspaceSVD::getSingularValueTolerance();
+  vector<int> blockNullspaceSize(blocks.size());
+  m_nullspaceSize = freeCols.size();
+  for(size_t b=0; b<blocks.size(); b++){
+    const int mb = blocks[b].rows.size();
+    const int nb = blocks[b].cols.size();
+    int size = std::max(nb-mb, 0);
+    for(int i=0; i<blockS[b]->size; i++){
+      if(gsl_vector_get(blockS[b], i)/maxSingularValue < tol){
+        size = nb-i;
+        break;
+      }
+    }
+    blockNullspaceSize[b] = size;
+    m_nullspaceSize += size;
+  }
+
+  log("debug")<<"NullspaceSparse::updateFromMatrix - "<<sparse->nonZeros()<<" non-zeros in "<<m<<"x"<<n;
+  log("debug")<<", "<<blocks.size()<<" blocks, "<<freeCols.size()<<" free columns, nullspace size "<<m_nullspaceSize<<endl;
+
+  if (m_nullspaceBasis)
+    gsl_matrix_free(m_nullspaceBasis);
+  m_nullspaceBasis = gsl_matrix_calloc(n, std::max(m_nullspaceSize, 1));
+
+  //Scatter the trailing columns of each block V into its own range of basis columns
+  int col = 0;
+  for(size_t b=0; b<blocks.size(); b++){
+    const int nb = blocks[b].cols.size();
+    const int size = blockNullspaceSize[b];
+    for (int a = 0; a < nb; a++)
+      for (int j = 0; j < size; j++)
+        gsl_matrix_set(m_nullspaceBasis, blocks[b].cols[a], col+j, gsl_matrix_get(blockV[b], a, nb-size+j));
+    col += size;
+    gsl_vector_free(blockS[b]);
+    gsl_matrix_free(blockV[b]);
+  }
+
+  //Unconstrained columns are free
+  for(int c: freeCols)
+    gsl_matrix_set(m_nullspaceBasis, c, col++, 1.0);
+}
+
+int NullspaceSparse::getNumBlocks() const
+{
+  return m_numBlocks;
+}
@@ -0,0 +1,51 @@
+#ifndef KGS_NULLSPACESPARSE_H
+#define KGS_NULLSPACESPARSE_H
+
+#include <vector>
+#include <gsl/gsl_matrix.h>
+
+#include "math/Nullspace.h"
+#include "math/SparseMatrix.h"
+
+/**
+ * An implementation of Nullspace that exploits the sparsity of constraint Jacobians.
+ * Columns that no constraint touches contribute unit vectors to the basis directly. The remaining
+ * rows and columns are split into the connected components of the row/column incidence graph
+ * (e.g. h-bond clusters in separate domains), which makes the matrix block-diagonal after permutation.
+ * An SVD is computed per block and the block nullspaces are placed in disjoint column ranges of the
+ * basis. The singular values of the matrix are the union of those of its blocks, so rank is decided
+ * with the same cut-off as NullspaceSVD: relative to the largest singular value over all blocks.
+ *
+ * The block matrices and their SVDs are freed once the basis is assembled, so a NullspaceSparse
+ * holds no more than the basis, like the other backends.
+ */
+class NullspaceSparse: public Nullspace {
+ public:
+  /**
+   * If `sparse` is given it must hold the non-zeros of `M` (e.g. assembled along with the Jacobian)
+   * and is used instead of scanning `M`. It is not owned and is only read by the next updateFromMatrix.
+   */
+  NullspaceSparse(gsl_matrix* M, const SparseMatrix* sparse = nullptr);
+
+  /** Update the Nullspace to reflect an updated state of the matrix */
+  void updateFromMatrix() override;
+
+  /** Number of independent blocks found in the last call to updateFromMatrix */
+  int getNumBlocks() const;
+
+ private:
+  /** A connected component of the constraint matrix */
+  struct Block {
+    std::vector<int> rows;        ///< Rows of m_matrix in this block
+    std::vector<int> cols;        ///< Columns of m_matrix in this block
+  };
+
+  /** Group the active rows and columns of `sparse` into blocks. Columns without non-zeros go to `freeCols`. */
+  void findBlocks(const SparseMatrix& sparse, std::vector<Block>& blocks, std::vector<int>& freeCols) const;
+
+  const SparseMatrix* m_sparse;      ///< Non-zeros of m_matrix for the next update, or null to scan m_matrix
+  int m_numBlocks;
+};
+
+
+#endif //KGS_NULLSPACESPARSE_H
@@ -0,0 +1,19 @@
+#include "ProjectionWorkspace.h"
+
+gsl_vector_view ProjectionWorkspace::vector(Slot slot, size_t size)
+{
+  return gsl_vector_view_array(reserve(slot, size), size);
+}
+
+gsl_matrix_view ProjectionWorkspace::matrix(Slot slot, size_t rows, size_t cols)
+{
+  return gsl_matrix_view_array(reserve(slot, rows*cols), rows, cols);
+}
+
+double* ProjectionWorkspace::reserve(Slot slot, size_t size)
+{
+  std::vector<double>& buffer = m_buffers[slot];
+  if(buffer.size()<size)
+    buffer.resize(size);
+  return buffer.data();
+}
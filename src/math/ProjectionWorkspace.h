@@ -0,0 +1,36 @@
+#ifndef KGS_PROJECTIONWORKSPACE_H
+#define KGS_PROJECTIONWORKSPACE_H
+
+#include <vector>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+/**
+ * Scratch buffers for projections onto nullspaces, owned by a move or planner so that projecting
+ * a gradient (once per move or trial step) does not allocate. Each slot holds one buffer that
+ * grows on demand and is kept until the workspace is deleted. A view of a slot is valid until the
+ * next request for the same slot.
+ */
+class ProjectionWorkspace {
+ public:
+  enum Slot {
+    COEFFICIENTS = 0, ///< Used by Nullspace for N^T*g
+    CYCLE_INPUT,      ///< Used by Configuration for cycle-DOF gradients
+    CYCLE_OUTPUT,     ///< Used by Configuration for projected cycle-DOF gradients
+    USER,             ///< Free for the owner of the workspace
+    NUM_SLOTS
+  };
+
+  /** Return a vector of length `size` backed by `slot`. Contents are undefined. */
+  gsl_vector_view vector(Slot slot, size_t size);
+
+  /** Return a `rows` x `cols` matrix backed by `slot`. Contents are undefined. */
+  gsl_matrix_view matrix(Slot slot, size_t rows, size_t cols);
+
+ private:
+  double* reserve(Slot slot, size_t size);
+
+  std::vector<double> m_buffers[NUM_SLOTS];
+};
+
+#endif //KGS_PROJECTIONWORKSPACE_H
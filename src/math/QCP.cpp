@@ -0,0 +1,211 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+#include <cmath>
+
+#include "QCP.h"
+
+#define QCP_EVAL_PREC 1e-11
+#define QCP_EVEC_PREC 1e-6
+
+void qcpCenter(double* coords, int n, double centroid[3])
+{
+  double x = 0.0, y = 0.0, z = 0.0;
+  for(int i=0; i<n; i++){
+    x += coords[3*i];
+    y += coords[3*i+1];
+    z += coords[3*i+2];
+  }
+  centroid[0] = x/n;
+  centroid[1] = y/n;
+  centroid[2] = z/n;
+  for(int i=0; i<n; i++){
+    coords[3*i]   -= centroid[0];
+    coords[3*i+1] -= centroid[1];
+    coords[3*i+2] -= centroid[2];
+  }
+}
+
+/** Write the rotation of unit quaternion (q1,q2,q3,q4) = (w,x,y,z) to `rot` as a row-major matrix */
+static void quaternionToRotation(double q1, double q2, double q3, double q4, double* rot)
+{
+  double a2 = q1*q1, x2 = q2*q2, y2 = q3*q3, z2 = q4*q4;
+  double xy = q2*q3, az = q1*q4, zx = q4*q2, ay = q1*q3, yz = q3*q4, ax = q1*q2;
+
+  rot[0] = a2 + x2 - y2 - z2;
+  rot[1] = 2*(xy - az);
+  rot[2] = 2*(zx + ay);
+  rot[3] = 2*(xy + az);
+  rot[4] = a2 - x2 + y2 - z2;
+  rot[5] = 2*(yz - ax);
+  rot[6] = 2*(zx - ay);
+  rot[7] = 2*(yz + ax);
+  rot[8] = a2 - x2 - y2 + z2;
+}
+
+/**
+ * Optimal superposition from the correlation matrix S = sum moving_i * fixed_i^T (row-major) and the sum of
+ * squared norms of both point sets. See qcpSuperpose.
+ */
+static double superposeFromCorrelation(const double* S, double G1, double G2, int n, double* rotation)
+{
+  double Sxx = S[0], Sxy = S[1], Sxz = S[2];
+  double Syx = S[3], Syy = S[4], Syz = S[5];
+  double Szx = S[6], Szy = S[7], Szz = S[8];
+  double E0 = (G1 + G2)*0.5;
+
+  //Coefficients of the characteristic polynomial x^4 + C2*x^2 + C1*x + C0 of the key matrix
+  double Sxx2 = Sxx*Sxx, Syy2 = Syy*Syy, Szz2 = Szz*Szz;
+  double Sxy2 = Sxy*Sxy, Syz2 = Syz*Syz, Sxz2 = Sxz*Sxz;
+  double Syx2 = Syx*Syx, Szy2 = Szy*Szy, Szx2 = Szx*Szx;
+
+  double SyzSzymSyySzz2 = 2.0*(Syz*Szy - Syy*Szz);
+  double Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2;
+
+  double C2 = -2.0*(Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 + Sxz2 + Szx2 + Syz2 + Szy2);
+  double C1 = 8.0*(Sxx*Syz*Szy + Syy*Szx*Sxz + Szz*Sxy*Syx - Sxx*Syy*Szz - Syz*Szx*Sxy - Szy*Syx*Sxz);
+
+  double SxzpSzx = Sxz + Szx, SyzpSzy = Syz + Szy, SxypSyx = Sxy + Syx;
+  double SyzmSzy = Syz - Szy, SxzmSzx = Sxz - Szx, SxymSyx = Sxy - Syx;
+  double SxxpSyy = Sxx + Syy, SxxmSyy = Sxx - Syy;
+  double Sxy2Sxz2Syx2Szx2 = Sxy2 + Sxz2 - Syx2 - Szx2;
+
+  double C0 = Sxy2Sxz2Syx2Szx2*Sxy2Sxz2Syx2Szx2
+      + (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2)*(Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2)
+      + (-(SxzpSzx)*(SyzmSzy) + (SxymSyx)*(SxxmSyy - Szz))*(-(SxzmSzx)*(SyzpSzy) + (SxymSyx)*(SxxmSyy + Szz))
+      + (-(SxzpSzx)*(SyzpSzy) - (SxypSyx)*(SxxpSyy - Szz))*(-(SxzmSzx)*(SyzmSzy) - (SxypSyx)*(SxxpSyy + Szz))
+      + (+(SxypSyx)*(SyzpSzy) + (SxzpSzx)*(SxxmSyy + Szz))*(-(SxymSyx)*(SyzmSzy) + (SxzpSzx)*(SxxpSyy + Szz))
+      + (+(SxypSyx)*(SyzmSzy) + (SxzmSzx)*(SxxmSyy - Szz))*(-(SxymSyx)*(SyzpSzy) + (SxzmSzx)*(SxxpSyy - Szz));
+
+  //Newton iterations for the largest root, which is bounded above by E0
+  double lambda = E0;
+  for(int i=0; i<50; i++){
+    double old = lambda;
+    double x2 = lambda*lambda;
+    double b = (x2 + C2)*lambda;
+    double a = b + C1;
+    double delta = (a*lambda + C0)/(2.0*x2*lambda + b + a);
+    lambda -= delta;
+    if(std::fabs(lambda - old) < std::fabs(QCP_EVAL_PREC*lambda)) break;
+  }
+
+  double rmsd = std::sqrt(std::fabs(2.0*(E0 - lambda)/n));
+  if(rotation==nullptr) return rmsd;
+
+  //The rotation is the eigenvector of lambda, taken from a column of the adjugate of (key matrix - lambda*I)
+  double a11 = SxxpSyy + Szz - lambda, a12 = SyzmSzy, a13 = -SxzmSzx, a14 = SxymSyx;
+  double a21 = SyzmSzy, a22 = SxxmSyy - Szz - lambda, a23 = SxypSyx, a24 = SxzpSzx;
+  double a31 = a13, a32 = a23, a33 = Syy - Sxx - Szz - lambda, a34 = SyzpSzy;
+  double a41 = a14, a42 = a24, a43 = a34, a44 = Szz - SxxpSyy - lambda;
+  double a3344_4334 = a33*a44 - a43*a34, a3244_4234 = a32*a44 - a42*a34;
+  double a3243_4233 = a32*a43 - a42*a33, a3143_4133 = a31*a43 - a41*a33;
+  double a3144_4134 = a31*a44 - a41*a34, a3142_4132 = a31*a42 - a41*a32;
+
+  double q1 =  a22*a3344_4334 - a23*a3244_4234 + a24*a3243_4233;
+  double q2 = -a21*a3344_4334 + a23*a3144_4134 - a24*a3143_4133;
+  double q3 =  a21*a3244_4234 - a22*a3144_4134 + a24*a3142_4132;
+  double q4 = -a21*a3243_4233 + a22*a3143_4133 - a23*a3142_4132;
+  double qsqr = q1*q1 + q2*q2 + q3*q3 + q4*q4;
+
+  //If the column vanishes (degenerate eigenvalues) try the other ones
+  if(qsqr < QCP_EVEC_PREC){
+    q1 =  a12*a3344_4334 - a13*a3244_4234 + a14*a3243_4233;
+    q2 = -a11*a3344_4334 + a13*a3144_4134 - a14*a3143_4133;
+    q3 =  a11*a3244_4234 - a12*a3144_4134 + a14*a3142_4132;
+    q4 = -a11*a3243_4233 + a12*a3143_4133 - a13*a3142_4132;
+    qsqr = q1*q1 + q2*q2 + q3*q3 + q4*q4;
+  }
+  if(qsqr < QCP_EVEC_PREC){
+    double a1324_1423 = a13*a24 - a14*a23, a1224_1422 = a12*a24 - a14*a22;
+    double a1223_1322 = a12*a23 - a13*a22, a1124_1421 = a11*a24 - a14*a21;
+    double a1123_1321 = a11*a23 - a13*a21, a1122_1221 = a11*a22 - a12*a21;
+
+    q1 =  a42*a1324_1423 - a43*a1224_1422 + a44*a1223_1322;
+    q2 = -a41*a1324_1423 + a43*a1124_1421 - a44*a1123_1321;
+    q3 =  a41*a1224_1422 - a42*a1124_1421 + a44*a1122_1221;
+    q4 = -a41*a1223_1322 + a42*a1123_1321 - a43*a1122_1221;
+    qsqr = q1*q1 + q2*q2 + q3*q3 + q4*q4;
+
+    if(qsqr < QCP_EVEC_PREC){
+      q1 =  a32*a1324_1423 - a33*a1224_1422 + a34*a1223_1322;
+      q2 = -a31*a1324_1423 + a33*a1124_1421 - a34*a1123_1321;
+      q3 =  a31*a1224_1422 - a32*a1124_1421 + a34*a1122_1221;
+      q4 = -a31*a1223_1322 + a32*a1123_1321 - a33*a1122_1221;
+      qsqr = q1*q1 + q2*q2 + q3*q3 + q4*q4;
+    }
+  }
+
+  if(qsqr < QCP_EVEC_PREC){
+    //Every rotation is optimal, e.g. for a single point
+    quaternionToRotation(1.0, 0.0, 0.0, 0.0, rotation);
+    return rmsd;
+  }
+
+  double normq = std::sqrt(qsqr);
+  quaternionToRotation(q1/normq, q2/normq, q3/normq, q4/normq, rotation);
+  return rmsd;
+}
+
+/** Correlation matrix S = sum moving_i * fixed_i^T as a row-major array */
+static void correlation(const double* fixed, const double* moving, int n, double* S)
+{
+  double Sxx = 0.0, Sxy = 0.0, Sxz = 0.0;
+  double Syx = 0.0, Syy = 0.0, Syz = 0.0;
+  double Szx = 0.0, Szy = 0.0, Szz = 0.0;
+  for(int i=0; i<n; i++){
+    double x1 = moving[3*i], y1 = moving[3*i+1], z1 = moving[3*i+2];
+    double x2 = fixed[3*i],  y2 = fixed[3*i+1],  z2 = fixed[3*i+2];
+    Sxx += x1*x2; Sxy += x1*y2; Sxz += x1*z2;
+    Syx += y1*x2; Syy += y1*y2; Syz += y1*z2;
+    Szx += z1*x2; Szy += z1*y2; Szz += z1*z2;
+  }
+  S[0] = Sxx; S[1] = Sxy; S[2] = Sxz;
+  S[3] = Syx; S[4] = Syy; S[5] = Syz;
+  S[6] = Szx; S[7] = Szy; S[8] = Szz;
+}
+
+double qcpInnerProduct(const double* coords, int n)
+{
+  double G = 0.0;
+  for(int i=0; i<3*n; i++)
+    G += coords[i]*coords[i];
+  return G;
+}
+
+double qcpSuperpose(const double* fixed, const double* moving, int n, double* rotation)
+{
+  double S[9];
+  correlation(fixed, moving, n, S);
+  return superposeFromCorrelation(S, qcpInnerProduct(moving, n), qcpInnerProduct(fixed, n), n, rotation);
+}
+
+double qcpRmsd(const double* fixed, const double* moving, int n, double fixedInner, double movingInner)
+{
+  double S[9];
+  correlation(fixed, moving, n, S);
+  return superposeFromCorrelation(S, movingInner, fixedInner, n, nullptr);
+}
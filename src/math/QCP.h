@@ -0,0 +1,59 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+#ifndef KGS_QCP_H
+#define KGS_QCP_H
+
+/**
+ * Optimal superposition of two point sets using the quaternion characteristic polynomial (QCP)
+ * method of Theobald (Acta Cryst. A 2005) with the rotation recovery of Liu et al. (J. Comput. Chem.
+ * 2010). Instead of diagonalizing the 3x3 correlation matrix as in Kabsch' method, the largest eigenvalue
+ * of Horn's 4x4 key matrix is found with a few Newton steps on its characteristic polynomial.
+ *
+ * Points are given as flat arrays x0 y0 z0 x1 y1 z1 ... and no memory is allocated.
+ */
+
+/** Translate the `n` points in `coords` so their centroid is at the origin. The old centroid is stored in `centroid`. */
+void qcpCenter(double* coords, int n, double centroid[3]);
+
+/**
+ * Return the smallest RMSD between the centered point sets `fixed` and `moving` over all rotations of
+ * `moving`. If `rotation` is non-null it receives the minimizing rotation R as a row-major 3x3 matrix, so
+ * R*moving_i is superposed on fixed_i. Coordinates are not modified.
+ */
+double qcpSuperpose(const double* fixed, const double* moving, int n, double* rotation = nullptr);
+
+/** Sum of squared coordinates of the `n` points in `coords` */
+double qcpInnerProduct(const double* coords, int n);
+
+/**
+ * Same as qcpSuperpose without rotation, but with the inner products (qcpInnerProduct) of both point sets
+ * given. Saves work when each point set is compared many times, e.g. for all pairs of an ensemble.
+ */
+double qcpRmsd(const double* fixed, const double* moving, int n, double fixedInner, double movingInner);
+
+#endif //KGS_QCP_H
@@ -44,7 +44,7 @@ QR* QR::createQR(gsl_matrix* M)
 #ifdef __INTEL_MKL
   return new QRMKL(M);
 #else
-  return new GSLQR(M);
+  return new QRGSL(M);
 #endif
 }
 
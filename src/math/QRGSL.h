@@ -9,8 +9,6 @@ class QRGSL: public QR {
  public:
   QRGSL(gsl_matrix* M): QR(M){}
 
- protected:
-
   void updateFromMatrix() override;
 };
 
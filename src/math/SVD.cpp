@@ -9,11 +9,11 @@
 
 using namespace std;
 
-SVD::SVD(gsl_matrix* M):
+SVD::SVD(gsl_matrix* M, bool computeU):
     matrix(M),
     m(M->size1),
     n(M->size2),
-    U(gsl_matrix_alloc(m,m)),
+    U(computeU ? gsl_matrix_alloc(m,m) : nullptr),
     S(gsl_vector_alloc(std::min(m,n))),
     V(gsl_matrix_alloc(n,n))
 {
@@ -21,12 +21,14 @@ SVD::SVD(gsl_matrix* M):
 
 
 SVD::~SVD(){
-  gsl_matrix_free(U);
+  if(U)
+    gsl_matrix_free(U);
   gsl_vector_free(S);
   gsl_matrix_free(V);
 }
 
 gsl_matrix* SVD::PseudoInverse() const{
+  if(U==nullptr) throw "SVD::PseudoInverse error: U is not computed by an economy SVD";
   gsl_matrix* S_dag = gsl_matrix_calloc(n,m);
   const int sz = std::min(m,n);
   for(int i=0;i<sz;i++){
@@ -47,6 +49,7 @@ gsl_matrix* SVD::PseudoInverse() const{
 }
 
 gsl_matrix* SVD::PseudoInverse(double lambda) const{
+  if(U==nullptr) throw "SVD::PseudoInverse error: U is not computed by an economy SVD";
   gsl_matrix* S_dag = gsl_matrix_calloc(n,m);
   const int sz = std::min(m,n);
   for(int i=0;i<sz;i++){
@@ -84,8 +87,10 @@ gsl_matrix* SVD::PseudoInverse(double lambda) const{
 
 void SVD::print() const{
   std::cout<<"SVD:"<<std::endl;
-  std::cout<<"U:"<<std::endl;
-  gsl_matrix_cout(U);
+  if(U) {
+    std::cout << "U:" << std::endl;
+    gsl_matrix_cout(U);
+  }
   std::cout<<"S:"<<std::endl;
   gsl_vector_cout(S);
   std::cout<<"V:"<<std::endl;
@@ -95,11 +100,11 @@ void SVD::print() const{
 
 
 
-SVD* SVD::createSVD(gsl_matrix* M)
+SVD* SVD::createSVD(gsl_matrix* M, bool economy)
 {
 #ifdef __INTEL_MKL
-  return new SVDMKL(M);
+  return new SVDMKL(M, economy);
 #else
-  return new SVDGSL(M);
+  return new SVDGSL(M, economy);
 #endif
 }
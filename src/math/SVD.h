@@ -19,19 +19,20 @@ class SVD{
  protected:
   const int m, n; ///< Dimensions of matrix
 
-  /** Decomposes M into U*S*V^t.  */
-  SVD(gsl_matrix* M);
+  /** Decomposes M into U*S*V^t. If `computeU` is false, U is neither allocated nor computed. */
+  SVD(gsl_matrix* M, bool computeU = true);
  public:
 
   gsl_matrix * const matrix;  //TODO: Make private
-  gsl_matrix * const U;       //TODO: Make private
+  gsl_matrix * const U;       //TODO: Make private. Null for economy SVDs
   gsl_matrix * const V;       //TODO: Make private
   gsl_vector * const S;       //TODO: Make private
 
   /** Constructs an SVD object. If MKL is available it will be an MKLSVD and if GSL
-   * is available it will be GSLSVD
+   * is available it will be GSLSVD. An `economy` SVD only computes S and V, which is
+   * all a nullspace needs, and can not be used for pseudo-inverses.
    */
-  static SVD* createSVD(gsl_matrix* M);
+  static SVD* createSVD(gsl_matrix* M, bool economy = false);
 
   virtual ~SVD();
 
@@ -9,7 +9,10 @@ void SVDGSL::UpdateFromMatrix()
     gsl_matrix_transpose_memcpy(U_t,matrix);
     gsl_vector *work = gsl_vector_alloc(m);
 
-    gsl_linalg_SV_decomp(U_t,U,S,work);
+    //The right singular vectors of M^T are U. Economy SVDs have no U so they go to a scratch matrix
+    gsl_matrix* U_out = U ? U : gsl_matrix_alloc(m,m);
+    gsl_linalg_SV_decomp(U_t,U_out,S,work);
+    if(U_out!=U) gsl_matrix_free(U_out);
 
     // QR decomposition to extend U_t (the final V^T) to a full nxn basis
     gsl_vector *tau = gsl_vector_alloc(m);
@@ -7,7 +7,7 @@
 
 class SVDGSL: public SVD {
  public:
-  SVDGSL(gsl_matrix* M): SVD(M){}
+  SVDGSL(gsl_matrix* M, bool economy = false): SVD(M, !economy){}
 
  protected:
 
@@ -1,62 +1,50 @@
 #include "SVDMKL.h"
 
 #include <algorithm>
+#include <iostream>
+
+SVDMKL::SVDMKL(gsl_matrix* M, bool economy):
+        SVD(M, !economy),
+        m_colMajor(gsl_matrix_alloc(M->size2, M->size1))
+{
+}
+
+SVDMKL::~SVDMKL()
+{
+    gsl_matrix_free(m_colMajor);
+}
 
 #ifdef __INTEL_MKL
 #include <mkl_lapack.h>
 
 void SVDMKL::UpdateFromMatrix()
 {
-    int lwrk;
-    const int mn = m*n;
-    const int mm = m*m;
-    const int nn = n*n;
-    double *a = new double [mn];for(int i=0;i<mn;i++) a[i]=0;
-    double *s= new double [m];  for(int i=0;i<m ;i++) s[i]=0;
-    double *u= new double [mm]; for(int i=0;i<mm;i++) u[i]=0;
-    double *vt =new double [nn];for(int i=0;i<nn;i++) vt[i]=0;
-    const char* Ustr = "A"; //All info: Full SVD
-    const char* Vstr = "A"; //All info: Full SVD
-
-    // Copy Jac from row-major to column-major format in a[]
-    for ( int i=0; i<m; ++i )
-        for ( int j=0; j<n; ++j )
-            a[i+j*m] = gsl_matrix_get (matrix, i, j );
-
+    const char* Ustr = U ? "A" : "N"; //Full U unless economy
+    const char* Vstr = "A";           //All of V as the trailing columns span the nullspace
+    const int lda = m;
+    const int ldu = U ? m : 1;
+    double* u = U ? U->data : nullptr;
     int info = 0;
-    double wkopt = 0;
-    lwrk = -1;
-    dgesvd( Ustr, Vstr, &m, &n, a, &m, s, u, &m, vt, &n, &wkopt, &lwrk, &info );
-    lwrk = (int)wkopt;
-    double *wrk = new double [lwrk]; for(int i=0;i<lwrk;i++) wrk[i]=0;
-
-    dgesvd(Ustr, Vstr, &m, &n, a, &m, s, u, &m, vt, &n, wrk, &lwrk, &info);
-
-
-    // Convert from MKL to GSL matrices
-    //TODO: Do this with gsl views on the arrays .. way faster
-
-    // Populate the S singular values
-    for (int i=0;i<std::min(m,n);++i)
-        gsl_vector_set ( S, i, s[i] );
-
-    // Populate the V matrix values (vt column-major=v row-major)
-    for ( int i=0; i<n; ++i )
-        for ( int j=0; j<n; ++j )
-            gsl_matrix_set (V, i, j, vt[i*n+j] );
-
-    // Populate the U matrix values (vt column-major=v row-major)
-    for ( int i=0; i<m; ++i )
-        for ( int j=0; j<m; ++j )
-            gsl_matrix_set (U, j, i, u[i*m+j] );
-
-    // Free memory
-    delete[] a;
-    delete[] s;
-    delete[] u;
-    delete[] vt;
-    delete[] wrk;
 
+    // The row-major transpose of matrix is matrix in column-major format
+    gsl_matrix_transpose_memcpy(m_colMajor, matrix);
+
+    if (m_work.empty()) {
+        double wkopt = 0;
+        int lwrk = -1;
+        dgesvd(Ustr, Vstr, &m, &n, m_colMajor->data, &lda, S->data, u, &ldu, V->data, &n, &wkopt, &lwrk, &info);
+        m_work.resize(std::max(1, (int)wkopt));
+    }
+
+    // Results are written straight into S, U and V. V^t in column-major order is V in row-major
+    // order, so V needs no conversion. U is returned column-major and is transposed in place.
+    int lwrk = m_work.size();
+    dgesvd(Ustr, Vstr, &m, &n, m_colMajor->data, &lda, S->data, u, &ldu, V->data, &n, m_work.data(), &lwrk, &info);
+    if (info<0) throw "SVDMKL::UpdateFromMatrix error: Illegal argument to dgesvd";
+    if (info>0) std::cerr<<"SVDMKL::UpdateFromMatrix warning: dgesvd did not converge ("<<info<<")"<<std::endl;
+
+    if (U)
+        gsl_matrix_transpose(U);
 }
 
 #else
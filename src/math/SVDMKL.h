@@ -1,13 +1,22 @@
 #ifndef KGS_SVDMKL_H
 #define KGS_SVDMKL_H
 
+#include <vector>
+
 #include "math/SVD.h"
 
 class SVDMKL: public SVD {
 public:
-    SVDMKL(gsl_matrix* M): SVD(M) {}
+    /** If `economy` is set only S and V are computed (dgesvd with jobu='N'). */
+    SVDMKL(gsl_matrix* M, bool economy = false);
+
+    ~SVDMKL();
 
     void UpdateFromMatrix() override;
+
+private:
+    gsl_matrix* m_colMajor;        ///< n x m transpose of matrix, i.e. matrix in column-major order. Overwritten by dgesvd
+    std::vector<double> m_work;    ///< dgesvd workspace, sized by a query on the first update and reused afterwards
 };
 
 
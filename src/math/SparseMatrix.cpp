@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "SparseMatrix.h"
+
+SparseMatrix::SparseMatrix(int rows, int cols):
+    m_rowPtr(rows+1, 0),
+    m_rows(rows),
+    m_cols(cols)
+{
+}
+
+void SparseMatrix::updateFromDense(const gsl_matrix* M, double tol)
+{
+  m_rows = M->size1;
+  m_cols = M->size2;
+  m_rowPtr.assign(m_rows+1, 0);
+  m_colIdx.clear();
+  m_values.clear();
+
+  for(int r=0; r<m_rows; r++){
+    const double* row = M->data + r*M->tda;
+    for(int c=0; c<m_cols; c++){
+      if( std::fabs(row[c])>tol ){
+        m_colIdx.push_back(c);
+        m_values.push_back(row[c]);
+      }
+    }
+    m_rowPtr[r+1] = m_values.size();
+  }
+}
+
+void SparseMatrix::reset(int rows, int cols)
+{
+  m_rows = rows;
+  m_cols = cols;
+  m_rowPtr.assign(m_rows+1, 0);
+  m_colIdx.clear();
+  m_values.clear();
+  m_added.clear();
+}
+
+void SparseMatrix::add(int row, int col, double value)
+{
+  assert(row>=0 && row<m_rows && col>=0 && col<m_cols);
+  m_added.push_back(std::make_tuple(row, col, value));
+}
+
+void SparseMatrix::compress()
+{
+  //Stable so the last of repeated entries wins, as with gsl_matrix_set
+  std::stable_sort(m_added.begin(), m_added.end(),
+                   [](const std::tuple<int,int,double>& a, const std::tuple<int,int,double>& b){
+                     return std::get<0>(a)<std::get<0>(b) || (std::get<0>(a)==std::get<0>(b) && std::get<1>(a)<std::get<1>(b));
+                   });
+
+  m_rowPtr.assign(m_rows+1, 0);
+  m_colIdx.clear();
+  m_values.clear();
+  for(size_t k=0; k<m_added.size(); k++){
+    if(k+1<m_added.size() && std::get<0>(m_added[k+1])==std::get<0>(m_added[k]) && std::get<1>(m_added[k+1])==std::get<1>(m_added[k]))
+      continue;
+    if(std::get<2>(m_added[k])==0.0) continue;
+    m_colIdx.push_back(std::get<1>(m_added[k]));
+    m_values.push_back(std::get<2>(m_added[k]));
+    m_rowPtr[std::get<0>(m_added[k])+1]++;
+  }
+  for(int r=0; r<m_rows; r++)
+    m_rowPtr[r+1] += m_rowPtr[r];
+  m_added.clear();
+}
+
+void SparseMatrix::toDense(gsl_matrix* M) const
+{
+  assert(M->size1==m_rows && M->size2==m_cols);
+  gsl_matrix_set_zero(M);
+  for(int r=0; r<m_rows; r++)
+    for(int k=m_rowPtr[r]; k<m_rowPtr[r+1]; k++)
+      gsl_matrix_set(M, r, m_colIdx[k], m_values[k]);
+}
+
+void SparseMatrix::multiply(const gsl_vector* x, gsl_vector* y) const
+{
+  assert(x->size==m_cols && y->size==m_rows);
+  for(int r=0; r<m_rows; r++){
+    double sum = 0.0;
+    for(int k=m_rowPtr[r]; k<m_rowPtr[r+1]; k++)
+      sum += m_values[k] * gsl_vector_get(x, m_colIdx[k]);
+    gsl_vector_set(y, r, sum);
+  }
+}
+
+void SparseMatrix::multiplyTranspose(const gsl_vector* x, gsl_vector* y) const
+{
+  assert(x->size==m_rows && y->size==m_cols);
+  gsl_vector_set_zero(y);
+  for(int r=0; r<m_rows; r++){
+    double xr = gsl_vector_get(x, r);
+    if(xr==0.0) continue;
+    for(int k=m_rowPtr[r]; k<m_rowPtr[r+1]; k++)
+      gsl_vector_set(y, m_colIdx[k], gsl_vector_get(y, m_colIdx[k]) + m_values[k]*xr);
+  }
+}
+
+double SparseMatrix::density() const
+{
+  if(m_rows==0 || m_cols==0) return 0.0;
+  return ((double)m_values.size())/((double)m_rows*m_cols);
+}
@@ -0,0 +1,59 @@
+#ifndef KGS_SPARSEMATRIX_H
+#define KGS_SPARSEMATRIX_H
+
+#include <tuple>
+#include <vector>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+
+/**
+ * A matrix stored in compressed sparse row (CSR) format. The non-zeros of row i are
+ * `m_values[m_rowPtr[i]] .. m_values[m_rowPtr[i+1]-1]` with columns given by the same
+ * range of `m_colIdx`. Columns within a row are sorted.
+ *
+ * Constraint Jacobians are very sparse as each row only involves the DOFs on one cycle,
+ * so this is used to analyze their structure without scanning the dense matrix repeatedly.
+ */
+class SparseMatrix {
+ public:
+  /** Construct an empty (all zero) `rows` x `cols` matrix */
+  SparseMatrix(int rows, int cols);
+
+  /** Replace contents with the entries of `M` whose magnitude exceeds `tol`. Dimensions follow `M`. */
+  void updateFromDense(const gsl_matrix* M, double tol = 0.0);
+
+  /** Remove all entries and set the dimensions. New entries are given with `add` followed by `compress`. */
+  void reset(int rows, int cols);
+
+  /** Add an entry in any order. Setting the same entry again overwrites it. Not visible until `compress`. */
+  void add(int row, int col, double value);
+
+  /** Build the CSR arrays from the entries added since `reset`. Zero entries are dropped. */
+  void compress();
+
+  /** Write the matrix to the dense matrix `M` which must have the same dimensions. */
+  void toDense(gsl_matrix* M) const;
+
+  /** Compute y = A*x */
+  void multiply(const gsl_vector* x, gsl_vector* y) const;
+
+  /** Compute y = A^T*x */
+  void multiplyTranspose(const gsl_vector* x, gsl_vector* y) const;
+
+  int rows() const { return m_rows; }
+  int cols() const { return m_cols; }
+  int nonZeros() const { return (int)m_values.size(); }
+
+  /** Fraction of entries that are non-zero */
+  double density() const;
+
+  std::vector<int> m_rowPtr;     ///< Start of each row in m_colIdx/m_values. Has rows()+1 entries
+  std::vector<int> m_colIdx;     ///< Column of each non-zero
+  std::vector<double> m_values;  ///< Value of each non-zero
+
+ private:
+  int m_rows, m_cols;
+  std::vector< std::tuple<int,int,double> > m_added; ///< Entries given to `add` and not yet compressed
+};
+
+#endif //KGS_SPARSEMATRIX_H
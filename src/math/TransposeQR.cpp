@@ -9,6 +9,12 @@ TransposeQR::TransposeQR(gsl_matrix* M):
     m_qr(QR::createQR(gsl_matrix_alloc(M->size2, M->size1)))
 {}
 
+TransposeQR::~TransposeQR()
+{
+  gsl_matrix_free(m_qr->getMatrix());
+  delete m_qr;
+}
+
 
 void TransposeQR::updateFromMatrix()
 {
@@ -17,6 +17,8 @@ class TransposeQR{
  public:
   TransposeQR(gsl_matrix* M);
 
+  ~TransposeQR();
+
   void updateFromMatrix();
 
   gsl_matrix* getMatrix() const;
@@ -28,8 +30,8 @@ class TransposeQR{
   gsl_matrix* getR() const;
 
  private:
-  QR * const m_qr;
   gsl_matrix * const m_origMatrix;
+  QR * const m_qr;                 ///< Decomposition of the transpose of m_origMatrix
 };
 
 #endif
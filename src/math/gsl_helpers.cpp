@@ -35,17 +35,21 @@ void gsl_matrix_outtofile (const gsl_matrix *m, const string& filename) {
     cerr<<"Cannot write to "<<filename<<". You might need to create output directory first"<<endl;
     exit(-1);
   }
+  gsl_matrix_out(m, output);
+  output.close();
+}
+
+void gsl_matrix_out (const gsl_matrix *m, ostream& os) {
   for (int i=0; i<m->size1; ++i) {
     for (int j=0; j<m->size2; ++j) {
-      output << setprecision(14) << gsl_matrix_get(m,i,j); //<< setw(20)
-      //output << gsl_matrix_get(m,i,j) << " ";
+      os << setprecision(14) << gsl_matrix_get(m,i,j); //<< setw(20)
+      //os << gsl_matrix_get(m,i,j) << " ";
       if(j == (m->size2-1))
-        output << endl;
+        os << endl;
       else
-        output << " ";
+        os << " ";
     }
   }
-  output.close();
 }
 
 void gsl_vector_out (const gsl_vector *v, ostream& os) {
@@ -121,6 +125,12 @@ gsl_vector* gsl_vector_copy(gsl_vector* v){
   return ret;
 }
 
+gsl_matrix* gsl_matrix_copy(gsl_matrix* M){
+  gsl_matrix* ret = gsl_matrix_alloc(M->size1, M->size2);
+  gsl_matrix_memcpy(ret, M);
+  return ret;
+}
+
 gsl_vector* gsl_matrix_vector_mul(gsl_matrix* A, gsl_vector* v){
   int MA = A->size1;
   int NA = A->size2;
@@ -11,6 +11,9 @@ void gsl_matrix_cout (      const gsl_matrix *m);
 /** Print matrix to file specified by `filename` */
 void gsl_matrix_outtofile ( const gsl_matrix *m, const std::string& filename    );
 
+/** Print matrix to output-stream, one row per line, as gsl_matrix_outtofile does */
+void gsl_matrix_out (const gsl_matrix *m, std::ostream& os);
+
 /** Print vector to file specified by `filename` */
 void gsl_vector_outtofile ( const gsl_vector *v, const std::string& filename    );
 
@@ -36,6 +39,9 @@ void gsl_vector_scale_max_component(gsl_vector* v, double maxComponent);
 /** Make a copy of the vector */
 gsl_vector* gsl_vector_copy(gsl_vector*);
 
+/** Make a copy of the matrix */
+gsl_matrix* gsl_matrix_copy(gsl_matrix*);
+
 gsl_matrix* gsl_matrix_trans(gsl_matrix* A);
 
 gsl_matrix* gsl_matrix_mul(gsl_matrix* A, gsl_matrix* B);
@@ -37,12 +37,78 @@ using namespace std;
 
 namespace metrics{
 
+std::atomic<unsigned long> Dihedral::m_nextInstanceId(0);
+
 Dihedral::Dihedral(Selection& selection):
-Metric(selection)
+Metric(selection),
+m_instanceId(m_nextInstanceId++)
 {}
 
 
-double Dihedral::distance(Configuration* c1, Configuration* c2)
+/**
+ * Periodic difference in [0,pi] between two angles. DOF-values are not kept in [-pi,pi], so the
+ * difference is reduced modulo 2pi before wrapping.
+ */
+static inline double angleDiff(double a, double b)
+{
+  double angle_diff = fmod(fabs(b - a), 2*M_PI);
+  return angle_diff>M_PI ? 2*M_PI - angle_diff : angle_diff;
+}
+
+/**
+ * Sum of squared periodic differences between two arrays of angles. Four partial sums keep the loop free of
+ * dependencies between iterations so it can be vectorized.
+ */
+static double sumSquaredAngleDiffs(const double* a, const double* b, size_t n)
+{
+  double sum[4] = {0.0, 0.0, 0.0, 0.0};
+  size_t i = 0;
+  for(; i+4<=n; i+=4){
+    for(size_t k=0; k<4; k++){
+      double angle_diff = angleDiff(a[i+k], b[i+k]);
+      sum[k] += angle_diff*angle_diff;
+    }
+  }
+  for(; i<n; i++){
+    double angle_diff = angleDiff(a[i], b[i]);
+    sum[0] += angle_diff*angle_diff;
+  }
+  return (sum[0]+sum[1]) + (sum[2]+sum[3]);
+}
+
+const Dihedral::DofIndices& Dihedral::getDofIndices(const Molecule* mol)
+{
+  //Most calls repeat the previous lookup of the thread. Map entries are never erased, so the pointer stays valid.
+  struct LastLookup { unsigned long metric, molecule; const DofIndices* dofs; };
+  static thread_local LastLookup last = {0, 0, nullptr};
+  if( last.dofs!=nullptr && last.metric==m_instanceId && last.molecule==mol->getUniqueId() )
+    return *last.dofs;
+
+  std::lock_guard<std::mutex> lock(m_dofIndicesMutex);
+  auto it = m_dofIndices.find(mol->getUniqueId());
+  if( it!=m_dofIndices.end() ){
+    last = {m_instanceId, mol->getUniqueId(), &it->second};
+    return it->second;
+  }
+
+  DofIndices& dofs = m_dofIndices[mol->getUniqueId()];
+  for(KinEdge*& edge: mol->m_spanningTree->m_edges){
+    if(edge->getBond()==nullptr || !m_selection.inSelection(edge->getBond())) continue;
+    dofs.indices.push_back(edge->getDOF()->getIndex());
+  }
+
+  dofs.contiguous = !dofs.indices.empty();
+  for(size_t i=1; i<dofs.indices.size(); i++){
+    if(dofs.indices[i]!=dofs.indices[0]+(int)i){
+      dofs.contiguous = false;
+      break;
+    }
+  }
+  last = {m_instanceId, mol->getUniqueId(), &dofs};
+  return dofs;
+}
+
+void Dihedral::checkBonds(Configuration* c1, Configuration* c2)
 {
   const std::vector<Bond*>& bonds1 = m_selection.getSelectedBonds(c1->getMolecule());
   const std::vector<Bond*>& bonds2 = m_selection.getSelectedBonds(c2->getMolecule());
@@ -57,33 +123,63 @@ double Dihedral::distance(Configuration* c1, Configuration* c2)
     cerr<<" - Configurations have different number of bonds ("<<bonds1.size()<<" vs "<<bonds2.size()<<")"<<endl;
     exit(-1);
   }
+}
+
+const double* Dihedral::gatherTorsions(Configuration* conf, bool global, const DofIndices& dofs, std::vector<double>& buffer)
+{
+  const double* values = global ? conf->getGlobalTorsions() : conf->m_dofs;
+  if(dofs.contiguous)
+    return values + dofs.indices[0];
+
+  buffer.resize(dofs.indices.size());
+  for(size_t i=0; i<dofs.indices.size(); i++)
+    buffer[i] = values[dofs.indices[i]];
+  return buffer.data();
+}
+
+double Dihedral::distance(Configuration* c1, Configuration* c2)
+{
+  checkBonds(c1, c2);
 
-  Molecule * m_protein = c1->getMolecule();
-  bool useGlobals = m_protein!=c2->getMolecule();
   //if true, two separate molecules with different torsional dofs --> use global torsion values and not m_dofs
-  //TODO: Extract c1->getGlobalTorsions and c2->getGlobalTorsions to avoid complicated loop and multiple global guards
+  bool useGlobals = c1->getMolecule()!=c2->getMolecule();
+  const DofIndices& dofs = getDofIndices(c1->getMolecule());
+  size_t count = dofs.indices.size();
+
+  static thread_local std::vector<double> buffer1, buffer2;
+  const double* a = gatherTorsions(c1, useGlobals, dofs, buffer1);
+  const double* b = gatherTorsions(c2, useGlobals, dofs, buffer2);
+  return sqrt(sumSquaredAngleDiffs(a, b, count)/count);
+}
 
-  int count = 0;
-  double distance=0.0;
-  for(KinEdge*& edge: m_protein->m_spanningTree->m_edges){
-    if(edge->getBond()==nullptr || !m_selection.inSelection(edge->getBond())) continue;
-    int dofId = edge->getDOF()->getIndex();
-    double angle_diff;
-    if(useGlobals) {
-      angle_diff = fabs(c2->getGlobalTorsion(dofId) - c1->getGlobalTorsion(dofId));
-      if(angle_diff>M_PI)
-        angle_diff = 2*M_PI - angle_diff;
-    }else{
-      angle_diff = fabs(c2->m_dofs[dofId] - c1->m_dofs[dofId]);
-      if(angle_diff>M_PI)
-        angle_diff = 2*M_PI - angle_diff;
+void Dihedral::distances(const std::list<Configuration*>& confs, Configuration* target, std::vector<double>& ret)
+{
+  ret.resize(confs.size());
+  if(confs.empty()) return;
+
+  static thread_local std::vector<double> targetLocal, targetGlobal, buffer;
+  const double* targetTorsions[2] = {nullptr, nullptr}; // DOF-values and global torsions of target
+  const Molecule* indexedMolecule = nullptr;
+
+  size_t i = 0;
+  for(Configuration* conf: confs){
+    checkBonds(conf, target);
+
+    //As in distance, indices come from the molecule of the first argument. Regather target if that changes.
+    const DofIndices& dofs = getDofIndices(conf->getMolecule());
+    if(conf->getMolecule()!=indexedMolecule){
+      indexedMolecule = conf->getMolecule();
+      targetTorsions[0] = targetTorsions[1] = nullptr;
     }
-
-    distance += angle_diff*angle_diff;
-    count++;
+    size_t count = dofs.indices.size();
+
+    bool useGlobals = conf->getMolecule()!=target->getMolecule();
+    const double*& b = targetTorsions[useGlobals];
+    if(b==nullptr)
+      b = gatherTorsions(target, useGlobals, dofs, useGlobals ? targetGlobal : targetLocal);
+    const double* a = gatherTorsions(conf, useGlobals, dofs, buffer);
+    ret[i++] = sqrt(sumSquaredAngleDiffs(a, b, count)/count);
   }
-
-  return sqrt(distance/count);
 }
 
 }
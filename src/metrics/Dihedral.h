@@ -29,19 +29,54 @@ IN THE SOFTWARE.
 #ifndef DIHEDRAL_H_
 #define DIHEDRAL_H_
 
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "Metric.h"
 #include "core/Configuration.h"
 
 namespace metrics {
 
+/**
+ * Root mean square of the periodic differences between the selected torsions. Configurations of different
+ * molecules are compared using global torsions.
+ */
 class Dihedral : public Metric {
  public:
   Dihedral(Selection &selection);
 
   double distance(Configuration *, Configuration *);
 
+  /** Distances from all of `confs` to `target`. The torsions of `target` are only gathered once. */
+  void distances(const std::list<Configuration *> &confs, Configuration *target, std::vector<double> &ret);
+
+ private:
+  /** Indices of the DOFs whose bond is in the selection, in spanning tree order */
+  struct DofIndices {
+    std::vector<int> indices;
+    bool contiguous;              ///< indices are consecutive, so the DOF-values can be used without gathering
+  };
+
+  /**
+   * DOF indices of `mol`. Computed on the first call and cached under the unique id of the molecule, so
+   * entries don't go stale when a molecule address is reused. Safe to call from several threads.
+   */
+  const DofIndices &getDofIndices(const Molecule *mol);
+
+  /** Exit if c1 and c2 can't be compared */
+  void checkBonds(Configuration *c1, Configuration *c2);
+
+  /** The torsions of `conf` listed in `dofs`. Returns a pointer into `conf` or `buffer`. */
+  const double *gatherTorsions(Configuration *conf, bool global, const DofIndices &dofs, std::vector<double> &buffer);
+
+  std::map<unsigned long, DofIndices> m_dofIndices;     ///< Keyed by Molecule::getUniqueId
+  std::mutex m_dofIndicesMutex;
+  const unsigned long m_instanceId;                     ///< Validates the per-thread lookup cache
+  static std::atomic<unsigned long> m_nextInstanceId;
 };
 
 }
@@ -28,12 +28,32 @@ IN THE SOFTWARE.
 
 #include "Metric.h"
 
+#include <iostream>
+#include <cstdlib>
+
 namespace metrics {
 
 Metric::Metric( Selection &selection ) :
     m_selection(selection)
 { }
 
+void Metric::distances(const std::list<Configuration*>& confs, Configuration* target, std::vector<double>& ret){
+  ret.resize(confs.size());
+  size_t i = 0;
+  for(Configuration* conf: confs)
+    ret[i++] = distance(conf, target);
+}
+
+bool Metric::positions(Configuration* conf, std::vector<double>& ret){
+  ret.clear();
+  return false;
+}
+
+double Metric::distance(const std::vector<double>& p1, const std::vector<double>& p2){
+  std::cerr<<"Metric::distance - This metric doesn't measure distances on positions"<<std::endl;
+  exit(-1);
+}
+
 Selection& Metric::getSelection(){
   return m_selection;
 }
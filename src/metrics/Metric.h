@@ -29,6 +29,9 @@ IN THE SOFTWARE.
 #ifndef METRIC_H_
 #define METRIC_H_
 
+#include <list>
+#include <vector>
+
 #include "core/Configuration.h"
 #include "Selection.h"
 
@@ -37,9 +40,27 @@ namespace metrics{
 class Metric{
  public:
   Metric(Selection&);
+  virtual ~Metric() {}
 
   virtual double distance(Configuration*, Configuration*) = 0;
 
+  /**
+   * Distance from each of `confs` to `target`, so ret[i] is the distance from the i'th of `confs`. Metrics override
+   * this when work depending only on `target` can be shared between the distances.
+   */
+  virtual void distances(const std::list<Configuration*>& confs, Configuration* target, std::vector<double>& ret);
+
+  /**
+   * If distances of this metric only depend on the positions of the selected atoms, store them in `ret`
+   * (as x0 y0 z0 x1 ...) and return true. Positions of configurations of the same molecule (or of clones
+   * of it) can then be compared with `distance(p1, p2)` without updating the molecule. Metrics that don't
+   * measure positions return false.
+   */
+  virtual bool positions(Configuration* conf, std::vector<double>& ret);
+
+  /** Distance between positions returned by `positions`. Only valid for metrics that measure positions. */
+  virtual double distance(const std::vector<double>& p1, const std::vector<double>& p2);
+
   Selection& getSelection();
 
  protected:
@@ -0,0 +1,147 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#include "PairwiseRMSD.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+#include "core/Molecule.h"
+#include "core/Chain.h"
+#include "Selection.h"
+#include "ThreadPool.h"
+#include "math/QCP.h"
+
+using namespace std;
+
+namespace metrics {
+
+PairwiseRMSD::PairwiseRMSD(Molecule *reference, Selection &selection) {
+  for (auto const &atom: selection.getSelectedAtoms(reference)) {
+    m_atomIds.push_back(make_tuple(atom->getResidue()->getChain()->getName(),
+                                   atom->getResidue()->getId(),
+                                   atom->getName()));
+  }
+
+  if (m_atomIds.empty()) {
+    cerr << "PairwiseRMSD::PairwiseRMSD - Atom-selection contained no atoms: " << selection << endl;
+    exit(-1);
+  }
+}
+
+void PairwiseRMSD::addStructure(Molecule *mol) {
+  size_t offset = m_coordinates.size();
+  m_coordinates.resize(offset + 3 * numAtoms());
+  double *coords = &m_coordinates[offset];
+
+  for (auto const &id: m_atomIds) {
+    Atom *atom = mol->getAtom(get<0>(id), get<1>(id), get<2>(id));
+    if (atom == nullptr) {
+      cerr << "PairwiseRMSD::addStructure - " << mol->getName() << " has no atom " << get<2>(id);
+      cerr << " in residue " << get<1>(id) << " of chain " << get<0>(id) << endl;
+      exit(-1);
+    }
+    *coords++ = atom->m_position.x;
+    *coords++ = atom->m_position.y;
+    *coords++ = atom->m_position.z;
+  }
+
+  double centroid[3];
+  qcpCenter(&m_coordinates[offset], numAtoms(), centroid);
+  m_inner.push_back(qcpInnerProduct(&m_coordinates[offset], numAtoms()));
+}
+
+size_t PairwiseRMSD::numStructures() const {
+  return m_inner.size();
+}
+
+size_t PairwiseRMSD::numAtoms() const {
+  return m_atomIds.size();
+}
+
+size_t PairwiseRMSD::condensedIndex(size_t i, size_t j) const {
+  size_t n = numStructures();
+  return n * i - i * (i + 1) / 2 + j - i - 1;
+}
+
+void PairwiseRMSD::compute(ThreadPool &pool) {
+  size_t n = numStructures();
+  size_t atoms = numAtoms();
+  m_distances.assign(n > 1 ? n * (n - 1) / 2 : 0, 0.0);
+
+  //Tiles of structures are compared with each other. Two tiles of coordinates should fit in about 1MB of cache.
+  size_t tileSize = (1 << 20) / (2 * 3 * atoms * sizeof(double));
+  tileSize = std::min(std::max(tileSize, (size_t) 1), (size_t) 64);
+  size_t numTiles = (n + tileSize - 1) / tileSize;
+
+  vector<pair<size_t, size_t> > tilePairs;
+  for (size_t a = 0; a < numTiles; a++)
+    for (size_t b = a; b < numTiles; b++)
+      tilePairs.push_back(make_pair(a, b));
+
+  //Each pair of structures belongs to exactly one tile pair, so tasks write disjoint entries
+  pool.parallelFor(tilePairs.size(), [&](size_t t, unsigned int) {
+    size_t iEnd = std::min(n, (tilePairs[t].first + 1) * tileSize);
+    size_t jEnd = std::min(n, (tilePairs[t].second + 1) * tileSize);
+    for (size_t i = tilePairs[t].first * tileSize; i < iEnd; i++) {
+      const double *ci = &m_coordinates[3 * atoms * i];
+      for (size_t j = std::max(tilePairs[t].second * tileSize, i + 1); j < jEnd; j++) {
+        const double *cj = &m_coordinates[3 * atoms * j];
+        m_distances[condensedIndex(i, j)] = qcpRmsd(ci, cj, atoms, m_inner[i], m_inner[j]);
+      }
+    }
+  });
+}
+
+const std::vector<double> &PairwiseRMSD::getDistances() const {
+  return m_distances;
+}
+
+double PairwiseRMSD::distance(size_t i, size_t j) const {
+  if (i == j) return 0.0;
+  if (i > j) std::swap(i, j);
+  return m_distances[condensedIndex(i, j)];
+}
+
+void PairwiseRMSD::write(const std::string &fileName) const {
+  ofstream out(fileName.c_str(), ios::out | ios::binary);
+  if (!out.is_open()) {
+    cerr << "PairwiseRMSD::write - Could not open " << fileName << " for writing" << endl;
+    exit(-1);
+  }
+
+  uint64_t n = numStructures();
+  out.write("KGSDIST1", 8);
+  out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+  out.write(reinterpret_cast<const char *>(m_distances.data()), m_distances.size() * sizeof(double));
+  out.close();
+}
+
+}
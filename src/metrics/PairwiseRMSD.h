@@ -0,0 +1,91 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#ifndef PAIRWISERMSD_H_
+#define PAIRWISERMSD_H_
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+class Molecule;
+class Selection;
+class ThreadPool;
+
+namespace metrics {
+
+/**
+ * RMSD after optimal superposition between all pairs of an ensemble of structures, e.g. the samples of a
+ * KGS run, for clustering.
+ *
+ * The selected atoms of every structure are stored centered in one contiguous array, so each pair only
+ * needs the correlation of two coordinate blocks and a QCP solve (see math/QCP.h). Pairs are computed in
+ * tiles of structures that fit in cache together, and tiles are spread over a ThreadPool.
+ *
+ * The result is the condensed upper triangle used by e.g. scipy.cluster.hierarchy: for i<j the distance
+ * between structures i and j is at index n*i - i*(i+1)/2 + j-i-1.
+ */
+class PairwiseRMSD {
+ public:
+  /** Compare the atoms of `selection` in `reference`. Structures must contain atoms matching all of them. */
+  PairwiseRMSD(Molecule *reference, Selection &selection);
+
+  /** Copy the coordinates of the selected atoms of `mol`, matched by chain, residue id and atom name */
+  void addStructure(Molecule *mol);
+
+  size_t numStructures() const;
+  size_t numAtoms() const;
+
+  /** Compute the distances between all pairs of structures added so far */
+  void compute(ThreadPool &pool);
+
+  /** Condensed distance matrix computed by `compute` */
+  const std::vector<double> &getDistances() const;
+
+  /** Distance between structures i and j */
+  double distance(size_t i, size_t j) const;
+
+  /**
+   * Write the condensed matrix to `fileName`: the 8 characters "KGSDIST1", the number of structures as an
+   * unsigned 64 bit integer, and the n*(n-1)/2 distances as 64 bit floats, all in the byte order of this machine.
+   */
+  void write(const std::string &fileName) const;
+
+ private:
+  /** Chain name, residue id and atom name of the selected atoms of the reference */
+  std::vector<std::tuple<std::string, int, std::string> > m_atomIds;
+  std::vector<double> m_coordinates;  ///< Centered xyz of all structures, numAtoms()*3 per structure
+  std::vector<double> m_inner;        ///< Sum of squared centered coordinates of each structure
+  std::vector<double> m_distances;
+
+  size_t condensedIndex(size_t i, size_t j) const;
+};
+
+}
+
+#endif
@@ -28,463 +28,197 @@ IN THE SOFTWARE.
 
 #include <cmath>
 #include "metrics/RMSD.h"
-#include <gsl/gsl_eigen.h>
-#include <gsl/gsl_blas.h>
-#include <gsl/gsl_matrix.h>
-#include "math/gsl_helpers.h"
+#include "math/QCP.h"
 
 using namespace std;
 
 namespace metrics {
 
+std::atomic<unsigned long> RMSD::m_nextInstanceId(0);
+
 RMSD::RMSD(Selection &selection) :
-    Metric(selection) {}
+    Metric(selection),
+    m_instanceId(m_nextInstanceId++)
+{
+  m_destructionListener = Molecule::addDestructionListener([this](unsigned long id) { removeMolecule(id); });
+}
 
+RMSD::~RMSD() {
+  Molecule::removeDestructionListener(m_destructionListener);
+}
 
-double RMSD::distance(Configuration *c1, Configuration *c2) {
 
-  const std::vector<Atom *> &atomsRMSD1 = m_selection.getSelectedAtoms(c1->getMolecule());
-
-  Molecule* m1 = c1->getMolecule();
-  Molecule* m2 = c2->getMolecule();
-
-  // Build two vectors of atoms where each entry in one has matching chain name, residue id, and atom name in the other
-  std::vector<Atom*> *matchedAtoms1;
-  std::vector<Atom*> *matchedAtoms2;
-  if (m1 == m2){
-    matchedAtoms1 = new std::vector<Atom*>(atomsRMSD1);
-    matchedAtoms2 = new std::vector<Atom*>(atomsRMSD1);
-  }else {
-    matchedAtoms1 = new std::vector<Atom*>();
-    matchedAtoms2 = new std::vector<Atom*>();
-
-    for (auto const &aIt : atomsRMSD1) {
-      const std::string &name = aIt->getName();
-      const std::string &chainName = aIt->getResidue()->getChain()->getName();
-      int resId = aIt->getResidue()->getId();
-      Atom *a1 = &(*aIt);
-      Atom *a2 = m2->getAtom(chainName, resId, name);
+/** Copy the positions of `atoms` to `coords` as x0 y0 z0 x1 ... */
+static void gatherPositions(const std::vector<Atom *> &atoms, std::vector<double> &coords) {
+  coords.resize(3 * atoms.size());
+  double *c = coords.data();
+  for (auto const &aIt : atoms) {
+    const Coordinate &pos = aIt->m_position;
+    assert(!std::isnan(pos.x));
+    assert(!std::isnan(pos.y));
+    assert(!std::isnan(pos.z));
+    assert(pos.x < 10000.0);
+    assert(pos.y < 10000.0);
+    assert(pos.z < 10000.0);
+    *c++ = pos.x;
+    *c++ = pos.y;
+    *c++ = pos.z;
+  }
+}
+
+const RMSD::AtomCorrespondence &RMSD::getCorrespondence(Molecule *m1, Molecule *m2) {
+  //Entries stay alive while a thread holds them, even if the molecule is destroyed and the entry removed
+  struct LastLookup {
+    unsigned long metric, molecule1, molecule2;
+    std::shared_ptr<const AtomCorrespondence> matched;
+  };
+  static thread_local LastLookup last = {0, 0, 0, nullptr};
+
+  unsigned long id1 = m1->getUniqueId(), id2 = m2->getUniqueId();
+  if (last.matched && last.metric == m_instanceId && last.molecule1 == id1 && last.molecule2 == id2 &&
+      last.matched->numAtoms1 == m1->getAtoms().size() && last.matched->numAtoms2 == m2->getAtoms().size())
+    return *last.matched;
+
+  std::lock_guard<std::mutex> lock(m_correspondenceMutex);
+
+  std::shared_ptr<const AtomCorrespondence> &cached = m_correspondences[std::make_pair(id1, id2)];
+  if (!cached || cached->numAtoms1 != m1->getAtoms().size() || cached->numAtoms2 != m2->getAtoms().size()) {
+    // Build two vectors of atoms where each entry in one has matching chain name, residue id, and atom name in the other
+    std::shared_ptr<AtomCorrespondence> ret = std::make_shared<AtomCorrespondence>();
+    ret->numAtoms1 = m1->getAtoms().size();
+    ret->numAtoms2 = m2->getAtoms().size();
+    for (auto const &aIt : m1->getAtoms()) {
+      if (!m_selection.inSelection(aIt)) continue;
+      Atom *a2 = aIt;
+      if (m1 != m2) {
+        const std::string &name = aIt->getName();
+        const std::string &chainName = aIt->getResidue()->getChain()->getName();
+        int resId = aIt->getResidue()->getId();
+        a2 = m2->getAtom(chainName, resId, name);
+      }
       if (a2 != nullptr) {
-        matchedAtoms1->push_back(a1);
-        matchedAtoms2->push_back(a2);
+        ret->atoms1.push_back(aIt);
+        ret->atoms2.push_back(a2);
       }
     }
+
+    if (ret->atoms1.empty()) {
+      cerr << "RMSD::distance - Atom-selection given to RMSD metric contained no atoms: " << m_selection << endl;
+      exit(-1);
+    }
+    cached = ret;
   }
 
-  if (atomsRMSD1.empty()) {
-    cerr << "RMSD::distance - Atom-selection given to RMSD metric contained no atoms: " << m_selection << endl;
-    exit(-1);
+  last = {m_instanceId, id1, id2, cached};
+  return *last.matched;
+}
+
+void RMSD::removeMolecule(unsigned long moleculeId) {
+  std::lock_guard<std::mutex> lock(m_correspondenceMutex);
+  for (auto it = m_correspondences.begin(); it != m_correspondences.end();) {
+    if (it->first.first == moleculeId || it->first.second == moleculeId)
+      it = m_correspondences.erase(it);
+    else
+      ++it;
   }
+}
 
-  int atom_num = matchedAtoms1->size();
+double RMSD::distance(Configuration *c1, Configuration *c2) {
+
+  const AtomCorrespondence &matched = getCorrespondence(c1->getMolecule(), c2->getMolecule());
+  int atom_num = matched.atoms1.size();
   assert(atom_num > 3);
 
-  gsl_matrix *static_matrix = gsl_matrix_alloc(atom_num, 3);
-  gsl_matrix *moving_matrix = gsl_matrix_alloc(atom_num, 3);
+  //Buffers are reused between calls, so apart from the first call on a thread nothing is allocated
+  static thread_local std::vector<double> staticCoords, movingCoords;
 
   c1->updateMolecule();
-  unsigned int i = 0;
-  for (auto const &aIt : *matchedAtoms1) {
-    const Coordinate &c1 = (*aIt).m_position;
-    gsl_matrix_set(static_matrix, i, 0, c1.x);
-    gsl_matrix_set(static_matrix, i, 1, c1.y);
-    gsl_matrix_set(static_matrix, i, 2, c1.z);
-
-    assert(!std::isnan(c1.x));
-    assert(!std::isnan(c1.y));
-    assert(!std::isnan(c1.z));
-    assert(c1.x < 10000.0);
-    assert(c1.y < 10000.0);
-    assert(c1.z < 10000.0);
-
-    i++;
-  }
-
+  gatherPositions(matched.atoms1, staticCoords);
   c2->updateMolecule();
-  i = 0;
-  for (auto const &aIt: *matchedAtoms2) {
-    const Coordinate &c2 = (*aIt).m_position;
-    gsl_matrix_set(moving_matrix, i, 0, c2.x);
-    gsl_matrix_set(moving_matrix, i, 1, c2.y);
-    gsl_matrix_set(moving_matrix, i, 2, c2.z);
-
-    assert(!std::isnan(c2.x));
-    assert(!std::isnan(c2.y));
-    assert(!std::isnan(c2.z));
-    assert(c2.x < 10000.0);
-    assert(c2.y < 10000.0);
-    assert(c2.z < 10000.0);
-
-    i++;
-  }
+  gatherPositions(matched.atoms2, movingCoords);
 
-  gsl_matrix *rotate = gsl_matrix_alloc(3, 3);
-  gsl_vector *transl = gsl_vector_alloc(3);
+  /// Only the remaining rmsd of the optimal superposition is needed, not the rotation
+  double centroid[3];
+  qcpCenter(staticCoords.data(), atom_num, centroid);
+  qcpCenter(movingCoords.data(), atom_num, centroid);
+  return qcpSuperpose(staticCoords.data(), movingCoords.data(), atom_num);
+}
 
-  delete matchedAtoms1;
-  delete matchedAtoms2;
+bool RMSD::positions(Configuration *conf, std::vector<double> &ret) {
+  Molecule *mol = conf->getMolecule();
+  const AtomCorrespondence &matched = getCorrespondence(mol, mol);
+  conf->updateMolecule();
+  gatherPositions(matched.atoms1, ret);
+  return true;
+}
 
-  /// Compute the optimal rotation and translation, returns remaining rmsd
-  double rmsd = kabsch(moving_matrix, static_matrix, rotate, transl);
+double RMSD::distance(const std::vector<double> &p1, const std::vector<double> &p2) {
+  assert(p1.size() == p2.size());
+  int atom_num = p1.size() / 3;
 
-  gsl_matrix_free(moving_matrix);
-  gsl_matrix_free(static_matrix);
-  gsl_matrix_free(rotate);
-  gsl_vector_free(transl);
+  //Centering is done in place, so the stored positions are copied
+  static thread_local std::vector<double> staticCoords, movingCoords;
+  staticCoords.assign(p1.begin(), p1.end());
+  movingCoords.assign(p2.begin(), p2.end());
 
-  return rmsd;
+  double centroid[3];
+  qcpCenter(staticCoords.data(), atom_num, centroid);
+  qcpCenter(movingCoords.data(), atom_num, centroid);
+  return qcpSuperpose(staticCoords.data(), movingCoords.data(), atom_num);
 }
 
 double RMSD::distance_noOptimization(Configuration *c1, Configuration *c2) {
 
-  vector<Atom *> &atomsRMSD1 = m_selection.getSelectedAtoms(c1->getMolecule());
-
-  if (atomsRMSD1.empty()) {
-    cout << "RMSD::distance_noOptimization - Found no atoms to align .. using all" << endl;
-    exit(-1);
-  }
+  const AtomCorrespondence &matched = getCorrespondence(c1->getMolecule(), c2->getMolecule());
+  size_t atom_num = matched.atoms1.size();
 
   vector<Coordinate> p1_atoms;
-  vector<Coordinate> p2_atoms;
-
-  int resId;
-  std::string name;
-  std::string chainName;
-
-  Molecule *p1 = c1->updatedMolecule();
-  for (auto const& aIt : atomsRMSD1) {
-    name = aIt->getName();
-    chainName = aIt->getResidue()->getChain()->getName();
-    resId = aIt->getResidue()->getId();
-    Atom *a2 = c2->getMolecule()->getAtom(chainName, resId, name);
-    if (a2 == nullptr) continue;
+  p1_atoms.reserve(atom_num);
+  c1->updatedMolecule();
+  for (auto const &aIt : matched.atoms1)
     p1_atoms.push_back(aIt->m_position);
-  }
-
-  Molecule *p2 = c2->updatedMolecule();
-  for (auto const &aIt : atomsRMSD1) {
-    name = aIt->getName();
-    chainName = aIt->getResidue()->getChain()->getName();
-    resId = aIt->getResidue()->getId();
-    Atom *a2 = c2->getMolecule()->getAtom(chainName, resId, name);
-    if (a2 == nullptr) continue;
-    p2_atoms.push_back(a2->m_position);
-  }
 
+  c2->updatedMolecule();
   double sum = 0.0;
-  for (int i = 0; i != atomsRMSD1.size(); i++) {
-    sum += p1_atoms[i].distanceSquared(p2_atoms[i]);
+  for (size_t i = 0; i < atom_num; i++) {
+    sum += p1_atoms[i].distanceSquared(matched.atoms2[i]->m_position);
   }
 
-  return sqrt(sum / atomsRMSD1.size());
+  return sqrt(sum / atom_num);
 }
 
 double RMSD::align(Molecule *moving_mol, Molecule *static_mol) {
-  const std::vector<Atom *> &atomsRMSD1 = m_selection.getSelectedAtoms(static_mol);
-
-  Molecule* m1 = static_mol;
-  Molecule* m2 = moving_mol;
-
-  // Build two vectors of atoms where each entry in one has matching chain name, residue id, and atom name in the other
-  std::vector<Atom*> *matchedAtoms1;
-  std::vector<Atom*> *matchedAtoms2;
-  if (m1 == m2){
-    matchedAtoms1 = new std::vector<Atom*>(atomsRMSD1);
-    matchedAtoms2 = new std::vector<Atom*>(atomsRMSD1);
-  }else {
-    matchedAtoms1 = new std::vector<Atom*>();
-    matchedAtoms2 = new std::vector<Atom*>();
-
-    for (auto const &aIt : atomsRMSD1) {
-      const std::string &name = aIt->getName();
-      const std::string &chainName = aIt->getResidue()->getChain()->getName();
-      int resId = aIt->getResidue()->getId();
-      Atom *a1 = &(*aIt);
-      Atom *a2 = m2->getAtom(chainName, resId, name);
-      if (a2 != nullptr) {
-        matchedAtoms1->push_back(a1);
-        matchedAtoms2->push_back(a2);
-      }
-    }
-  }
-
-  if (atomsRMSD1.empty()) {
-    cerr << "RMSD::distance - Atom-selection given to RMSD metric contained no atoms: " << m_selection << endl;
-    exit(-1);
-  }
-
-  int atom_num = matchedAtoms1->size();
+  const AtomCorrespondence &matched = getCorrespondence(static_mol, moving_mol);
+  int atom_num = matched.atoms1.size();
   assert(atom_num > 3);
 
-  gsl_matrix *static_matrix = gsl_matrix_alloc(atom_num, 3);
-  gsl_matrix *moving_matrix = gsl_matrix_alloc(atom_num, 3);
-
-  unsigned int i = 0;
-  for (auto const &aIt : *matchedAtoms1) {
-    const Coordinate &c1 = (*aIt).m_position;
-    gsl_matrix_set(static_matrix, i, 0, c1.x);
-    gsl_matrix_set(static_matrix, i, 1, c1.y);
-    gsl_matrix_set(static_matrix, i, 2, c1.z);
-
-    assert(!std::isnan(c1.x));
-    assert(!std::isnan(c1.y));
-    assert(!std::isnan(c1.z));
-    assert(c1.x < 10000.0);
-    assert(c1.y < 10000.0);
-    assert(c1.z < 10000.0);
-
-    i++;
-  }
-
-  i = 0;
-  for (auto const &aIt: *matchedAtoms2) {
-    const Coordinate &c2 = (*aIt).m_position;
-    gsl_matrix_set(moving_matrix, i, 0, c2.x);
-    gsl_matrix_set(moving_matrix, i, 1, c2.y);
-    gsl_matrix_set(moving_matrix, i, 2, c2.z);
-
-    assert(!std::isnan(c2.x));
-    assert(!std::isnan(c2.y));
-    assert(!std::isnan(c2.z));
-    assert(c2.x < 10000.0);
-    assert(c2.y < 10000.0);
-    assert(c2.z < 10000.0);
-
-    i++;
-  }
-
-  gsl_matrix *rotate = gsl_matrix_alloc(3, 3);
-  gsl_vector *transl = gsl_vector_alloc(3);
-
-  /// Compute the optimal rotation and translation, returns remaining rmsd
-  double rmsd = kabsch(moving_matrix, static_matrix, rotate, transl);
-
-  // Transform position in `moving_mol`
-  gsl_matrix *moving_coords = gsl_matrix_alloc(3, moving_mol->getAtoms().size());
-  gsl_matrix *moving_coords2 = gsl_matrix_alloc(3, moving_mol->getAtoms().size());
-  gsl_matrix_set_zero(moving_coords);
-  gsl_matrix_set_zero(moving_coords2);
+  std::vector<double> staticCoords, movingCoords;
+  gatherPositions(matched.atoms1, staticCoords);
+  gatherPositions(matched.atoms2, movingCoords);
 
-  i = 0;
-  /// First copy the positions
-  for (auto const &aIt : moving_mol->getAtoms()) {
-    Coordinate &pos = aIt->m_position;
-    gsl_matrix_set(moving_coords, 0, i, pos.x);
-    gsl_matrix_set(moving_coords, 1, i, pos.y);
-    gsl_matrix_set(moving_coords, 2, i, pos.z);
-    i++;
-  }
-  /// Do the rotation
-  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, rotate, moving_coords, 0.0, moving_coords2);
-
-  double dx = gsl_vector_get(transl, 0);
-  double dy = gsl_vector_get(transl, 1);
-  double dz = gsl_vector_get(transl, 2);
+  /// Compute the optimal rotation, returns remaining rmsd
+  double cs[3], cm[3], R[9];
+  qcpCenter(staticCoords.data(), atom_num, cs);
+  qcpCenter(movingCoords.data(), atom_num, cm);
+  double rmsd = qcpSuperpose(staticCoords.data(), movingCoords.data(), atom_num, R);
 
   ///Update molecule positions
-  //Overall Px,new = R*(Px,old - cx)+cy = R*Px,old - R*cx + cy = R*Px,old + t
-  i = 0;
+  //Overall Px,new = R*(Px,old - cm)+cs = R*Px,old - R*cm + cs = R*Px,old + t
+  double t[3];
+  for (int r = 0; r < 3; r++)
+    t[r] = cs[r] - (R[3 * r] * cm[0] + R[3 * r + 1] * cm[1] + R[3 * r + 2] * cm[2]);
+
   for (auto const &aIt : moving_mol->getAtoms()) {
     Coordinate &pos = aIt->m_position;
-    Coordinate &refPos = aIt->m_referencePosition;
-    pos.x = gsl_matrix_get(moving_coords2, 0, i) + dx;
-    pos.y = gsl_matrix_get(moving_coords2, 1, i) + dy;
-    pos.z = gsl_matrix_get(moving_coords2, 2, i) + dz;
-    i++;
+    double x = pos.x, y = pos.y, z = pos.z;
+    pos.x = R[0] * x + R[1] * y + R[2] * z + t[0];
+    pos.y = R[3] * x + R[4] * y + R[5] * z + t[1];
+    pos.z = R[6] * x + R[7] * y + R[8] * z + t[2];
   }
 
-  gsl_matrix_free(static_matrix);
-  gsl_matrix_free(moving_matrix);
-  gsl_matrix_free(rotate);
-  gsl_vector_free(transl);
-  gsl_matrix_free(moving_coords);
-  gsl_matrix_free(moving_coords2);
-
   return rmsd;
 }
 
-/* gsl does not provide it */
-static inline void gsl_vector_cross(
-    const gsl_vector *a,
-    const gsl_vector *b,
-    gsl_vector *c
-) {
-  double a0 = gsl_vector_get(a, 0);
-  double a1 = gsl_vector_get(a, 1);
-  double a2 = gsl_vector_get(a, 2);
-  double b0 = gsl_vector_get(b, 0);
-  double b1 = gsl_vector_get(b, 1);
-  double b2 = gsl_vector_get(b, 2);
-  gsl_vector_set(c, 0, a1 * b2 - b1 * a2);
-  gsl_vector_set(c, 1, a2 * b0 - b2 * a0);
-  gsl_vector_set(c, 2, a0 * b1 - b0 * a1);
-}
-
-#define NORM_EPS 0.00000001
-
-
-double RMSD::kabsch(
-    gsl_matrix *X,     /* the points to be moved */
-    gsl_matrix *Y,     /* the points to move to */
-    gsl_matrix *U,     /* the rotation matrix */
-    gsl_vector *t     /* the translation vector */
-) {
-  unsigned int i, j, k;
-  int U_ok = 1;
-  unsigned int size = X->size1;
-  double n = 1.0 / size;
-  gsl_vector *cx = gsl_vector_alloc(3);     /* centroid of X */
-  gsl_vector *cy = gsl_vector_alloc(3);     /* centroid of Y */
-  gsl_matrix *R = gsl_matrix_alloc(3, 3);    /* Kabsch's R */
-  gsl_matrix *RTR = gsl_matrix_alloc(3, 3);  /* R_trans * R (and Kabsch's bk) */
-  gsl_eigen_symmv_workspace *espace = gsl_eigen_symmv_alloc(3);
-  gsl_matrix *evec = gsl_matrix_alloc(3, 3); /* eigenvectors (and Kabsch's ak) */
-  gsl_vector *eval = gsl_vector_alloc(3);   /* vector of eigenvalues */
-  gsl_matrix *Xrot = gsl_matrix_alloc(size,3);     /* the optimized points of X, overlaid on moved X */
-
-  /* compute centroid of X */
-  gsl_vector_set_zero(cx);
-//  gsl_vector *row = gsl_vector_alloc(3);
-  for (i = size; i > 0;) {
-    gsl_vector_const_view row = gsl_matrix_const_row(X, --i);
-    gsl_vector_add(cx, &row.vector);
-//    gsl_matrix_get_row(row,X, --i);
-//    gsl_vector_scale(row,n);
-//    gsl_vector_add(cx, row); //scaling each entry for numerical reasons
-  }
-  gsl_vector_scale(cx, n);
-
-  /* compute centroid of Y */
-  gsl_vector_set_zero(cy);
-  for (i = size; i > 0;) {
-    gsl_vector_const_view row = gsl_matrix_const_row(Y, --i);
-    gsl_vector_add(cy, &row.vector);//scaling each entry for numerical reasons
-//    gsl_matrix_get_row(row,Y, --i);
-//    gsl_vector_scale(row,n);
-//    gsl_vector_add(cy, row); //scaling each entry for numerical reasons
-  }
-  gsl_vector_scale(cy, n);
-
-  /* move X to origin */
-  for (i = size; i > 0;) {
-    gsl_vector_view row = gsl_matrix_row(X, --i);
-    gsl_vector_sub(&row.vector, cx);
-  }
-  /* move Y to origin */
-  for (i = size; i > 0;) {
-    gsl_vector_view row = gsl_matrix_row(Y, --i);
-    gsl_vector_sub(&row.vector, cy);
-  }
-
-  if (size == 1) {
-    /* just one point, so U is trival */
-    gsl_matrix_set_identity(U);
-  } else {
-    /* compute R */
-    gsl_matrix_set_zero(R);
-    for (k = size; k > 0;) {
-      --k;
-      for (i = 3; i > 0;) {
-        --i;
-        for (j = 3; j > 0;) {
-          --j;
-          gsl_matrix_set(R, i, j,
-                         gsl_matrix_get(R, i, j) +
-                         gsl_matrix_get(Y, k, i) * gsl_matrix_get(X, k, j)
-          );
-        }
-      }
-    }
-
-    /* compute RTR = R_trans * R */
-    gsl_matrix_set_zero(RTR);
-    gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, R, R, 0.0, RTR);
-
-    /* compute orthonormal eigenvectors */
-    gsl_eigen_symmv(RTR, eval, evec, espace);  /* RTR will be modified! */
-    gsl_eigen_symmv_sort(eval, evec, GSL_EIGEN_SORT_VAL_DESC);
-    if (gsl_vector_get(eval, 1) > NORM_EPS) {
-      /* compute ak's (as columns of evec) and bk's (as columns of RTR) */
-      double norm_b0, norm_b1, norm_b2;
-      gsl_vector_const_view a0 = gsl_matrix_const_column(evec, 0);
-      gsl_vector_const_view a1 = gsl_matrix_const_column(evec, 1);
-      gsl_vector_view a2 = gsl_matrix_column(evec, 2);
-      gsl_vector_view b0 = gsl_matrix_column(RTR, 0);
-      gsl_vector_view b1 = gsl_matrix_column(RTR, 1);
-      gsl_vector_view b2 = gsl_matrix_column(RTR, 2);
-      gsl_vector_cross(&a0.vector, &a1.vector, &a2.vector); /* a2 = a0 x a1 */
-      gsl_blas_dgemv(CblasNoTrans, 1.0, R, &a0.vector, 0.0, &b0.vector);
-      norm_b0 = gsl_blas_dnrm2(&b0.vector);
-      gsl_blas_dgemv(CblasNoTrans, 1.0, R, &a1.vector, 0.0, &b1.vector);
-      norm_b1 = gsl_blas_dnrm2(&b1.vector);
-      if (norm_b0 > NORM_EPS && norm_b1 > NORM_EPS) {
-        gsl_vector_scale(&b0.vector, 1.0 / norm_b0);         /* b0 = ||R * a0|| */
-        gsl_vector_scale(&b1.vector, 1.0 / norm_b1);         /* b1 = ||R * a1|| */
-        gsl_vector_cross(&b0.vector, &b1.vector, &b2.vector);  /* b2 = b0 x b1 */
-
-        norm_b2 = gsl_blas_dnrm2(&b2.vector);
-        if (norm_b2 > NORM_EPS) {
-          /* we reach this point only if all bk different from 0 */
-          /* compute U = B * A_trans (use RTR as B and evec as A) */
-          gsl_matrix_set_zero(U); /* to avoid nan */
-          gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1.0, RTR, evec, 0.0, U);
-        } else {
-          U_ok = 0;
-          gsl_matrix_set_identity(U);
-        }
-      } else {
-        U_ok = 0;
-        gsl_matrix_set_identity(U);
-      }
-    } else {
-      U_ok = 0;
-      gsl_matrix_set_identity(U);
-    }
-  }
-
-  /* compute t = cy - U * cx  */
-  gsl_vector_memcpy(t, cy);
-  gsl_blas_dgemv(CblasNoTrans, -1.0, U, cx, 1.0, t);
-
-  /* compute the rmsd (cheapest at this point) */
-  gsl_blas_dgemm(CblasNoTrans,CblasTrans,1.0,X,U,0.0,Xrot);
-  double rmsd = alignedrmsd(Y,Xrot,size);
-
-  gsl_vector_free(eval);
-  gsl_matrix_free(evec);
-  gsl_eigen_symmv_free(espace);
-  gsl_matrix_free(RTR);
-  gsl_matrix_free(R);
-  gsl_vector_free(cy);
-  gsl_vector_free(cx);
-  gsl_matrix_free(Xrot);
-
-  if(U_ok == 1)
-    return rmsd;
-  else
-    return -1.0;
-}
-
-/*
-   calculate rmsd between two aligned structures (trivial)
-Params: mat1 - first structure
-mat2 - second structure
-N - number of points
-Returns: rmsd
-*/
-double RMSD::alignedrmsd(gsl_matrix *mat1, gsl_matrix *mat2, int N)
-{
-  double answer =0.0;
-  int i,j;
-  for(i=0;i<N;i++) {
-      answer += (gsl_matrix_get(mat1,i,0)-gsl_matrix_get(mat2,i,0))*(gsl_matrix_get(mat1,i,0)-gsl_matrix_get(mat2,i,0))
-                + (gsl_matrix_get(mat1,i,1)-gsl_matrix_get(mat2,i,1))*(gsl_matrix_get(mat1,i,1)-gsl_matrix_get(mat2,i,1))
-                + (gsl_matrix_get(mat1,i,2)-gsl_matrix_get(mat2,i,2))*(gsl_matrix_get(mat1,i,2)-gsl_matrix_get(mat2,i,2));
-  }
-  return sqrt(answer/N);
-}
-
-
 //double rmsd(double *v1, double *v2, int N, double *mtx) {
 //  double cent1[3];
 //  double cent2[3];
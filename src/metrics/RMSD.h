@@ -35,7 +35,12 @@ IN THE SOFTWARE.
 #include <assert.h>
 #include <iostream>
 #include <string>
+#include <atomic>
 #include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "Metric.h"
 #include "core/Configuration.h"
@@ -44,24 +49,49 @@ IN THE SOFTWARE.
 namespace metrics{
 
 
+/**
+ * Root mean square deviation of the selected atoms after optimal superposition. Configurations of different
+ * molecules are compared on the atoms with matching chain, residue id and name. Superposition uses the
+ * QCP method (see math/QCP.h).
+ */
 class RMSD: public Metric{
  public:
   RMSD(Selection& selection);
+  ~RMSD();
 
   double distance(Configuration*, Configuration*);
+  bool positions(Configuration* conf, std::vector<double>& ret) override;
+  double distance(const std::vector<double>& p1, const std::vector<double>& p2) override;
   double distance_noOptimization(Configuration *c1, Configuration *c2);
 
   double align(Molecule * other, Molecule * base);
 
  private:
-	double kabsch(
-			gsl_matrix *X,     /* the points to be moved */
-			gsl_matrix *Y,     /* the points to move to */
-			gsl_matrix *U,     /* the rotation matrix */
-			gsl_vector *t      /* the translation vector */
-	) ; // /* returns the rmsd between the optimized vector sets */
-
-  double alignedrmsd(gsl_matrix *mat1, gsl_matrix *mat2, int N);
+  /** Selected atoms of one molecule paired with the atoms of the same chain, residue id and name in another */
+  struct AtomCorrespondence {
+    std::vector<Atom*> atoms1;
+    std::vector<Atom*> atoms2;
+    size_t numAtoms1;         ///< Atom counts of the molecules when matched, used to detect changed atom sets
+    size_t numAtoms2;
+  };
+
+  /**
+   * Matched atoms of the selection in m1 and m2. Computed on the first call for a pair of molecules and
+   * recomputed if the number of atoms of either molecule changes. Safe to call from several threads: the
+   * last pair looked up by a thread is kept per thread, so repeated calls (e.g. with m1==m2 while sampling)
+   * don't lock. The reference is valid until the next call on the same thread.
+   */
+  const AtomCorrespondence& getCorrespondence(Molecule* m1, Molecule* m2);
+
+  /** Drop the correspondences of a destroyed molecule */
+  void removeMolecule(unsigned long moleculeId);
+
+  /** Keyed by the unique ids (Molecule::getUniqueId) of both molecules */
+  std::map<std::pair<unsigned long, unsigned long>, std::shared_ptr<const AtomCorrespondence> > m_correspondences;
+  std::mutex m_correspondenceMutex;
+  int m_destructionListener;                  ///< Handle from Molecule::addDestructionListener
+  const unsigned long m_instanceId;           ///< Validates the per-thread lookup cache
+  static std::atomic<unsigned long> m_nextInstanceId;
 };
 
 typedef struct
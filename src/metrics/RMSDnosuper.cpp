@@ -70,4 +70,27 @@ double RMSDnosuper::distance( Configuration *c1, Configuration *c2 ) {
   return sqrt(sum/numAtoms);
 }
 
+bool RMSDnosuper::positions( Configuration *conf, std::vector<double>& ret ) {
+  const std::vector<Atom*>& atoms = m_selection.getSelectedAtoms(conf->getMolecule());
+  conf->updateMolecule();
+  ret.resize(3*atoms.size());
+  double* p = ret.data();
+  for( auto const &a : atoms ) {
+    *p++ = a->m_position.x;
+    *p++ = a->m_position.y;
+    *p++ = a->m_position.z;
+  }
+  return true;
+}
+
+double RMSDnosuper::distance( const std::vector<double>& p1, const std::vector<double>& p2 ) {
+  assert(p1.size()==p2.size());
+  double sum = 0;
+  for( size_t i=0; i < p1.size(); i++ ) {
+    double d = p1[i]-p2[i];
+    sum += d*d;
+  }
+  return sqrt(sum/(p1.size()/3));
+}
+
 }
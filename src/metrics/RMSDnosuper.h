@@ -49,6 +49,8 @@ class RMSDnosuper: public Metric{
   RMSDnosuper(Selection& selection);
 
   double distance(Configuration*, Configuration*);
+  bool positions(Configuration* conf, std::vector<double>& ret) override;
+  double distance(const std::vector<double>& p1, const std::vector<double>& p2) override;
 
 };
 
@@ -0,0 +1,275 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#include "VPTree.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace metrics {
+
+VPTree::VPTree(Metric *metric, size_t leafSize) :
+    m_metric(metric),
+    m_leafSize(std::max(leafSize, (size_t) 2)),
+    m_size(0),
+    m_numVantages(0),
+    m_numRemoved(0)
+{
+  m_root = newLeaf();
+  m_distance = [this](Configuration *c1, Configuration *c2) { return m_metric->distance(c1, c2); };
+}
+
+VPTree::~VPTree() {
+  deleteNode(m_root);
+}
+
+VPTree::Node *VPTree::newLeaf() {
+  Node *node = new Node();
+  node->vantage = nullptr;
+  node->removed = false;
+  node->radius = 0.0;
+  node->inside = nullptr;
+  node->outside = nullptr;
+  node->splitSize = m_leafSize;
+  return node;
+}
+
+void VPTree::deleteNode(Node *node) {
+  if (node == nullptr) return;
+  deleteNode(node->inside);
+  deleteNode(node->outside);
+  delete node;
+}
+
+void VPTree::insert(Configuration *conf) {
+  if (m_location.count(conf) > 0) return;
+
+  Node *node = m_root;
+  while (node->vantage != nullptr) {
+    double d = m_distance(node->vantage, conf);
+    node = d < node->radius ? node->inside : node->outside;
+  }
+  node->bucket.push_back(conf);
+  m_location[conf] = node;
+  m_size++;
+
+  if (node->bucket.size() > node->splitSize)
+    split(node);
+}
+
+void VPTree::split(Node *leaf) {
+  Configuration *vantage = leaf->bucket.front();
+  std::vector<std::pair<double, Configuration *> > dists;
+  for (size_t i = 1; i < leaf->bucket.size(); i++)
+    dists.push_back(std::make_pair(m_distance(vantage, leaf->bucket[i]), leaf->bucket[i]));
+  std::stable_sort(dists.begin(), dists.end(),
+                   [](const std::pair<double, Configuration *> &a, const std::pair<double, Configuration *> &b) {
+                     return a.first < b.first;
+                   });
+
+  //All at the same distance (e.g. identical configurations): splitting wouldn't separate anything. Retry
+  //with another vantage candidate once the bucket has doubled, so failed splits cost O(1) per insert.
+  if (dists.front().first == dists.back().first) {
+    leaf->splitSize = 2 * leaf->bucket.size();
+    std::rotate(leaf->bucket.begin(), leaf->bucket.begin() + 1, leaf->bucket.end());
+    return;
+  }
+
+  //Median, but keep the inside non-empty when many configurations tie with the closest one
+  double radius = dists[dists.size() / 2].first;
+  if (radius == dists.front().first) {
+    for (auto const &p: dists) {
+      if (p.first > radius) {
+        radius = p.first;
+        break;
+      }
+    }
+  }
+
+  leaf->vantage = vantage;
+  leaf->removed = false;
+  leaf->radius = radius;
+  leaf->inside = newLeaf();
+  leaf->outside = newLeaf();
+  leaf->bucket.clear();
+  m_location[vantage] = leaf;
+  m_numVantages++;
+
+  for (auto const &p: dists) {
+    Node *child = p.first < radius ? leaf->inside : leaf->outside;
+    child->bucket.push_back(p.second);
+    m_location[p.second] = child;
+  }
+}
+
+bool VPTree::remove(Configuration *conf) {
+  auto it = m_location.find(conf);
+  if (it == m_location.end()) return false;
+
+  Node *node = it->second;
+  m_location.erase(it);
+  m_size--;
+
+  if (node->vantage == conf) {
+    node->removed = true;
+    m_numRemoved++;
+    if (2 * m_numRemoved > m_numVantages)
+      rebuild();
+  } else {
+    node->bucket.erase(std::find(node->bucket.begin(), node->bucket.end(), conf));
+  }
+  return true;
+}
+
+void VPTree::clear() {
+  deleteNode(m_root);
+  m_root = newLeaf();
+  m_location.clear();
+  m_size = 0;
+  m_numVantages = 0;
+  m_numRemoved = 0;
+}
+
+void VPTree::collect(const Node *node, std::vector<Configuration *> &ret) const {
+  if (node == nullptr) return;
+  if (node->vantage != nullptr && !node->removed)
+    ret.push_back(node->vantage);
+  ret.insert(ret.end(), node->bucket.begin(), node->bucket.end());
+  collect(node->inside, ret);
+  collect(node->outside, ret);
+}
+
+void VPTree::rebuild() {
+  std::vector<Configuration *> live;
+  collect(m_root, live);
+  clear();
+  for (auto const &conf: live)
+    insert(conf);
+}
+
+size_t VPTree::size() const {
+  return m_size;
+}
+
+bool VPTree::empty() const {
+  return m_size == 0;
+}
+
+Configuration *VPTree::nearest(Configuration *query, double *dist) const {
+  return nearest(query, m_distance, dist);
+}
+
+Configuration *VPTree::nearest(Configuration *query, const DistanceFunction &distance, double *dist) const {
+  Configuration *best = nullptr;
+  double bestDist = std::numeric_limits<double>::infinity();
+  nearest(m_root, query, distance, best, bestDist);
+  if (dist != nullptr) *dist = bestDist;
+  return best;
+}
+
+void VPTree::nearest(const Node *node, Configuration *query, const DistanceFunction &distance,
+                     Configuration *&best, double &bestDist) const {
+  if (node->vantage == nullptr) {
+    for (auto const &conf: node->bucket) {
+      double d = distance(conf, query);
+      if (d < bestDist) {
+        bestDist = d;
+        best = conf;
+      }
+    }
+    return;
+  }
+
+  double d = distance(node->vantage, query);
+  if (!node->removed && d < bestDist) {
+    bestDist = d;
+    best = node->vantage;
+  }
+
+  //Visit the side containing the query first, the other only if the ball around the query crosses the radius
+  if (d < node->radius) {
+    nearest(node->inside, query, distance, best, bestDist);
+    if (d + bestDist >= node->radius)
+      nearest(node->outside, query, distance, best, bestDist);
+  } else {
+    nearest(node->outside, query, distance, best, bestDist);
+    if (d - bestDist < node->radius)
+      nearest(node->inside, query, distance, best, bestDist);
+  }
+}
+
+void VPTree::withinRadius(Configuration *query, double radius, std::vector<Configuration *> &ret) const {
+  withinRadius(m_root, query, radius, m_distance, &ret);
+}
+
+void VPTree::withinRadius(Configuration *query, double radius, const DistanceFunction &distance,
+                          std::vector<Configuration *> &ret) const {
+  withinRadius(m_root, query, radius, distance, &ret);
+}
+
+bool VPTree::anyWithin(Configuration *query, double radius) const {
+  return withinRadius(m_root, query, radius, m_distance, nullptr);
+}
+
+bool VPTree::anyWithin(Configuration *query, double radius, const DistanceFunction &distance) const {
+  return withinRadius(m_root, query, radius, distance, nullptr);
+}
+
+/** Collects matches in `ret`. If `ret` is nullptr returns as soon as one is found. */
+bool VPTree::withinRadius(const Node *node, Configuration *query, double radius, const DistanceFunction &distance,
+                          std::vector<Configuration *> *ret) const {
+  bool found = false;
+  if (node->vantage == nullptr) {
+    for (auto const &conf: node->bucket) {
+      if (distance(conf, query) <= radius) {
+        if (ret == nullptr) return true;
+        ret->push_back(conf);
+        found = true;
+      }
+    }
+    return found;
+  }
+
+  double d = distance(node->vantage, query);
+  if (!node->removed && d <= radius) {
+    if (ret == nullptr) return true;
+    ret->push_back(node->vantage);
+    found = true;
+  }
+  if (d - radius < node->radius && withinRadius(node->inside, query, radius, distance, ret)) {
+    if (ret == nullptr) return true;
+    found = true;
+  }
+  if (d + radius >= node->radius && withinRadius(node->outside, query, radius, distance, ret)) {
+    if (ret == nullptr) return true;
+    found = true;
+  }
+  return found;
+}
+
+}
@@ -0,0 +1,123 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#ifndef VPTREE_H_
+#define VPTREE_H_
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "Metric.h"
+#include "core/Configuration.h"
+
+namespace metrics {
+
+/**
+ * Vantage-point tree over configurations for nearest-neighbour and radius queries under a Metric.
+ *
+ * Each inner node stores a vantage configuration and the median distance `radius` of the configurations
+ * below it. Configurations closer than `radius` go to the inside child, the rest to the outside child.
+ * Queries skip subtrees using the triangle inequality, which holds for RMSD (with or without superposition)
+ * and for the dihedral metric, so results are exact.
+ *
+ * The tree grows by insertion: configurations are added to leaf buckets which split once they hold more
+ * than `leafSize` configurations. If a split can't separate the bucket (all configurations are equally far
+ * from the vantage candidate, e.g. duplicates) the next attempt waits until the bucket has doubled.
+ * Removed vantage points stay in the tree for routing and the tree is rebuilt when more than half of its
+ * vantage points are removed.
+ *
+ * Distances are always evaluated as distance(treeConfiguration, query). Queries may pass their own
+ * distance function, e.g. to evaluate distances on a per-thread copy of the molecule. Concurrent
+ * queries are safe as long as no configurations are inserted or removed meanwhile.
+ */
+class VPTree {
+ public:
+  typedef std::function<double(Configuration *, Configuration *)> DistanceFunction;
+
+  VPTree(Metric *metric, size_t leafSize = 8);
+  ~VPTree();
+
+  void insert(Configuration *conf);
+
+  /** Remove `conf` from the tree. Returns false if it was not in the tree. */
+  bool remove(Configuration *conf);
+
+  void clear();
+
+  size_t size() const;
+  bool empty() const;
+
+  /** Closest configuration to `query` or nullptr if the tree is empty. Its distance is stored in `dist` if given. */
+  Configuration *nearest(Configuration *query, double *dist = nullptr) const;
+  Configuration *nearest(Configuration *query, const DistanceFunction &distance, double *dist = nullptr) const;
+
+  /** Append all configurations within `radius` of `query` to `ret` */
+  void withinRadius(Configuration *query, double radius, std::vector<Configuration *> &ret) const;
+  void withinRadius(Configuration *query, double radius, const DistanceFunction &distance,
+                    std::vector<Configuration *> &ret) const;
+
+  /** True if some configuration lies within `radius` of `query`. Stops at the first one found. */
+  bool anyWithin(Configuration *query, double radius) const;
+  bool anyWithin(Configuration *query, double radius, const DistanceFunction &distance) const;
+
+ private:
+  struct Node {
+    Configuration *vantage;                 ///< nullptr for leaves
+    bool removed;                           ///< Vantage was removed but still routes queries
+    double radius;                          ///< Median distance from vantage to configurations below
+    Node *inside;
+    Node *outside;
+    std::vector<Configuration *> bucket;    ///< Configurations of a leaf
+    size_t splitSize;                       ///< Bucket size above which a leaf is split, raised when a split fails
+  };
+
+  Node *newLeaf();
+  void deleteNode(Node *node);
+  void split(Node *leaf);
+  void rebuild();
+  void collect(const Node *node, std::vector<Configuration *> &ret) const;
+
+  void nearest(const Node *node, Configuration *query, const DistanceFunction &distance,
+               Configuration *&best, double &bestDist) const;
+  bool withinRadius(const Node *node, Configuration *query, double radius, const DistanceFunction &distance,
+                    std::vector<Configuration *> *ret) const;
+
+  Metric *m_metric;
+  size_t m_leafSize;
+  Node *m_root;
+  size_t m_size;
+  size_t m_numVantages;
+  size_t m_numRemoved;
+  std::unordered_map<Configuration *, Node *> m_location;  ///< Node holding each configuration
+  DistanceFunction m_distance;                             ///< Distance with m_metric
+};
+
+}
+
+#endif
@@ -67,8 +67,9 @@ Configuration* ClashAvoidingMove::performMove(Configuration* current, gsl_vector
 //  log("planner") << "Norm of gradient: " << currNorm << endl;
 
   // Project the gradient onto the null space of current
-  gsl_vector *projected_gradient = gsl_vector_calloc(protein->totalDofNum());
-  current->projectOnCycleNullSpace(gradient, projected_gradient);
+  gsl_vector_view projected_gradient_view = m_workspace.vector(ProjectionWorkspace::USER, protein->totalDofNum());
+  gsl_vector *projected_gradient = &projected_gradient_view.vector;
+  current->projectOnCycleNullSpace(gradient, projected_gradient, m_workspace);
 
   //clash prevention technique
   bool usedClashJacobian = false;
@@ -114,11 +115,11 @@ Configuration* ClashAvoidingMove::performMove(Configuration* current, gsl_vector
         usedClashJacobian = true; //flag to recompute Jacobian
       }
 
+      //The clash constraints grow with every rejected trial, so their nullspace is decomposed per trial
       gsl_matrix* clashAvoidingJacobian = computeClashAvoidingJacobian( current, allCollisions);
-      SVD* clashAvoidingSVD  = new SVDMKL(clashAvoidingJacobian);
-      Nullspace* clashAvoidingNullSpace = new NullspaceSVD(clashAvoidingSVD);
+      Nullspace* clashAvoidingNullSpace = Nullspace::create(clashAvoidingJacobian);
       clashAvoidingNullSpace->updateFromMatrix();
-      clashAvoidingNullSpace->projectOnNullSpace(gradient, projected_gradient);
+      clashAvoidingNullSpace->projectOnNullSpace(gradient, projected_gradient, m_workspace);
 
       if(!m_scale) {//If no scaling, keep the same length as before! (this is for Poisson-Sampler)
         double normAfter = gsl_vector_length(projected_gradient);
@@ -133,7 +134,6 @@ Configuration* ClashAvoidingMove::performMove(Configuration* current, gsl_vector
 //      log("planner")<<"New nullspace dimension: "<< clashAvoidingNullSpace->getNullspaceSize()<<endl;
 
       delete clashAvoidingNullSpace;
-      delete clashAvoidingSVD;
       gsl_matrix_free(clashAvoidingJacobian);
 
       previousCollisions=allCollisions; //save collisions in case the new one is rejected again
@@ -147,13 +147,10 @@ Configuration* ClashAvoidingMove::performMove(Configuration* current, gsl_vector
 //      new_q->m_vdwEnergy = enthalpyVals.first;
 //      new_q->m_deltaH = enthalpyVals.second - new_q->m_vdwEnergy;
 
-      gsl_vector_free(projected_gradient);
       return new_q;
     }
   }//end steps
 
-  gsl_vector_free(projected_gradient);
-
   return new_q;
 }
 
@@ -213,9 +210,8 @@ gsl_matrix* ClashAvoidingMove::computeClashAvoidingJacobian(Configuration* conf,
     KinVertex* common_ancestor = conf->getMolecule()->m_spanningTree->findCommonAncestor(vertex1, vertex2);
 
     // trace back until the common ancestor from vertex1
-    while ( vertex1 != common_ancestor ) {
-      KinVertex* parent = vertex1->m_parent;
-      KinEdge* p_edge = parent->findEdge(vertex1);
+    for ( ; vertex1 != common_ancestor; vertex1 = vertex1->m_parent ) {
+      KinEdge* p_edge = vertex1->m_parentEdge;
 
       int dof_id = p_edge->getDOF()->getIndex();
       if (dof_id!=-1) { // this edge is a DOF
@@ -233,13 +229,11 @@ gsl_matrix* ClashAvoidingMove::computeClashAvoidingJacobian(Configuration* conf,
 //				Atom* atom = (*ait);
 //				atom->m_assignedBiggerRB_id = consCounter;
 //			}
-      vertex1 = parent;
     }
 
     // trace back until the common ancestor from vertex2
-    while ( vertex2 != common_ancestor ) {
-      KinVertex* parent = vertex2->m_parent;
-      KinEdge* p_edge = parent->findEdge(vertex2);
+    for ( ; vertex2 != common_ancestor; vertex2 = vertex2->m_parent ) {
+      KinEdge* p_edge = vertex2->m_parentEdge;
 
       int dof_id = p_edge->getDOF()->getIndex();
       if (dof_id!=-1) { // this edge is a DOF
@@ -254,8 +248,6 @@ gsl_matrix* ClashAvoidingMove::computeClashAvoidingJacobian(Configuration* conf,
 
         gsl_matrix_set(ret,i,dof_id,jacobianEntryClash); //set: Matrix, row, column, what to set
       }
-
-      vertex2 = parent;
     }
     ++i;
   }
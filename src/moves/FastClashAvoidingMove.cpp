@@ -64,8 +64,9 @@ Configuration* FastClashAvoidingMove::performMove(Configuration* current, gsl_ve
 //  log("planner") << "Norm of gradient: " << currNorm << endl;
 
   // Project the gradient onto the null space of current
-  gsl_vector *projected_gradient = gsl_vector_calloc(current->getNumDOFs());
-  current->projectOnCycleNullSpace(gradient, projected_gradient);
+  gsl_vector_view projected_gradient_view = m_workspace.vector(ProjectionWorkspace::USER, current->getNumDOFs());
+  gsl_vector *projected_gradient = &projected_gradient_view.vector;
+  current->projectOnCycleNullSpace(gradient, projected_gradient, m_workspace);
 
   double currProjNorm = gsl_vector_length(projected_gradient);
 //  log("planner") << "Norm of projected gradient: " << currProjNorm << endl;
@@ -76,7 +77,6 @@ Configuration* FastClashAvoidingMove::performMove(Configuration* current, gsl_ve
   Configuration *new_q = new Configuration(current);
   for (int i = 0; i < new_q->getNumDOFs(); ++i)
     new_q->m_dofs[i] = formatRangeRadian( current->m_dofs[i] + gsl_vector_get(projected_gradient, i) );
-  gsl_vector_free(projected_gradient);
 
   //If no clash return
   if (!new_q->updatedMolecule()->inCollision()) {
@@ -151,25 +151,17 @@ map<int,int> FastClashAvoidingMove::collectConstrainedDofMap(Configuration* conf
     KinVertex *common_ancestor = conf->getMolecule()->m_spanningTree->findCommonAncestor(vertex1, vertex2);
 
     // trace back until the common ancestor from vertex1
-    while (vertex1 != common_ancestor) {
-      KinEdge* p_edge = vertex1->m_parent->findEdge(vertex1);
-
-      int dof_id = p_edge->getDOF()->getIndex();
+    for ( ; vertex1 != common_ancestor; vertex1 = vertex1->m_parent ) {
+      int dof_id = vertex1->m_parentEdge->getDOF()->getIndex();
       if(ret.count(dof_id)==0)
         ret[dof_id] = nextidx++;
-
-      vertex1 = vertex1->m_parent;
     }
 
     // trace back until the common ancestor from vertex2
-    while (vertex2 != common_ancestor) {
-      KinEdge* p_edge = vertex2->m_parent->findEdge(vertex2);
-
-      int dof_id = p_edge->getDOF()->getIndex();
+    for ( ; vertex2 != common_ancestor; vertex2 = vertex2->m_parent ) {
+      int dof_id = vertex2->m_parentEdge->getDOF()->getIndex();
       if(ret.count(dof_id)==0)
         ret[dof_id] = nextidx++;
-
-      vertex2 = vertex2->m_parent;
     }
   }
   return std::move(ret);
@@ -196,13 +188,12 @@ Configuration* FastClashAvoidingMove::projectOnClashNullspace(
   //Compute clash-avoiding jacobian, svd, and nullspace
   //Todo: This could be optimized, we only have to compute the Jacobian the first time...
   gsl_matrix* clashJac = computeClashAvoidingJacobian(conf, constrainedDofMap, collisions);
-  SVD* clashSVD = SVD::createSVD(clashJac);//new SVDMKL(clashAvoidingJacobian);
-  Nullspace* clashNullSpace = new NullspaceSVD(clashSVD);
+  Nullspace* clashNullSpace = Nullspace::create(clashJac);
   clashNullSpace->updateFromMatrix();
 
   //Project reducedGradient
   double normBefore = gsl_vector_length(reducedGradient);
-  clashNullSpace->projectOnNullSpace(reducedGradient, reducedGradient);
+  clashNullSpace->projectOnNullSpace(reducedGradient, reducedGradient, m_workspace);
   double normAfter = gsl_vector_length(reducedGradient);
 
   //If no m_scaling by maxRotation, keep the same length as before! (this is for Poisson-Sampler)
@@ -237,7 +228,6 @@ Configuration* FastClashAvoidingMove::projectOnClashNullspace(
 
   //Clean up
   delete clashNullSpace;
-  delete clashSVD;
 
   return new_q;
 }
@@ -306,9 +296,8 @@ gsl_matrix* FastClashAvoidingMove::computeClashAvoidingJacobian(
     KinVertex* common_ancestor = conf->getMolecule()->m_spanningTree->findCommonAncestor(vertex1, vertex2);
 
     // trace back until the common ancestor from vertex1
-    while ( vertex1 != common_ancestor ) {
-      KinVertex* parent = vertex1->m_parent;
-      KinEdge* p_edge = parent->findEdge(vertex1);
+    for ( ; vertex1 != common_ancestor; vertex1 = vertex1->m_parent ) {
+      KinEdge* p_edge = vertex1->m_parentEdge;
 
       //Locate constrained dof id
       int dof_id = p_edge->getDOF()->getIndex();
@@ -318,14 +307,11 @@ gsl_matrix* FastClashAvoidingMove::computeClashAvoidingJacobian(
       double jacobianEntryClash = dot(clashNormal, derivativeP1);
 
       gsl_matrix_set(ret,r,constrained_dof_id,jacobianEntryClash); //set: Matrix, row, column, what to set
-
-      vertex1 = parent;
     }
 
     // trace back until the common ancestor from vertex2
-    while ( vertex2 != common_ancestor ) {
-      KinVertex* parent = vertex2->m_parent;
-      KinEdge* p_edge = parent->findEdge(vertex2);
+    for ( ; vertex2 != common_ancestor; vertex2 = vertex2->m_parent ) {
+      KinEdge* p_edge = vertex2->m_parentEdge;
 
       int dof_id = p_edge->getDOF()->getIndex();
       int constrained_dof_id = dofMap[dof_id];
@@ -335,8 +321,6 @@ gsl_matrix* FastClashAvoidingMove::computeClashAvoidingJacobian(
       double jacobianEntryClash = - dot(clashNormal, derivativeP2);
 
       gsl_matrix_set(ret,r,constrained_dof_id,jacobianEntryClash); //set: Matrix, row, column, what to set
-
-      vertex2 = parent;
     }
 
     r++; //Next collision
@@ -109,8 +109,7 @@ Configuration* LSNclashAvoidingMove::performMove(Configuration* current, gsl_vec
       }
 
       gsl_matrix* clashAvoidingJacobian = computeClashAvoidingJacobian( current, allCollisions);
-      SVD* clashAvoidingSVD  = new SVDMKL(clashAvoidingJacobian);
-      Nullspace* clashAvoidingNullSpace = new NullspaceSVD(clashAvoidingSVD);
+      Nullspace* clashAvoidingNullSpace = Nullspace::create(clashAvoidingJacobian);
       clashAvoidingNullSpace->updateFromMatrix();
       ///Computing a new Least-Square solution with the new clash-free nullspace
       m_direction->computeGradientExternalN(clashAvoidingNullSpace->getBasis(), current, nullptr, projected_gradient);
@@ -123,7 +122,6 @@ Configuration* LSNclashAvoidingMove::performMove(Configuration* current, gsl_vec
       new_q->m_clashFreeDofs = clashAvoidingNullSpace->getNullspaceSize();
 
       delete clashAvoidingNullSpace;
-      delete clashAvoidingSVD;
       gsl_matrix_free(clashAvoidingJacobian);
 
       previousCollisions=allCollisions; //save collisions in case the new one is rejected again
@@ -193,9 +191,8 @@ gsl_matrix* LSNclashAvoidingMove::computeClashAvoidingJacobian(Configuration* co
     KinVertex *common_ancestor = conf->getMolecule()->m_spanningTree->findCommonAncestor(vertex1, vertex2);
 
     // trace back until the common ancestor from vertex1
-    while (vertex1 != common_ancestor) {
-      KinVertex *parent = vertex1->m_parent;
-      KinEdge *p_edge = parent->findEdge(vertex1);
+    for ( ; vertex1 != common_ancestor; vertex1 = vertex1->m_parent ) {
+      KinEdge* p_edge = vertex1->m_parentEdge;
 
       int dof_id = p_edge->getDOF()->getIndex();
       if (dof_id != -1) { // this edge is a DOF
@@ -213,13 +210,11 @@ gsl_matrix* LSNclashAvoidingMove::computeClashAvoidingJacobian(Configuration* co
 //				Atom* atom = (*ait);
 //				atom->m_assignedBiggerRB_id = consCounter;
 //			}
-      vertex1 = parent;
     }
 
     // trace back until the common ancestor from vertex2
-    while (vertex2 != common_ancestor) {
-      KinVertex *parent = vertex2->m_parent;
-      KinEdge *p_edge = parent->findEdge(vertex2);
+    for ( ; vertex2 != common_ancestor; vertex2 = vertex2->m_parent ) {
+      KinEdge* p_edge = vertex2->m_parentEdge;
 
       int dof_id = p_edge->getDOF()->getIndex();
       if (dof_id != -1) { // this edge is a DOF
@@ -234,8 +229,6 @@ gsl_matrix* LSNclashAvoidingMove::computeClashAvoidingJacobian(Configuration* co
 
         gsl_matrix_set(ret, i, dof_id, jacobianEntryClash); //set: Matrix, row, column, what to set
       }
-
-      vertex2 = parent;
     }
     ++i;
   }
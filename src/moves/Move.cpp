@@ -31,12 +31,18 @@ IN THE SOFTWARE.
 #include <cassert>
 #include "Logger.h"
 
+thread_local ProjectionWorkspace Move::m_workspace;
+
 Move::Move():
+    m_movesRejected(0),
+    m_movesAccepted(0),
     m_maxRotation(3.1415/18),//overwrite with getter/setter
     m_scale(false) // by default scaling is disabled
 {}
 
 Move::Move(double maxRotation):
+    m_movesRejected(0),
+    m_movesAccepted(0),
     m_maxRotation(maxRotation),//overwrite with getter/setter
     m_scale(true) // by default scaling is enabled, disable via setter if not desired
 {}
@@ -28,7 +28,10 @@ IN THE SOFTWARE.
 #ifndef MOVE_H_
 #define MOVE_H_
 
+#include <atomic>
+
 #include "core/Configuration.h"
+#include "math/ProjectionWorkspace.h"
 
 class Move{
  public:
@@ -57,10 +60,11 @@ class Move{
 
   virtual Configuration* performMove(Configuration* current, gsl_vector* gradient) = 0;
 
-  int m_movesRejected;
-  int m_movesAccepted;
+  std::atomic<int> m_movesRejected;   ///< Atomic as planners may perform moves from several threads
+  std::atomic<int> m_movesAccepted;
   double m_maxRotation;
   bool m_scale;
+  static thread_local ProjectionWorkspace m_workspace; ///< Buffers for gradient projections, reused across moves of a thread
 };
 
 #endif
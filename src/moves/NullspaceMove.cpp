@@ -43,8 +43,9 @@ Configuration* NullspaceMove::performMove(Configuration* current, gsl_vector* gr
   log("planner") << "Norm of gradient: " << currNorm << endl;
 
   // Project the gradient onto the null space of current
-  gsl_vector *projected_gradient = gsl_vector_calloc(current->getNumDOFs());
-  current->projectOnCycleNullSpace(gradient, projected_gradient);
+  gsl_vector_view projected_gradient_view = m_workspace.vector(ProjectionWorkspace::USER, current->getNumDOFs());
+  gsl_vector *projected_gradient = &projected_gradient_view.vector;
+  current->projectOnCycleNullSpace(gradient, projected_gradient, m_workspace);
 
 //  double currProjNorm = gsl_vector_length(projected_gradient);
 //  log("planner") << "Norm of projected gradient: " << currProjNorm << endl;
@@ -56,7 +57,6 @@ Configuration* NullspaceMove::performMove(Configuration* current, gsl_vector* gr
   Configuration *new_q = new Configuration(current);
   for (int i = 0; i < new_q->getNumDOFs(); ++i)
     new_q->m_dofs[i] = formatRangeRadian(current->m_dofs[i] + gsl_vector_get(projected_gradient, i));
-  gsl_vector_free(projected_gradient);
 
   return new_q;
 }
@@ -41,6 +41,9 @@ IN THE SOFTWARE.
 #include "metrics/Dihedral.h"
 
 #include "IO.h"
+#include "ThreadPool.h"
+#include "planners/PlannerCheckpoint.h"
+#include "core/KinematicWorkspace.h"
 #include "directions/BlendedDirection.h"
 #include "math/gsl_helpers.h"
 
@@ -76,7 +79,14 @@ BidirectionalMovingFront::BidirectionalMovingFront(
     m_switchAfter(switchAfter),
     m_convergeDistance(convergeDistance),
     m_alignAlways(alignAlways),
-    m_biasToTarget(biasToTarget)
+    m_biasToTarget(biasToTarget),
+    m_fwdFrontIndex(nullptr),
+    m_revFrontIndex(nullptr),
+    m_reverseDirection(nullptr),
+    m_fwdView(nullptr),
+    m_revView(nullptr),
+    m_concurrentSamples(0),
+    m_connected(false)
 {
   if (m_target == nullptr) {
     cerr << "No valid target specified. Please provide target or choose a different planner." << endl;
@@ -106,6 +116,8 @@ BidirectionalMovingFront::BidirectionalMovingFront(
 
   m_max_depth = 0;
   m_nCDCall = 0;
+  m_numSamples = 0;
+  m_samplesTillSwap = m_switchAfter;
 
   movesRejected = 0;
   movesAccepted = 0;
@@ -124,6 +136,10 @@ BidirectionalMovingFront::~BidirectionalMovingFront() {
     delete pSmp;
   }
   delete m_rmsd;
+  delete m_fwdFrontIndex;
+  delete m_revFrontIndex;
+  delete m_fwdView;
+  delete m_revView;
 }
 
 std::list<Configuration *> &BidirectionalMovingFront::getSamples() {
@@ -141,19 +157,26 @@ std::list<Configuration *> &BidirectionalMovingFront::getSamples() {
 
 void BidirectionalMovingFront::generateSamples() {
 
-  static int numSamples = 0, failedTrials = 0, totalTrials = 0;
+  static int failedTrials = 0, totalTrials = 0;
 
-  int samplesTillSwap = m_switchAfter;
   bool swapped = false;
 
   Configuration *qTarget = nullptr, *qSeed = nullptr, *qNew = nullptr; //this qTarget is either global or random and can change for each sample
 
   //Must be initialized here as m_metric is only set in `initialize` (not constructor)
-  m_minDistance = m_metric->distance(m_fwdRoot, m_revRoot);
-  m_fwdRoot->m_distanceToTarget = m_minDistance;
-  m_revRoot->m_distanceToTarget = m_minDistance;
+  if (!m_resumed) {
+    m_minDistance = m_metric->distance(m_fwdRoot, m_revRoot);
+    m_fwdRoot->m_distanceToTarget = m_minDistance;
+    m_revRoot->m_distanceToTarget = m_minDistance;
+  }
+  indexFronts();
+
+  if (m_reverseDirection != nullptr) {
+    generateSamplesConcurrently();
+    return;
+  }
 
-  while (numSamples < m_stopAfter) {//sample at most until the number of samples has been reached
+  while (m_numSamples < m_stopAfter) {//sample at most until the number of samples has been reached
     ++totalTrials;
 
     CTKTimer timer;
@@ -184,8 +207,8 @@ void BidirectionalMovingFront::generateSamples() {
 //    log("planner") << "Base dofs " << qSeed->m_dofs <<endl;
     if (m_isBlended) {
       BlendedDirection &blendedDir = reinterpret_cast<BlendedDirection &>(*direction);
-      blendedDir.changeWeight(0, double(numSamples) / double(m_stopAfter));
-      blendedDir.changeWeight(1, 1.0 - double(numSamples) / double(m_stopAfter));
+      blendedDir.changeWeight(0, double(m_numSamples) / double(m_stopAfter));
+      blendedDir.changeWeight(1, 1.0 - double(m_numSamples) / double(m_stopAfter));
     }
     direction->gradient(qSeed, qTarget, gradient); //computes the search m_direction for a new sample
     gsl_vector_scale_to_length(gradient, m_stepSize);
@@ -198,13 +221,13 @@ void BidirectionalMovingFront::generateSamples() {
       //Could not find a new conformation, swap search directions
       swapFwdRev();
     } else {//collision-free
-      numSamples++;
-      samplesTillSwap--;
+      m_numSamples++;
+      m_samplesTillSwap--;
       gsl_vector_free(gradient);
 
       //Push-back in forward tree
       m_fwdSamples.push_back(qNew);
-      qNew->m_id = numSamples;
+      qNew->m_id = m_numSamples;
 
       //Potentially reject new config if large violations?
       double violationNorm = m_protein->checkCycleClosure(qNew);
@@ -220,10 +243,10 @@ void BidirectionalMovingFront::generateSamples() {
 
       qNew->m_vdwEnergy = qNew->getMolecule()->vdwEnergy(m_collisionCheck);
 
-      log("planner") << "> New structure: " << qNew->getMolecule()->getName() << "_new_" << numSamples
+      log("planner") << "> New structure: " << qNew->getMolecule()->getName() << "_new_" << m_numSamples
                      << ".pdb, accessible dofs: " << qNew->m_clashFreeDofs << endl << endl;
 
-      log("samplingStatus") << "> New structure: " << qNew->getMolecule()->getName() << "_new_" << numSamples << ".pdb";
+      log("samplingStatus") << "> New structure: " << qNew->getMolecule()->getName() << "_new_" << m_numSamples << ".pdb";
       log("samplingStatus") << " .. Dist initial: " << setprecision(6) << qNew->m_distanceToIni;
       log("samplingStatus") << " .. Dist target: " << setprecision(6) << qNew->m_distanceToTarget;
       log("samplingStatus") << " .. Dist moving-front target: " << setprecision(3) << qNew->m_paretoFrontDistance;
@@ -242,12 +265,16 @@ void BidirectionalMovingFront::generateSamples() {
         log() << "Reached target, not creating more samples!" << " distance: " << m_minDistance << endl;
         break;
       }
-      if (samplesTillSwap == 0) {
+      if (m_samplesTillSwap == 0) {
         swapFwdRev();
-        samplesTillSwap = m_switchAfter;
+        m_samplesTillSwap = m_switchAfter;
         swapped = true;
       }
     }
+
+    //A new target is drawn next, so no state is lost by restarting from here
+    if (qNew == nullptr || m_addedToFront == false || swapped == true)
+      checkpoint(m_numSamples);
   }
 
   log() << endl << "Max tree depth (excluding the m_root) = " << m_max_depth << endl;
@@ -255,6 +282,17 @@ void BidirectionalMovingFront::generateSamples() {
 
 }
 
+void BidirectionalMovingFront::indexFronts() {
+  delete m_fwdFrontIndex;
+  delete m_revFrontIndex;
+  m_fwdFrontIndex = new metrics::VPTree(m_metric);
+  m_revFrontIndex = new metrics::VPTree(m_metric);
+  for (auto const &pSmp : m_fwdFront)
+    m_fwdFrontIndex->insert(pSmp);
+  for (auto const &pSmp : m_revFront)
+    m_revFrontIndex->insert(pSmp);
+}
+
 void BidirectionalMovingFront::updateFwdFront(Configuration *qNew) {
 
   std::list<Configuration *>::iterator cit;
@@ -275,8 +313,12 @@ void BidirectionalMovingFront::updateFwdFront(Configuration *qNew) {
 //    log("planner") << "Inserting at the end at: " << i << ", with distance: " << qNew->m_paretoFrontDistance << endl;
     m_addedToFront = true;
   }
-  if (m_fwdFront.size() > m_frontSize)
+  if (m_fwdFront.size() > m_frontSize) {
+    m_fwdFrontIndex->remove(m_fwdFront.back());
     m_fwdFront.pop_back();//keep length at maximum
+  }
+  if (m_addedToFront)
+    m_fwdFrontIndex->insert(qNew);
 
   ///Configurations outside of front will never be used as seeds, delete nullspace
   if(!m_addedToFront){
@@ -353,33 +395,10 @@ Configuration *BidirectionalMovingFront::GenerateRandConf() {
 
 Configuration *BidirectionalMovingFront::SelectSeed(Configuration *pTarget) {
 
-  Configuration *pSmp, *pMinSmp;
-  double minDistance = 1000000.0;
-  double distance;
-  pMinSmp = m_fwdFront.back(); //prevent hole in case distance greater than minDistance
-
-//  const vector<int>* resNetwork = &(ExploreOptions::getOptions()->residueNetwork);
-//  bool allResidues = resNetwork->size() == 0 ? true:false;
-//  Selection resSelection(ExploreOptions::getOptions()->residueNetwork);
-  bool allResidues = true; //TODO: Update so old code works again
-
-  string rmsdSet = "HEAVY", dihSet = "MOV";
-  if (!allResidues) {
-    rmsdSet = "RESHEAVY";
-    dihSet = "RESMOV";
-  }
-
   pTarget->updatedMolecule();//update target protein
 
-  for (auto const &pSmp : m_fwdFront) {
-//    distance = m_metric->distance(pSmp,m_target->m_conf);//TODO: Why m_target->m_conf and not pTarget?
-    distance = m_metric->distance(pSmp, pTarget);
-    if (distance < minDistance) {
-      minDistance = distance;
-      pMinSmp = pSmp;
-    }
-  }
-  return pMinSmp;
+  //Closest sample of the forward front
+  return m_fwdFrontIndex->nearest(pTarget);
 }
 
 void BidirectionalMovingFront::swapFwdRev() {
@@ -406,6 +425,7 @@ void BidirectionalMovingFront::swapFwdRev() {
   //Switch directions
   std::swap(m_fwdSamples, m_revSamples);
   std::swap(m_fwdFront, m_revFront);
+  std::swap(m_fwdFrontIndex, m_revFrontIndex);
   std::swap(m_fwdRoot, m_revRoot);
   std::swap(m_protein, m_target);
   std::swap(m_closestFwdSample, m_closestRevSample);
@@ -416,6 +436,284 @@ void BidirectionalMovingFront::swapFwdRev() {
 }
 
 
+void BidirectionalMovingFront::saveState(PlannerCheckpoint &checkpoint) {
+  //Molecules and trees in the orientation of the constructor
+  Molecule *protein = m_samplingForward ? m_protein : m_target;
+  Molecule *target = m_samplingForward ? m_target : m_protein;
+  checkpoint.setMolecules({protein, target});
+  if (m_samplingForward) checkpoint.addSamples({m_fwdRoot, m_revRoot});
+  else                   checkpoint.addSamples({m_revRoot, m_fwdRoot});
+  checkpoint.addSamples(m_samplingForward ? m_fwdSamples : m_revSamples);
+  checkpoint.addSamples(m_samplingForward ? m_revSamples : m_fwdSamples);
+
+  checkpoint.setList("samplesFwd", m_fwdSamples);
+  checkpoint.setList("samplesRev", m_revSamples);
+  checkpoint.setList("frontFwd", m_fwdFront);
+  checkpoint.setList("frontRev", m_revFront);
+  checkpoint.setList("closestFwd", {m_closestFwdSample});
+  checkpoint.setList("closestRev", {m_closestRevSample});
+  checkpoint.setList("currentGlobalTarget", {m_currentGlobalTarget});
+  checkpoint.setValue("samplingForward", m_samplingForward);
+  checkpoint.setValue("addedToFront", m_addedToFront);
+  checkpoint.setValue("minDistance", m_minDistance);
+  checkpoint.setValue("maxDepth", m_max_depth);
+  checkpoint.setValue("samplesTillSwap", m_samplesTillSwap);
+}
+
+void BidirectionalMovingFront::restoreState(PlannerCheckpoint &checkpoint) {
+  checkpoint.restore({m_protein, m_target}, {m_fwdRoot, m_revRoot});
+
+  //Concurrent trees are always grown in the orientation of the constructor
+  bool savedForward = checkpoint.getValue("samplingForward") != 0;
+  if (!savedForward && m_reverseDirection == nullptr) {
+    std::swap(m_fwdRoot, m_revRoot);
+    std::swap(m_protein, m_target);
+    m_samplingForward = false;
+  }
+  std::string fwd = savedForward == m_samplingForward ? "Fwd" : "Rev";
+  std::string rev = savedForward == m_samplingForward ? "Rev" : "Fwd";
+  m_fwdSamples = checkpoint.getList("samples" + fwd);
+  m_revSamples = checkpoint.getList("samples" + rev);
+  m_fwdFront = checkpoint.getList("front" + fwd);
+  m_revFront = checkpoint.getList("front" + rev);
+  m_closestFwdSample = checkpoint.getSample("closest" + fwd);
+  m_closestRevSample = checkpoint.getSample("closest" + rev);
+  m_currentGlobalTarget = checkpoint.getSample("currentGlobalTarget");
+  m_currentGlobalTarget->updateMolecule();
+
+  m_addedToFront = checkpoint.getValue("addedToFront") != 0;
+  m_minDistance = checkpoint.getValue("minDistance");
+  m_max_depth = (int)checkpoint.getValue("maxDepth");
+  m_samplesTillSwap = (int)checkpoint.getValue("samplesTillSwap");
+  m_numSamples = (int)checkpoint.getValue("numSamples");
+}
+
+void BidirectionalMovingFront::setConcurrentTrees(Direction *reverseDirection,
+                                                  Selection &movingResidues,
+                                                  double collisionFactor,
+                                                  const std::vector<int> &roots) {
+  if (m_alignAlways) {
+    cerr << "BidirectionalMovingFront::setConcurrentTrees - concurrent trees can't be combined with alignAlways" << endl;
+    exit(-1);
+  }
+  if (reverseDirection == direction) {
+    cerr << "BidirectionalMovingFront::setConcurrentTrees - the reverse tree needs its own direction" << endl;
+    exit(-1);
+  }
+
+  m_reverseDirection = reverseDirection;
+  m_fwdView = new KinematicWorkspace(m_target, movingResidues, collisionFactor, roots, m_protein);
+  m_revView = new KinematicWorkspace(m_protein, movingResidues, collisionFactor, roots, m_target);
+  log("samplingStatus") << "Growing forward and reverse trees concurrently" << endl;
+}
+
+void BidirectionalMovingFront::generateSamplesConcurrently() {
+
+  Tree trees[2];
+  trees[0].forward = true;
+  trees[0].molecule = m_protein;
+  trees[0].root = m_fwdRoot;
+  trees[0].samples = &m_fwdSamples;
+  trees[0].front = &m_fwdFront;
+  trees[0].frontIndex = m_fwdFrontIndex;
+  trees[0].closest = &m_closestFwdSample;
+  trees[0].oppositeClosest = &m_closestRevSample;
+  trees[0].direction = direction;
+  trees[0].opposite = m_fwdView;
+
+  trees[1].forward = false;
+  trees[1].molecule = m_target;
+  trees[1].root = m_revRoot;
+  trees[1].samples = &m_revSamples;
+  trees[1].front = &m_revFront;
+  trees[1].frontIndex = m_revFrontIndex;
+  trees[1].closest = &m_closestRevSample;
+  trees[1].oppositeClosest = &m_closestFwdSample;
+  trees[1].direction = m_reverseDirection;
+  trees[1].opposite = m_revView;
+
+  for (auto &tree: trees) {
+    tree.oppositeRoot = tree.opposite->importConfiguration(tree.forward ? m_revRoot : m_fwdRoot);
+    tree.oppositeCopy = nullptr;
+    tree.oppositeCopySource = nullptr;
+    tree.failedTrials = 0;
+    tree.maxDepth = 0;
+    tree.selectNodeTime = 0;
+
+    //Selections cache their atoms per molecule. Fill the caches here so the threads only read them.
+    m_metric->distance(tree.root, tree.root);
+    m_metric->distance(tree.oppositeRoot, tree.oppositeRoot);
+  }
+
+  m_concurrentSamples = m_numSamples;
+  m_connected = m_minDistance < m_convergeDistance;
+
+  ThreadPool pool(2);
+  pool.parallelFor(2, [&](size_t t, unsigned int) { growTree(trees[t]); });
+
+  int failedTrials = 0;
+  for (auto &tree: trees) {
+    delete tree.oppositeRoot;
+    failedTrials += tree.failedTrials;
+    m_max_depth = std::max(m_max_depth, tree.maxDepth);
+    selectNodeTime += tree.selectNodeTime;
+  }
+
+  if (m_connected)
+    log() << "Reached target, not creating more samples!" << " distance: " << m_minDistance << endl;
+  log() << endl << "Max tree depth (excluding the m_root) = " << m_max_depth << endl;
+  log() << "failed " << failedTrials << " times due to collision." << endl;
+}
+
+void BidirectionalMovingFront::growTree(Tree &tree) {
+
+  Configuration *qTarget = nullptr, *qSeed = nullptr, *qNew = nullptr;
+  bool addedToFront = true;
+  gsl_vector *gradient = gsl_vector_calloc(tree.molecule->totalDofNum());
+  CTKTimer timer;
+
+  while (!m_connected && m_concurrentSamples < m_stopAfter) {
+    if (qNew == nullptr || !addedToFront) {//create new target and compute closest seed
+      double start_time = timer.getTimeNow();
+      delete qTarget;
+
+      //Aim at the other tree's closest sample or at a random configuration, probability specified with bias
+      if (Random01() <= m_biasToTarget) {
+        Configuration *oppositeClosest;
+        {
+          std::lock_guard<std::mutex> lock(m_closestMutex);
+          oppositeClosest = *tree.oppositeClosest;
+        }
+        qTarget = tree.opposite->importConfiguration(oppositeClosest);
+      } else {
+        qTarget = new Configuration(tree.opposite->getMolecule());
+        for (int i = 0; i < qTarget->getNumDOFs(); ++i) {
+          qTarget->m_dofs[i] = Math3D::dPi * RandomN1P1();
+        }
+        qTarget->m_id = -1; //invalid ID, identify non-sampled conformations
+      }
+      qTarget->updateMolecule();
+
+      qSeed = tree.frontIndex->nearest(qTarget);
+      tree.selectNodeTime += timer.getTimeNow() - start_time;
+    } else {//aim towards the same target using the latest configuration as new seed
+      qSeed = tree.samples->back();
+    }
+
+    if (m_isBlended) {
+      double progress = double(m_concurrentSamples) / double(m_stopAfter);
+      BlendedDirection &blendedDir = reinterpret_cast<BlendedDirection &>(*tree.direction);
+      blendedDir.changeWeight(0, progress);
+      blendedDir.changeWeight(1, 1.0 - progress);
+    }
+    tree.direction->gradient(qSeed, qTarget, gradient);
+    gsl_vector_scale_to_length(gradient, m_stepSize);
+    qNew = m_move->move(qSeed, gradient);
+
+    if (qNew->updatedMolecule()->inCollision()) {
+      tree.failedTrials++;
+      delete qNew;
+      qNew = nullptr;
+      continue;
+    }
+
+    tree.samples->push_back(qNew);
+    qNew->m_id = ++m_concurrentSamples;
+
+    double violationNorm = tree.molecule->checkCycleClosure(qNew);
+    evaluateDistances(tree, qNew);
+    qNew->m_vdwEnergy = tree.molecule->vdwEnergy(m_collisionCheck);
+
+    log("samplingStatus") << "> New " << (tree.forward ? "forward" : "reverse") << " structure: ";
+    log("samplingStatus") << tree.molecule->getName() << "_new_" << qNew->m_id << ".pdb";
+    log("samplingStatus") << " .. Dist initial: " << setprecision(6) << qNew->m_distanceToIni;
+    log("samplingStatus") << " .. Dist target: " << setprecision(6) << qNew->m_distanceToTarget;
+    log("samplingStatus") << " .. Dist moving-front target: " << setprecision(3) << qNew->m_paretoFrontDistance;
+    log("samplingStatus") << " .. norm constr. viol.: " << violationNorm << endl;
+
+    IO::writeNewSample(qNew, tree.root, qNew->m_id, m_workingDir, m_saveData);
+
+    addedToFront = updateFront(tree, qNew);
+  }
+
+  delete qTarget;
+  delete tree.oppositeCopy;
+  tree.oppositeCopy = nullptr;
+  gsl_vector_free(gradient);
+}
+
+Configuration *BidirectionalMovingFront::importOpposite(Tree &tree, Configuration *conf) {
+  if (tree.oppositeCopySource != conf) {
+    delete tree.oppositeCopy;
+    tree.oppositeCopy = tree.opposite->importConfiguration(conf);
+    tree.oppositeCopySource = conf;
+  }
+  return tree.oppositeCopy;
+}
+
+void BidirectionalMovingFront::evaluateDistances(Tree &tree, Configuration *qNew) {
+
+  qNew->m_distanceToTarget = m_metric->distance(qNew, tree.oppositeRoot);
+  qNew->m_distanceToIni = m_metric->distance(qNew, tree.root);
+  if (qNew->getParent() != nullptr) {
+    qNew->m_distanceToParent = m_metric->distance(qNew, qNew->getParent());
+  }
+
+  //Distance to closest sample from opposing tree. Samples are never modified once added, so
+  //the other tree's sample can be copied without holding the lock.
+  Configuration *oppositeClosest;
+  {
+    std::lock_guard<std::mutex> lock(m_closestMutex);
+    oppositeClosest = *tree.oppositeClosest;
+  }
+  qNew->m_paretoFrontDistance = m_metric->distance(qNew, importOpposite(tree, oppositeClosest));
+
+  {
+    std::lock_guard<std::mutex> lock(m_closestMutex);
+    if (qNew->m_paretoFrontDistance < m_minDistance) {//update current shortest configs
+      m_minDistance = qNew->m_paretoFrontDistance;
+      *tree.closest = qNew;
+      *tree.oppositeClosest = oppositeClosest;
+      if (m_minDistance < m_convergeDistance)
+        m_connected = true;
+    }
+  }
+
+  if (qNew->m_treeDepth > tree.maxDepth)
+    tree.maxDepth = qNew->m_treeDepth;
+}
+
+bool BidirectionalMovingFront::updateFront(Tree &tree, Configuration *qNew) {
+
+  std::list<Configuration *> &front = *tree.front;
+  bool added = false;
+
+  auto cit = front.begin();
+  for (; cit != front.end(); cit++) {
+    if (qNew->m_paretoFrontDistance <= (*cit)->m_paretoFrontDistance) {
+      front.insert(cit, qNew);
+      added = true;
+      break;
+    }
+  }
+  if (cit == front.end() && front.size() < m_frontSize) {
+    front.push_back(qNew);
+    added = true;
+  }
+  if (front.size() > m_frontSize) {
+    tree.frontIndex->remove(front.back());
+    front.pop_back();//keep length at maximum
+  }
+  if (added)
+    tree.frontIndex->insert(qNew);
+
+  ///Configurations outside of front will never be used as seeds, delete nullspace
+  if (!added) {
+    qNew->deleteNullspace();
+  }
+  return added;
+}
+
 void BidirectionalMovingFront::createTrajectory() {
 
   if (!m_samplingForward) {//have to swap, we were last going in reverse
@@ -36,14 +36,18 @@ IN THE SOFTWARE.
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <atomic>
+#include <mutex>
 #include <metrics/RMSD.h>
 
 #include "metrics/Metric.h"
+#include "metrics/VPTree.h"
 #include "core/Molecule.h"
 #include "core/Configuration.h"
 #include "planners/SamplingPlanner.h"
 #include "directions/Direction.h"
 
+class KinematicWorkspace;
 
 /**
  * A sampling planner based on a bidirectional RRT (paper KuffnerLaValle 2000), adapted with an iteratively
@@ -54,6 +58,12 @@ IN THE SOFTWARE.
  *    b) not in the moving front, we generate a new target and seed to continue in the same direction
  *    c) not accepted (clashing), we switch search directions.
  * The planner continues until a given distance threshold between the fronts is reached, or a given number of samples.
+ *
+ * With setConcurrentTrees the two trees are grown at the same time on separate threads instead of alternating.
+ * Each thread only modifies its own tree and molecule, and measures distances to the other tree on a private
+ * copy of the other molecule. The closest pair of samples is shared and protected by a mutex. A tree whose
+ * move clashes picks a new target instead of swapping directions. Concurrent runs are not reproducible, and
+ * checkpoints (see SamplingPlanner::setCheckpointing) are only written when the trees are grown alternately.
  */
 
 class BidirectionalMovingFront : public SamplingPlanner{
@@ -87,10 +97,24 @@ class BidirectionalMovingFront : public SamplingPlanner{
 
   void createTrajectory(); ///< overwrites the parent function createTrajectory
 
+  /**
+   * Grow the forward and reverse trees concurrently. `reverseDirection` is used for the reverse tree
+   * and must be a different object than the forward direction as directions keep per-tree state. The
+   * remaining arguments must be those passed to Molecule::initializeTree for both molecules.
+   * Call after initialize. Not supported together with alignAlways.
+   */
+  void setConcurrentTrees(Direction* reverseDirection,
+                          Selection& movingResidues,
+                          double collisionFactor,
+                          const std::vector<int>& roots = {});
+
  protected:
   Configuration* GenerateRandConf();
   Configuration* SelectSeed(Configuration *pTarget);
 
+  void saveState(PlannerCheckpoint& checkpoint);
+  void restoreState(PlannerCheckpoint& checkpoint);
+
   void setClosestConfigRMSD();
 
   Direction* direction;
@@ -109,6 +133,8 @@ class BidirectionalMovingFront : public SamplingPlanner{
   std::list<Configuration*> m_revSamples;   ///< all reverse samples
   std::list<Configuration*> m_fwdFront;      ///< forward moving front
   std::list<Configuration*> m_revFront;     ///< reverse moving front
+  metrics::VPTree* m_fwdFrontIndex;         ///< Index of m_fwdFront for seed selection
+  metrics::VPTree* m_revFrontIndex;         ///< Index of m_revFront for seed selection
 
   Configuration* m_currentGlobalTarget; // this is the target for this round
   Configuration* m_closestFwdSample; // own configuration
@@ -118,6 +144,8 @@ class BidirectionalMovingFront : public SamplingPlanner{
 
   int m_max_depth;
   double m_minDistance;
+  int m_numSamples;                          ///< Samples generated when trees are grown alternately
+  int m_samplesTillSwap;                     ///< Samples until the trees are swapped
 
   bool m_addedToFront;
   int m_frontSize;
@@ -137,10 +165,44 @@ class BidirectionalMovingFront : public SamplingPlanner{
   int movesRejected = 0;
   int movesAccepted = 0;
 
+  void indexFronts();
   void updateFwdFront(Configuration* qNew);
   void evaluateDistances(Configuration* qNew);
   void swapFwdRev();
 
+  /** One of the two trees when they are grown concurrently */
+  struct Tree {
+    bool forward;
+    Molecule* molecule;                     ///< Molecule of this tree's samples
+    Configuration* root;
+    std::list<Configuration*>* samples;
+    std::list<Configuration*>* front;
+    metrics::VPTree* frontIndex;
+    Configuration** closest;                ///< This tree's half of the closest pair
+    Configuration** oppositeClosest;        ///< The other tree's half of the closest pair
+    Direction* direction;
+    KinematicWorkspace* opposite;           ///< Private copy of the other tree's molecule for cross-tree distances
+    Configuration* oppositeRoot;            ///< Root of the other tree in `opposite`
+    Configuration* oppositeCopy;            ///< Last sample of the other tree copied to `opposite`
+    Configuration* oppositeCopySource;      ///< The sample oppositeCopy was copied from
+    int failedTrials;
+    int maxDepth;
+    double selectNodeTime;
+  };
+
+  void generateSamplesConcurrently();
+  void growTree(Tree& tree);
+  Configuration* importOpposite(Tree& tree, Configuration* conf);      ///< Copy a sample of the other tree into tree.opposite
+  void evaluateDistances(Tree& tree, Configuration* qNew);
+  bool updateFront(Tree& tree, Configuration* qNew);                  ///< Returns true if qNew was added to the front
+
+  Direction* m_reverseDirection;            ///< Direction of the reverse tree, null unless trees are concurrent
+  KinematicWorkspace* m_fwdView;            ///< Copy of m_target for the forward tree
+  KinematicWorkspace* m_revView;            ///< Copy of m_protein for the reverse tree
+  std::mutex m_closestMutex;                ///< Guards m_closestFwdSample, m_closestRevSample and m_minDistance when concurrent
+  std::atomic<int> m_concurrentSamples;     ///< Samples in both trees when concurrent
+  std::atomic<bool> m_connected;            ///< Set when the trees are within m_convergeDistance
+
 };
 
 
@@ -42,6 +42,7 @@ IN THE SOFTWARE.
 #include "metrics/Dihedral.h"
 
 #include "IO.h"
+#include "planners/PlannerCheckpoint.h"
 #include "directions/BlendedDirection.h"
 #include "math/gsl_helpers.h"
 #include "core/DBond.h"
@@ -90,6 +91,8 @@ DEERPlanner::DEERPlanner(
   m_closestFwdSample = m_fwdRoot;
   m_addedToFront = true;
   m_numSamples = 0;
+  m_navigating = false;
+  m_lastAccepted = false;
 }
 
 DEERPlanner::~DEERPlanner() {
@@ -114,8 +117,10 @@ void DEERPlanner::generateSamples() {
   bool readyToFix = false;
 
   /// %%%%%%%%%%%%%%%%%%%%% First downhill approach as far as possible
-  log("samplingStatus") << "Starting downhill moves"<<endl;
-  approachTarget();
+  if (!m_navigating) {
+    log("samplingStatus") << "Starting downhill moves"<<endl;
+    approachTarget();
+  }
 
   double end_time = timer.ElapsedTime();
 
@@ -206,6 +211,7 @@ void DEERPlanner::approachTarget() {
         IO::writeNewSample(newConf, m_fwdRoot, newConf->m_id, m_workingDir, m_saveData);
 
         previousDist = dist;
+        checkpoint(m_numSamples);
       }
     }
   }
@@ -217,6 +223,11 @@ void DEERPlanner::navigateToTarget() {
 
   Configuration *qTarget = nullptr, *qSeed = nullptr, *qNew = nullptr; //this qTarget is either global or random and can change for each sample
 
+  //qNew only tells if the last move was accepted before a target is drawn
+  if (m_navigating && m_lastAccepted)
+    qNew = m_fwdSamples.back();
+  m_navigating = true;
+
   while (m_numSamples < m_stopAfter) {//sample at most until the number of samples has been reached
     ++totalTrials;
 
@@ -309,6 +320,9 @@ void DEERPlanner::navigateToTarget() {
         break;
       }
     }
+
+    m_lastAccepted = qNew != nullptr;
+    checkpoint(m_numSamples);
   }
 
   log() << endl << "Max tree depth (excluding the m_root) = " << m_max_depth << endl;
@@ -316,6 +330,31 @@ void DEERPlanner::navigateToTarget() {
 
 }
 
+void DEERPlanner::saveState(PlannerCheckpoint &checkpoint) {
+  checkpoint.setMolecules({m_protein});
+  checkpoint.addSamples(m_fwdSamples);
+  checkpoint.setList("front", m_fwdFront);
+  checkpoint.setList("closest", {m_closestFwdSample});
+  checkpoint.setValue("minDistance", m_minDistance);
+  checkpoint.setValue("maxDepth", m_max_depth);
+  checkpoint.setValue("addedToFront", m_addedToFront);
+  checkpoint.setValue("navigating", m_navigating);
+  checkpoint.setValue("lastAccepted", m_lastAccepted);
+}
+
+void DEERPlanner::restoreState(PlannerCheckpoint &checkpoint) {
+  checkpoint.restore({m_protein}, {m_fwdRoot});
+  m_fwdSamples.assign(checkpoint.getSamples().begin(), checkpoint.getSamples().end());
+  m_fwdFront = checkpoint.getList("front");
+  m_closestFwdSample = checkpoint.getSample("closest");
+  m_minDistance = checkpoint.getValue("minDistance");
+  m_max_depth = (int)checkpoint.getValue("maxDepth");
+  m_addedToFront = checkpoint.getValue("addedToFront") != 0;
+  m_navigating = checkpoint.getValue("navigating") != 0;
+  m_lastAccepted = checkpoint.getValue("lastAccepted") != 0;
+  m_numSamples = (int)checkpoint.getValue("numSamples");
+}
+
 void DEERPlanner::fixConstraints() {
 //  /// Generate new molecule with DEER distance constraints
 //  m_closestFwdSample->updatedMolecule();
@@ -410,17 +449,19 @@ Configuration *DEERPlanner::SelectSeed(Configuration *pTarget) {
 
   Configuration *pMinSmp;
   double minDistance = 1000000.0;
-  double distance;
   pMinSmp = m_fwdFront.back(); //prevent hole in case distance greater than minDistance
 
   pTarget->updatedMolecule();//update target protein
 
-  for (auto const &pSmp : m_fwdFront) {
-    distance = m_metric->distance(pSmp, pTarget);
-    if (distance < minDistance) {
-      minDistance = distance;
-      pMinSmp = pSmp;
+  vector<double> distances;
+  m_metric->distances(m_fwdFront, pTarget, distances);
+  size_t i = 0;
+  for (Configuration* sample: m_fwdFront) {
+    if (distances[i] < minDistance) {
+      minDistance = distances[i];
+      pMinSmp = sample;
     }
+    ++i;
   }
   return pMinSmp;
 }
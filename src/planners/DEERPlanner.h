@@ -94,6 +94,9 @@ class DEERPlanner : public SamplingPlanner{
 
   Direction* m_direction;
 
+  void saveState(PlannerCheckpoint& checkpoint);
+  void restoreState(PlannerCheckpoint& checkpoint);
+
   void approachTarget();
   void navigateToTarget();
   void exploreAroundTarget();
@@ -124,6 +127,8 @@ class DEERPlanner : public SamplingPlanner{
   int m_frontSize;
   bool m_isBlended;
   int m_numSamples;
+  bool m_navigating;    ///< Set when the downhill approach has ended and motion planning started
+  bool m_lastAccepted;  ///< Last move of motion planning was accepted, so the next may continue from it
 
   std::string m_collisionCheck;
   double m_stepSize;
@@ -215,18 +215,18 @@ Configuration *DihedralRRT::GenerateRandConf() {
 }
 
 Configuration *DihedralRRT::SelectClosestNode(Configuration *pTarget) {
-  Configuration *pSmp, *pMinSmp;
+  Configuration *pMinSmp = nullptr;
   double min_distance = 1000000.0;
-  double distance;
-  pMinSmp = nullptr;
-
-  for (list<Configuration *>::iterator iter = m_samples.begin(); iter != m_samples.end(); ++iter) {
-    pSmp = *iter;
-    distance = m_metric->distance(pSmp, pTarget);
-    if (distance < min_distance) {
-      min_distance = distance;
-      pMinSmp = pSmp;
+
+  vector<double> distances;
+  m_metric->distances(m_samples, pTarget, distances);
+  size_t i = 0;
+  for (Configuration* sample: m_samples) {
+    if (distances[i] < min_distance) {
+      min_distance = distances[i];
+      pMinSmp = sample;
     }
+    ++i;
   }
 
   return pMinSmp;
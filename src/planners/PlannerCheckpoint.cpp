@@ -0,0 +1,317 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+
+#include "PlannerCheckpoint.h"
+#include "ConfigurationStore.h"
+#include "core/Configuration.h"
+#include "core/Molecule.h"
+#include "core/graph/KinTree.h"
+
+using namespace std;
+
+namespace {
+  const char CHECKPOINT_MAGIC[8] = {'K','G','S','C','K','P','T','1'};
+
+  template<typename T>
+  void writeValue(ofstream& out, const T& value){
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template<typename T>
+  void readValue(ifstream& in, T& value){
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  }
+
+  void writeString(ofstream& out, const string& s){
+    writeValue(out, (uint32_t)s.size());
+    out.write(s.data(), s.size());
+  }
+
+  string readString(ifstream& in){
+    uint32_t size = 0;
+    readValue(in, size);
+    string ret(size, ' ');
+    in.read(&ret[0], size);
+    return ret;
+  }
+}
+
+void PlannerCheckpoint::setMolecules(const vector<Molecule*>& molecules)
+{
+  m_molecules = molecules;
+}
+
+void PlannerCheckpoint::addSamples(const list<Configuration*>& samples)
+{
+  for(auto const& conf: samples){
+    if(m_indices.count(conf)>0) continue;
+    Record record;
+    record.molecule = 0;
+    while(record.molecule<m_molecules.size() && m_molecules[record.molecule]!=conf->getMolecule())
+      record.molecule++;
+    if(record.molecule==m_molecules.size()){
+      cerr<<"PlannerCheckpoint::addSamples - error: Sample "<<conf->m_id<<" belongs to none of the molecules"<<endl;
+      exit(-1);
+    }
+    auto pit = m_indices.find(conf->getParent());
+    record.id = conf->m_id;
+    record.parent = pit==m_indices.end() ? -1 : pit->second;
+    record.distances[0] = conf->m_distanceToIni;
+    record.distances[1] = conf->m_distanceToParent;
+    record.distances[2] = conf->m_distanceToTarget;
+    record.distances[3] = conf->m_paretoFrontDistance;
+    record.distances[4] = conf->m_vdwEnergy;
+    record.dofs.assign(conf->m_dofs, conf->m_dofs+conf->getNumDOFs());
+
+    m_indices[conf] = m_records.size();
+    m_records.push_back(record);
+    m_samples.push_back(conf);
+  }
+}
+
+void PlannerCheckpoint::setList(const string& name, const list<Configuration*>& samples)
+{
+  vector<int64_t>& indices = m_lists[name];
+  indices.clear();
+  for(auto const& conf: samples){
+    auto it = m_indices.find(conf);
+    if(it==m_indices.end()){
+      cerr<<"PlannerCheckpoint::setList - error: Sample "<<conf->m_id<<" of list "<<name<<" was not added"<<endl;
+      exit(-1);
+    }
+    indices.push_back(it->second);
+  }
+}
+
+void PlannerCheckpoint::setValue(const string& name, double value)
+{
+  m_values[name] = value;
+}
+
+void PlannerCheckpoint::write(const string& file)
+{
+  //Continue with a seed that is stored, so a resumed run draws the same numbers from here on
+  m_seed = (uint32_t)rand();
+  srand(m_seed);
+
+  for(size_t i=0;i<file.length();i++){
+    if(file[i]=='/'){
+      mkdir(file.substr(0,i).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    }
+  }
+
+  string tmpFile = file + ".tmp";
+  ofstream out(tmpFile.c_str(), ios::binary | ios::trunc);
+  if(!out.is_open()){
+    cerr<<"PlannerCheckpoint::write - error: Cannot write to "<<tmpFile<<endl;
+    exit(-1);
+  }
+
+  out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+  writeValue(out, m_seed);
+  writeValue(out, (uint32_t)m_molecules.size());
+  for(auto const& mol: m_molecules){
+    writeValue(out, ConfigurationStore::moleculeHash(mol));
+    writeValue(out, (uint32_t)mol->m_spanningTree->getNumDOFs());
+  }
+
+  writeValue(out, (uint64_t)m_records.size());
+  for(auto const& record: m_records){
+    writeValue(out, record.molecule);
+    writeValue(out, record.id);
+    writeValue(out, record.parent);
+    out.write(reinterpret_cast<const char*>(record.distances), sizeof(record.distances));
+    out.write(reinterpret_cast<const char*>(record.dofs.data()), record.dofs.size()*sizeof(double));
+  }
+
+  writeValue(out, (uint32_t)m_lists.size());
+  for(auto const& list: m_lists){
+    writeString(out, list.first);
+    writeValue(out, (uint64_t)list.second.size());
+    out.write(reinterpret_cast<const char*>(list.second.data()), list.second.size()*sizeof(int64_t));
+  }
+
+  writeValue(out, (uint32_t)m_values.size());
+  for(auto const& value: m_values){
+    writeString(out, value.first);
+    writeValue(out, value.second);
+  }
+
+  out.close();
+  if(!out || rename(tmpFile.c_str(), file.c_str())!=0){
+    cerr<<"PlannerCheckpoint::write - error: Failed writing "<<file<<endl;
+    exit(-1);
+  }
+}
+
+void PlannerCheckpoint::read(const string& file)
+{
+  ifstream in(file.c_str(), ios::binary);
+  if(!in.is_open()){
+    cerr<<"PlannerCheckpoint::read - error: Cannot open "<<file<<endl;
+    exit(-1);
+  }
+
+  char magic[sizeof(CHECKPOINT_MAGIC)];
+  in.read(magic, sizeof(magic));
+  if(!in || memcmp(magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC))!=0){
+    cerr<<"PlannerCheckpoint::read - error: "<<file<<" is not a planner checkpoint"<<endl;
+    exit(-1);
+  }
+
+  uint32_t numMolecules = 0;
+  readValue(in, m_seed);
+  readValue(in, numMolecules);
+  m_moleculeKeys.resize(numMolecules);
+  for(auto& key: m_moleculeKeys){
+    readValue(in, key.first);
+    readValue(in, key.second);
+  }
+
+  uint64_t numRecords = 0;
+  readValue(in, numRecords);
+  m_records.resize(numRecords);
+  for(auto& record: m_records){
+    readValue(in, record.molecule);
+    readValue(in, record.id);
+    readValue(in, record.parent);
+    in.read(reinterpret_cast<char*>(record.distances), sizeof(record.distances));
+    if(!in) break;
+    if(record.molecule>=numMolecules){
+      cerr<<"PlannerCheckpoint::read - error: "<<file<<" is not a planner checkpoint or is truncated"<<endl;
+      exit(-1);
+    }
+    record.dofs.resize(m_moleculeKeys[record.molecule].second);
+    in.read(reinterpret_cast<char*>(record.dofs.data()), record.dofs.size()*sizeof(double));
+  }
+
+  uint32_t numLists = 0;
+  readValue(in, numLists);
+  for(uint32_t l=0;l<numLists && in;l++){
+    string name = readString(in);
+    uint64_t size = 0;
+    readValue(in, size);
+    vector<int64_t>& indices = m_lists[name];
+    indices.resize(size);
+    in.read(reinterpret_cast<char*>(indices.data()), size*sizeof(int64_t));
+  }
+
+  uint32_t numValues = 0;
+  readValue(in, numValues);
+  for(uint32_t v=0;v<numValues && in;v++){
+    string name = readString(in);
+    readValue(in, m_values[name]);
+  }
+
+  if(!in){
+    cerr<<"PlannerCheckpoint::read - error: "<<file<<" is truncated"<<endl;
+    exit(-1);
+  }
+
+  srand(m_seed);
+}
+
+void PlannerCheckpoint::restore(const vector<Molecule*>& molecules, const vector<Configuration*>& existing)
+{
+  if(molecules.size()!=m_moleculeKeys.size()){
+    cerr<<"PlannerCheckpoint::restore - error: Checkpoint has "<<m_moleculeKeys.size()<<" molecules, planner has "<<molecules.size()<<endl;
+    exit(-1);
+  }
+  for(size_t m=0;m<molecules.size();m++){
+    if(m_moleculeKeys[m].first!=ConfigurationStore::moleculeHash(molecules[m]) ||
+       m_moleculeKeys[m].second!=molecules[m]->m_spanningTree->getNumDOFs()){
+      cerr<<"PlannerCheckpoint::restore - error: Checkpoint was written for a different molecule or spanning tree"<<endl;
+      exit(-1);
+    }
+  }
+  m_molecules = molecules;
+
+  m_samples.clear();
+  for(size_t i=0;i<m_records.size();i++){
+    const Record& record = m_records[i];
+    Configuration* conf;
+    if(i<existing.size()){
+      conf = existing[i];
+      if(conf->getMolecule()!=molecules[record.molecule]){
+        cerr<<"PlannerCheckpoint::restore - error: Sample "<<i<<" belongs to a different molecule"<<endl;
+        exit(-1);
+      }
+    }else if(record.parent>=0 && record.parent<(int64_t)i){
+      conf = new Configuration(m_samples[record.parent]);
+    }else{
+      conf = new Configuration(molecules[record.molecule]);
+    }
+
+    conf->m_id                  = record.id;
+    conf->m_distanceToIni       = record.distances[0];
+    conf->m_distanceToParent    = record.distances[1];
+    conf->m_distanceToTarget    = record.distances[2];
+    conf->m_paretoFrontDistance = record.distances[3];
+    conf->m_vdwEnergy           = record.distances[4];
+    memcpy(conf->m_dofs, record.dofs.data(), record.dofs.size()*sizeof(double));
+    m_samples.push_back(conf);
+  }
+}
+
+list<Configuration*> PlannerCheckpoint::getList(const string& name) const
+{
+  list<Configuration*> ret;
+  auto it = m_lists.find(name);
+  if(it==m_lists.end()) return ret;
+  for(auto const& index: it->second){
+    if(index<0 || index>=(int64_t)m_samples.size()){
+      cerr<<"PlannerCheckpoint::getList - error: List "<<name<<" refers to a missing sample"<<endl;
+      exit(-1);
+    }
+    ret.push_back(m_samples[index]);
+  }
+  return ret;
+}
+
+Configuration* PlannerCheckpoint::getSample(const string& name) const
+{
+  list<Configuration*> samples = getList(name);
+  return samples.empty() ? nullptr : samples.front();
+}
+
+double PlannerCheckpoint::getValue(const string& name) const
+{
+  auto it = m_values.find(name);
+  if(it==m_values.end()){
+    cerr<<"PlannerCheckpoint::getValue - error: Checkpoint has no value "<<name<<endl;
+    exit(-1);
+  }
+  return it->second;
+}
@@ -0,0 +1,111 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#ifndef KGS_PLANNERCHECKPOINT_H
+#define KGS_PLANNERCHECKPOINT_H
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+class Configuration;
+class Molecule;
+
+/**
+ * The state of a sampling planner in a binary file, so an interrupted run can be continued without
+ * repeating its moves. A checkpoint holds samples (DOF-values, tree links, ids and distances), named lists
+ * of samples such as open sets and moving fronts, named numbers, and a seed for `rand`.
+ *
+ * Writing draws a new seed from `rand` and reseeds with it, and reading reseeds with the stored seed. A
+ * resumed run therefore draws the same random numbers as the run that wrote the checkpoint would have.
+ * The file is written under a temporary name and renamed, so an interruption while writing leaves the
+ * previous checkpoint intact.
+ *
+ * Writing: setMolecules, addSamples (parents before children), then setList/setValue and write.
+ * Reading: read, restore, then getList/getValue.
+ */
+class PlannerCheckpoint {
+ public:
+  /** Molecules of the samples. Their order must be the same when restoring. */
+  void setMolecules(const std::vector<Molecule*>& molecules);
+
+  /**
+   * Add samples, skipping those that were added before. Samples whose parent was not added before them become
+   * roots when restoring.
+   */
+  void addSamples(const std::list<Configuration*>& samples);
+
+  /** Store a list of samples under `name`. All must have been added. */
+  void setList(const std::string& name, const std::list<Configuration*>& samples);
+
+  void setValue(const std::string& name, double value);
+
+  void write(const std::string& file);
+
+  void read(const std::string& file);
+
+  /**
+   * Create the samples of a checkpoint that was read for `molecules`. The first `existing.size()` samples are
+   * not created but copied into `existing` (e.g. roots created by the planner constructor). Exits if the
+   * checkpoint was written for other molecules or spanning trees.
+   */
+  void restore(const std::vector<Molecule*>& molecules, const std::vector<Configuration*>& existing = {});
+
+  /** Samples in the order they were added */
+  const std::vector<Configuration*>& getSamples() const { return m_samples; }
+
+  std::list<Configuration*> getList(const std::string& name) const;
+
+  /** The first sample of list `name`, or nullptr if it is empty */
+  Configuration* getSample(const std::string& name) const;
+
+  double getValue(const std::string& name) const;
+
+ private:
+  /** Record of a sample as stored in the file */
+  struct Record {
+    uint32_t molecule;
+    int32_t id;
+    int64_t parent;
+    double distances[5];   ///< To initial, parent, target, front, and vdW energy
+    std::vector<double> dofs;
+  };
+
+  std::vector<Molecule*> m_molecules;
+  std::vector<Configuration*> m_samples;
+  std::map<Configuration*, int64_t> m_indices;
+  std::vector<Record> m_records;
+  std::map<std::string, std::vector<int64_t> > m_lists;
+  std::map<std::string, double> m_values;
+  std::vector<std::pair<uint64_t, uint32_t> > m_moleculeKeys; ///< Hash and DOF count of each molecule
+  uint32_t m_seed = 0;
+};
+
+#endif //KGS_PLANNERCHECKPOINT_H
@@ -41,6 +41,9 @@ IN THE SOFTWARE.
 #include "core/Chain.h"
 #include "Logger.h"
 #include "core/Transformation.h"
+#include "core/KinematicWorkspace.h"
+#include "ThreadPool.h"
+#include "planners/PlannerCheckpoint.h"
 
 using namespace std;
 
@@ -59,13 +62,13 @@ PoissonPlanner::PoissonPlanner(
   m_lilRad(m_bigRad/2),
   m_molecule(molecule),
   m_gradientSelection(gradientSelection),
-  m_checkAll(!enableBVH)
+  m_checkAll(!enableBVH),
+  m_sampleIndex(nullptr)
 {
   m_root = new Configuration( molecule );
   m_root->m_id = 0;
   open_samples.push_back( m_root );
   all_samples.push_back( m_root );
-  updateMaxDists(m_root);
 }
 
 PoissonPlanner::~PoissonPlanner() {
@@ -74,6 +77,7 @@ PoissonPlanner::~PoissonPlanner() {
     pSmp = *iter;
     delete pSmp;
   }
+  delete m_sampleIndex;
 }
 
 
@@ -89,9 +93,16 @@ void PoissonPlanner::generateSamples()
 //  double origMaxRotation = m_move->getMaxRotation();
   m_move->setScalingFlag(false);
 
-  int sample_num = 1;
+  int sample_num = all_samples.size(); //Id of the next sample, 1 unless resumed
   int rejected_clash     = 0;
   int rejected_collision = 0;
+  long numDistances      = 0;
+
+  //Must be created here as m_metric is only set in `initialize` (not constructor)
+  delete m_sampleIndex;
+  m_sampleIndex = new metrics::VPTree(m_metric);
+  for (auto const &v : all_samples)
+    m_sampleIndex->insert(v);
 
   while(sample_num<m_stopAfter && !open_samples.empty()) {
     //Pick random open conformation
@@ -100,58 +111,38 @@ void PoissonPlanner::generateSamples()
     Configuration* seed = *it;
     log("samplingStatus") << "Using configuration "<<seed->m_id<<" as seed. "<<open_samples.size()<<" open, "<<closed_samples.size()<<" closed samples"<<endl;
 
-    vector<Configuration*> nearSeed;
-    if(!m_checkAll) {
-      collectPossibleChildCollisions(seed, nearSeed, m_root, m_bigRad);
-    } else {
-      // In practice this will collect everything
-      collectPossibleChildCollisions(seed, nearSeed, m_root, m_bigRad*10000);
-    }
-
     //Make m_maxRejectsBeforeClose attempts at perturbing it
+    vector<Perturbation> parallelPerturbations;
+    if(m_threadPool!=nullptr)
+      perturbInParallel(seed, direction, parallelPerturbations);
+
     size_t attempt;
     for (attempt = 0; attempt < m_maxRejectsBeforeClose; attempt++) {
+      Perturbation perturbation;
+      if (m_threadPool!=nullptr) {
+        perturbation = parallelPerturbations[attempt];
+      } else {
 //      m_move->setMaxRotation(origMaxRotation); no scaling in moves anymore
-      direction->gradient(seed, nullptr, gradient);  // Compute random gradient
-      gsl_vector_scale(gradient, 1.0);
-      Configuration *pert = m_move->move(seed, gradient);  // Perform move
-
-      // Scale gradient so move is in Poisson disc
-      double dist = m_metric->distance(pert, seed);
-      int scaleAttempts = 0;
-      while (dist < m_lilRad || dist > m_bigRad) {
-        if (++scaleAttempts == 5) break;
-        double gradientScale = (m_bigRad+m_lilRad)/(2.0*dist);
-        gsl_vector_scale(gradient, gradientScale);
-        delete pert;
-        pert = m_move->move(seed, gradient);
-        dist = m_metric->distance(pert, seed);
+        direction->gradient(seed, nullptr, gradient);  // Compute random gradient
+        gsl_vector_scale(gradient, 1.0);
+        perturbation = perturb(seed, gradient);
       }
+      Configuration *pert = perturbation.conf;
 
-      if (scaleAttempts == 5) {
-        delete pert;
-        cout << "Bailing as we can't scale. Final dist: " << dist << endl;
+      if (pert==nullptr && !perturbation.clashing) {
+        cout << "Bailing as we can't scale. Final dist: " << perturbation.dist << endl;
         continue;
       }
 
       // If clashing just continue
-      if (pert->updatedMolecule()->inCollision()) {
+      if (pert==nullptr) {
         rejected_clash++;
-        delete pert;
         continue;
       }
 
 
-      // Check if close to existing
-      bool too_close_to_existing = false;
-      for (auto const &v : nearSeed) {
-        double dist = memo_distance(pert, v);
-        if (dist < m_lilRad) {
-          too_close_to_existing = true;
-          break;
-        }
-      }
-      if (too_close_to_existing) {
+      // Check if close to existing, including samples just generated from this seed
+      if (tooCloseToExisting(pert, numDistances)) {
         rejected_collision++;
         delete pert;
         continue;
@@ -161,11 +152,11 @@ void PoissonPlanner::generateSamples()
       pert->m_id = sample_num;
       open_samples.push_back(pert);
       all_samples.push_back(pert);
-      pert->m_distanceToIni    = memo_distance(pert,m_root);
-      pert->m_distanceToParent = memo_distance(pert,seed);
-      updateMaxDists(pert);
+      m_sampleIndex->insert(pert);
+      pert->m_distanceToIni    = m_metric->distance(pert,m_root);
+      pert->m_distanceToParent = perturbation.dist;
       IO::writeNewSample(pert, m_root, sample_num, m_workingDir, m_saveData);
-      log("poissonDistances")<<"Sample "<<sample_num<<" .. "<<m_distances.size()<<" distance computations"<<endl;
+      log("poissonDistances")<<"Sample "<<sample_num<<" .. "<<numDistances<<" distance computations"<<endl;
 
       log("samplingStatus") << "> "<<pert->getMolecule()->getName()<<"_new_"<<sample_num<<".pdb";
       log("samplingStatus") << " .. init dist: "<< setprecision(3)<<pert->m_distanceToIni;
@@ -177,6 +168,7 @@ void PoissonPlanner::generateSamples()
 
     open_samples.erase(it);
     closed_samples.push_back(seed);
+    checkpoint(sample_num-1);
   }
   log("samplingStatus")<<"Poisson-planner: "<<open_samples.size()<<" open samples and ";
   log("samplingStatus")<<closed_samples.size()<<" closed samples on termination ";
@@ -187,64 +179,139 @@ void PoissonPlanner::generateSamples()
   gsl_vector_free(gradient);
   delete direction;
 
+  if (m_threadPool!=nullptr) {
+    //Workspace configurations are deleted on the thread that computed their jacobians
+    m_threadPool->forEachThread([this](unsigned int thread) {
+      if (thread < m_workspaceSeeds.size())
+        delete m_workspaceSeeds[thread].second;
+    });
+    m_workspaceSeeds.clear();
+    for (auto const& g: m_parallelGradients)
+      gsl_vector_free(g);
+    m_parallelGradients.clear();
+  }
+
 }
 
-double PoissonPlanner::memo_distance(Configuration* c1, Configuration* c2)
+void PoissonPlanner::saveState(PlannerCheckpoint& checkpoint)
 {
-  if(c1==c2) return 0.0;
-
-  auto it = m_distances.find({c1,c2});
-  if( it!=m_distances.end() ) return it->second;
-
-  double dist = m_metric->distance(c1,c2); //Expensive
-  m_distances[{c1,c2}] = dist;
-  m_distances[{c2,c1}] = dist;
-
-  return dist;
+  checkpoint.setMolecules({m_molecule});
+  checkpoint.addSamples(all_samples);
+  checkpoint.setList("open", open_samples);
+  checkpoint.setList("closed", closed_samples);
 }
 
-void PoissonPlanner::collectPossibleChildCollisions(
-    Configuration* conf,
-    std::vector<Configuration*>& ret,
-    double childOffset
-)
+void PoissonPlanner::restoreState(PlannerCheckpoint& checkpoint)
 {
-  collectPossibleChildCollisions(conf, ret, m_root, childOffset);
+  checkpoint.restore({m_molecule}, {m_root});
+  all_samples.assign(checkpoint.getSamples().begin(), checkpoint.getSamples().end());
+  open_samples = checkpoint.getList("open");
+  closed_samples = checkpoint.getList("closed");
 }
 
-void PoissonPlanner::collectPossibleChildCollisions(
-    Configuration* conf,
-    std::vector<Configuration*>& ret,
-    Configuration* v,
-    double childOffset
-)
+PoissonPlanner::Perturbation PoissonPlanner::perturb(Configuration* seed, gsl_vector* gradient)
 {
-  if(v->m_id<0) return;
-
-  double d = memo_distance(v,conf);
-  //if( d >= m_maxDist[v]+m_bigRad+m_lilRad )
-  if( d >= m_maxDist[v]+childOffset+m_lilRad )
-    return;
+  Configuration *pert = m_move->move(seed, gradient);  // Perform move
+
+  // Scale gradient so move is in Poisson disc
+  double dist = m_metric->distance(pert, seed);
+  int scaleAttempts = 0;
+  while (dist < m_lilRad || dist > m_bigRad) {
+    if (++scaleAttempts == 5) break;
+    double gradientScale = (m_bigRad+m_lilRad)/(2.0*dist);
+    gsl_vector_scale(gradient, gradientScale);
+    delete pert;
+    pert = m_move->move(seed, gradient);
+    dist = m_metric->distance(pert, seed);
+  }
 
-  //if(d<m_bigRad+m_lilRad) ret.push_back(v);
-  if(d<childOffset+m_lilRad) ret.push_back(v);
+  if (scaleAttempts == 5) {
+    delete pert;
+    return {nullptr, dist, false};
+  }
 
-  for(auto const& child: v->getChildren()) {
-//    cout<<"collectPossibleChildCollisions - "<<child->m_id<<" is a child of "<<v->m_id<<endl;
-    collectPossibleChildCollisions(conf, ret, child, childOffset);
+  if (pert->updatedMolecule()->inCollision()) {
+    delete pert;
+    return {nullptr, dist, true};
   }
 
+  return {pert, dist, false};
 }
 
-void PoissonPlanner::updateMaxDists(Configuration* newConf)
+void PoissonPlanner::perturbInParallel(Configuration* seed, Direction* direction, std::vector<Perturbation>& ret)
 {
-  updateMaxDists(newConf, newConf);
+  //Gradients are drawn here in attempt order so the random sequence, and thereby the samples, don't
+  //depend on the number of threads or on how attempts are scheduled.
+  size_t numDofs = m_molecule->totalDofNum();
+  while (m_parallelGradients.size() < m_maxRejectsBeforeClose)
+    m_parallelGradients.push_back(gsl_vector_alloc(numDofs));
+  for (size_t attempt = 0; attempt < m_maxRejectsBeforeClose; attempt++) {
+    direction->gradient(seed, nullptr, m_parallelGradients[attempt]);
+    gsl_vector_scale(m_parallelGradients[attempt], 1.0);
+  }
+
+  //Results are copied to configurations of m_molecule created on this thread
+  ret.assign(m_maxRejectsBeforeClose, {nullptr, 0.0, false});
+  for (auto& perturbation: ret)
+    perturbation.conf = new Configuration(seed);
+
+  //The seed's nullspace is decomposed once here and copied into the workspace seeds. The basis is
+  //copied first as workers may evict the seed's nullspace through the NullspaceCache.
+  gsl_matrix* seedBasis = nullptr;
+  int seedNullspaceSize = 0;
+  Nullspace* seedNullspace = seed->getNullspace();
+  if (seedNullspace != nullptr) {
+    seedBasis = gsl_matrix_alloc(seedNullspace->getBasis()->size1, seedNullspace->getBasis()->size2);
+    gsl_matrix_memcpy(seedBasis, seedNullspace->getBasis());
+    seedNullspaceSize = seedNullspace->getNullspaceSize();
+  }
+
+  vector<char> produced(m_maxRejectsBeforeClose, 0);
+  m_workspaceSeeds.resize(m_workspaces.size(), {nullptr, nullptr});
+  m_threadPool->parallelFor(m_maxRejectsBeforeClose, [&](size_t attempt, unsigned int thread) {
+    KinematicWorkspace* workspace = m_workspaces[thread];
+    std::pair<Configuration*, Configuration*>& seedCopy = m_workspaceSeeds[thread];
+    if (seedCopy.first != seed) {
+      delete seedCopy.second;
+      seedCopy = {seed, workspace->importConfiguration(seed)};
+      if (seedBasis != nullptr)
+        seedCopy.second->copyNullspace(seedBasis, seedNullspaceSize);
+    }
+
+    Perturbation result = perturb(seedCopy.second, m_parallelGradients[attempt]);
+    Perturbation& perturbation = ret[attempt];
+    perturbation.dist = result.dist;
+    perturbation.clashing = result.clashing;
+    if (result.conf != nullptr) {
+      workspace->exportConfiguration(result.conf, perturbation.conf);
+      delete result.conf;
+      produced[attempt] = 1;
+    }
+  });
+
+  if (seedBasis != nullptr)
+    gsl_matrix_free(seedBasis);
+
+  for (size_t attempt = 0; attempt < m_maxRejectsBeforeClose; attempt++) {
+    if (produced[attempt]) continue;
+    delete ret[attempt].conf;
+    ret[attempt].conf = nullptr;
+  }
 }
-void PoissonPlanner::updateMaxDists(Configuration* v, Configuration* newConf)
+
+bool PoissonPlanner::tooCloseToExisting(Configuration* conf, long& numDistances)
 {
-  double d = memo_distance(v,newConf);
-  if( d>m_maxDist[v] ) m_maxDist[v] = d;
+  if (m_checkAll) {
+    for (auto const &v : all_samples) {
+      numDistances++;
+      if (m_metric->distance(v, conf) < m_lilRad)
+        return true;
+    }
+    return false;
+  }
 
-  Configuration* parent = v->getParent();
-  if(parent!=nullptr) updateMaxDists(parent, newConf);
+  return m_sampleIndex->anyWithin(conf, m_lilRad, [&](Configuration *v, Configuration *c) {
+    numDistances++;
+    return m_metric->distance(v, c);
+  });
 }
@@ -36,10 +36,12 @@ IN THE SOFTWARE.
 #include <string>
 
 #include "metrics/Metric.h"
+#include "metrics/VPTree.h"
 #include "core/Configuration.h"
 #include "planners/SamplingPlanner.h"
 
 class Molecule;
+class Direction;
 
 typedef std::tuple<Residue *, Residue *, Residue *> ResTriple;
 
@@ -50,6 +52,12 @@ typedef std::tuple<Residue *, Residue *, Residue *> ResTriple;
  * valid perturbation gives a non-clashing sample that is not too close to existing samples.
  *
  * This is repeated until stop_after samples have been generated, or until there are no more 'open' samples.
+ * All samples are kept in a metrics::VPTree, so checking a perturbation against existing samples only measures
+ * distances to a small part of them.
+ *
+ * With SamplingPlanner::setParallel the perturbations of a seed are computed concurrently, each thread
+ * working on its own KinematicWorkspace. Gradients are still drawn and the Poisson-disc test is still
+ * applied on the calling thread in attempt order, so the samples are the same as when sampling sequentially.
  */
 class PoissonPlanner : public SamplingPlanner {
  public:
@@ -68,6 +76,11 @@ class PoissonPlanner : public SamplingPlanner {
 
   std::list<Configuration *> &getSamples() { return all_samples; }
 
+ protected:
+  void saveState(PlannerCheckpoint &checkpoint);
+
+  void restoreState(PlannerCheckpoint &checkpoint);
+
  private:
   /// Even if open_samples is non-empty sampling will stop after this many new samples have been generated
   const int m_stopAfter;
@@ -82,35 +95,35 @@ class PoissonPlanner : public SamplingPlanner {
 
   std::vector<std::tuple<Residue *> > m_tripeptides; ///< Preprocessed residue triples for use in exact IK
 
-  /// Indicates if all generated samples should be checked for collision (enabled BVH)
+  /// Indicates if all generated samples should be checked one by one instead of querying m_sampleIndex
   bool m_checkAll = false;
 
   Molecule *m_molecule;
 
   Configuration *m_root;
 
-  /** The largest distance from a sample to any of its descendants */
-  std::map<Configuration *, double> m_maxDist;
-
-  /** Memoized distances between configuration pointers */
-  std::map<std::pair<Configuration *, Configuration *>, double> m_distances;
+  /** All samples, for finding those closer than m_lilRad to a perturbation */
+  metrics::VPTree *m_sampleIndex;
 
-  /** Compute distance between c1 and c2 using the memoized map if possible */
-  double memo_distance(Configuration *c1, Configuration *c2);
+  /** True if a sample is closer than m_lilRad to `conf`. `numDistances` counts the distances computed. */
+  bool tooCloseToExisting(Configuration *conf, long &numDistances);
 
-  /** Collect all open or closed configurations within dist of conf and add them to ret. */
-  void collectPossibleChildCollisions(Configuration *conf,
-                                      std::vector<Configuration *> &ret,
-                                      double childOffset);
+  /** Outcome of perturbing a seed */
+  struct Perturbation {
+    Configuration *conf;  ///< The perturbed configuration or nullptr if it was rejected
+    double dist;          ///< Distance to seed after the last scaling attempt
+    bool clashing;        ///< True if rejected because of a clash, false if it couldn't be scaled into the disc
+  };
 
-  void collectPossibleChildCollisions(Configuration *conf,
-                                      std::vector<Configuration *> &ret,
-                                      Configuration *v,
-                                      double childOffset);
+  /** Move `seed` along `gradient` (which is rescaled) to within the Poisson disc and check for clashes. */
+  Perturbation perturb(Configuration *seed, gsl_vector *gradient);
 
-  void updateMaxDists(Configuration *newConf);
+  /** Make all m_maxRejectsBeforeClose perturbations of `seed` on the thread pool. `ret` gets one entry per attempt. */
+  void perturbInParallel(Configuration *seed, Direction *direction, std::vector<Perturbation> &ret);
 
-  void updateMaxDists(Configuration *v, Configuration *newConf);
+  std::vector<gsl_vector *> m_parallelGradients; ///< Gradient of each attempt in parallel mode
+  /** For each thread, the seed it last imported and the workspace copy of it */
+  std::vector<std::pair<Configuration *, Configuration *> > m_workspaceSeeds;
 };
 
 #endif /* POISSONPLANNER_H_ */
@@ -41,6 +41,9 @@ IN THE SOFTWARE.
 #include "CTKTimer.h"
 #include "metrics/RMSD.h"
 #include "metrics/Dihedral.h"
+#include "core/KinematicWorkspace.h"
+#include "ThreadPool.h"
+#include "planners/PlannerCheckpoint.h"
 
 
 using namespace std;
@@ -69,7 +72,12 @@ RRTPlanner::RRTPlanner(
     m_gradientSelection(gradientSelection),
     m_stepSize(stepSize),
     m_maxRotation(maxRotation),
-    m_scaleToRadius(scaleToRadius)
+    m_scaleToRadius(scaleToRadius),
+    m_batchSize(0),
+    m_positionMetric(false),
+    m_basisBudget(0),
+    m_basisBytes(0),
+    m_droppedBases(0)
 //m_explorationRadius(ExploreOptions::getOptions()->explorationRadius)
 {
   m_numDOFs = m_molecule->m_spanningTree->getNumDOFs();//m_edges.size();
@@ -91,6 +99,8 @@ RRTPlanner::RRTPlanner(
 
   distance_buckets[0].push_back(pSmp);
   m_current_max_bucket_id = 0;
+  for (int i = 0; i < MAX_BUCKET_NUM; i++)
+    m_bucketIndex[i] = nullptr;
 
   m_top_min_rmsd = 99999;
   m_top_min_rmsd_id = -1;
@@ -104,21 +114,37 @@ RRTPlanner::~RRTPlanner() {
     pSmp = *iter;
     delete pSmp;
   }
+  for (int i = 0; i < MAX_BUCKET_NUM; i++)
+    delete m_bucketIndex[i];
+}
+
 
+void RRTPlanner::setBatchSize(int batchSize) {
+  m_batchSize = batchSize;
 }
 
+void RRTPlanner::setBasisBudget(size_t bytes) {
+  m_basisBudget = bytes;
+}
 
 void RRTPlanner::generateSamples() {
+  indexBuckets();
+  if (m_threadPool != nullptr) {
+    generateSamplesBatched();
+    return;
+  }
+
   string out_path = m_workingDir;
   string name = m_molecule->getName();
   int nBatch = m_numSamples;
 
-  int sample_id = 0, max_depth = 0, failed_trials = 0, total_trials = 0;
+  int sample_id = m_samples.back()->m_id, max_depth = 0, failed_trials = 0, total_trials = 0;
   Configuration *pTarget = nullptr, *pClosestSmp, *pNewSmp = nullptr;
   gsl_vector *gradient = gsl_vector_alloc(m_molecule->totalDofNum());
 
   //Save initial file (for movie)
-  IO::writeNewSample(m_samples.front(), m_samples.front(), sample_id, m_workingDir, m_saveData);
+  if (!m_resumed)
+    IO::writeNewSample(m_samples.front(), m_samples.front(), sample_id, m_workingDir, m_saveData);
 
   bool createNewTarget = false;
 
@@ -164,15 +190,7 @@ void RRTPlanner::generateSamples() {
         pNewSmp->m_id = sample_id;
         m_samples.push_back(pNewSmp);
 
-        // Put pNewSmp in the appropriate bucket
-        int bucket_id = int(floor(pNewSmp->m_distanceToIni / m_bucketSize));
-        if (bucket_id >= NUM_BINS)
-          bucket_id = NUM_BINS - 1;
-        //cout<<"Bucket id: "<<bucket_id<<", max bucket id: "<<m_current_max_bucket_id<<", bucket size: "<<m_bucketSize<<endl;
-
-        distance_buckets[bucket_id].push_back(pNewSmp);
-        if (bucket_id > m_current_max_bucket_id)
-          m_current_max_bucket_id = bucket_id;
+        addToBucket(pNewSmp);
 
         IO::writeNewSample(pNewSmp, m_samples.front(), sample_id, m_workingDir, m_saveData);
 
@@ -209,10 +227,274 @@ void RRTPlanner::generateSamples() {
         createNewTarget = true;
       }
     }
+    checkpoint(sample_id);
   }
   gsl_vector_free(gradient);
 }
 
+void RRTPlanner::generateSamplesBatched() {
+  string name = m_molecule->getName();
+  size_t batchSize = m_batchSize > 0 ? m_batchSize : 4 * m_threadPool->size();
+  Configuration *root = m_samples.front();
+
+  int sample_id = m_samples.back()->m_id, max_depth = 0, failed_trials = 0;
+  vector<Extension> batch(batchSize);
+  for (auto &ext: batch)
+    ext.gradient = gsl_vector_alloc(m_molecule->totalDofNum());
+  vector<int> buckets(batchSize);
+  vector<Configuration *> rootCopies(m_workspaces.size(), nullptr);
+  m_workspaceSeeds.assign(m_workspaces.size(), {nullptr, nullptr});
+
+  //Workers only read positions and nullspaces of existing samples, only the root's nullspace is computed here
+  for (auto const &pSmp: m_samples)
+    getSampleData(pSmp, m_sampleData[pSmp], pSmp == root);
+  touchBasis(root, true);
+  m_positionMetric = !m_sampleData[root].positions.empty();
+
+  //Save initial file (for movie)
+  if (!m_resumed)
+    IO::writeNewSample(root, root, sample_id, m_workingDir, m_saveData);
+
+  while (sample_id < m_numSamples) {
+    CTKTimer timer;
+    double start_time = timer.getTimeNow();
+
+    //Targets and buckets are drawn here in batch order, workers don't use random numbers
+    for (size_t b = 0; b < batchSize; b++) {
+      batch[b].target = GenerateRandConf();
+      buckets[b] = selectBucket();
+    }
+    m_threadPool->parallelFor(batchSize, [&](size_t b, unsigned int thread) {
+      selectNodeFromBucket(buckets[b], batch[b], m_workspaces[thread]);
+    });
+    selectNodeTime += timer.getTimeNow() - start_time;
+
+    //Directions may be random or keep state, so gradients are computed on this thread
+    for (auto &ext: batch) {
+      if (m_gradientSelection == 1)
+        direction->gradient(ext.seed, ext.target, ext.gradient);
+      else
+        direction->gradient(ext.seed, nullptr, ext.gradient);
+      gsl_vector_scale(ext.gradient, m_stepSize);
+      gsl_vector_scale_max_component(ext.gradient, m_maxRotation);
+      ext.conf = new Configuration(ext.seed);
+    }
+
+    m_threadPool->parallelFor(batchSize, [&](size_t b, unsigned int thread) {
+      if (rootCopies[thread] == nullptr)
+        rootCopies[thread] = m_workspaces[thread]->importConfiguration(root);
+      extend(batch[b], thread, rootCopies[thread]);
+    });
+    for (auto &ext: batch)
+      touchBasis(ext.seed, false);
+
+    //Insert in batch order
+    for (auto &ext: batch) {
+      if (ext.clashing || sample_id >= m_numSamples) {
+        if (ext.clashing) ++failed_trials;
+        if (ext.sample.basis != nullptr)
+          gsl_matrix_free(ext.sample.basis);
+        delete ext.conf;
+        delete ext.target;
+        continue;
+      }
+
+      Configuration *pNewSmp = ext.conf;
+      pNewSmp->m_id = ++sample_id;
+      m_samples.push_back(pNewSmp);
+      m_sampleData[pNewSmp] = std::move(ext.sample);
+      ext.sample.basis = nullptr;
+      touchBasis(pNewSmp, true);
+
+      addToBucket(pNewSmp);
+
+      IO::writeNewSample(pNewSmp, root, sample_id, m_workingDir, m_saveData);
+
+      if (pNewSmp->m_treeDepth > max_depth)
+        max_depth = pNewSmp->m_treeDepth;
+
+      log("samplingStatus") << "> New structure: " << name << "_new_" << sample_id << ".pdb";
+      log("samplingStatus") << " .. Distance to initial: " << setprecision(6) << pNewSmp->m_distanceToIni;
+      log("samplingStatus") << " .. Distance to current target: " << setprecision(3) << ext.distToTarget;
+      log("samplingStatus") << " .. Null-space dimension: " << m_sampleData[pNewSmp].nullspaceSize;
+      log("samplingStatus") << endl;
+      delete ext.target;
+    }
+    checkpoint(sample_id);
+  }
+
+  //Workspace configurations are deleted on the thread that computed their jacobians
+  m_threadPool->forEachThread([&](unsigned int thread) {
+    delete rootCopies[thread];
+    delete m_workspaceSeeds[thread].second;
+  });
+  m_workspaceSeeds.clear();
+  for (auto &entry: m_sampleData)
+    if (entry.second.basis != nullptr)
+      gsl_matrix_free(entry.second.basis);
+  m_sampleData.clear();
+  m_basisLru.clear();
+  m_basisBytes = 0;
+  for (auto &ext: batch)
+    gsl_vector_free(ext.gradient);
+  log("samplingStatus") << "RRT-planner: " << failed_trials << " clashing extensions, max tree depth " << max_depth << endl;
+  if (m_basisBudget > 0)
+    log("samplingStatus") << "RRT-planner: " << m_droppedBases << " nullspace bases dropped to stay within budget" << endl;
+}
+
+void RRTPlanner::indexBuckets() {
+  for (int i = 0; i < MAX_BUCKET_NUM; i++) {
+    delete m_bucketIndex[i];
+    m_bucketIndex[i] = new metrics::VPTree(m_metric);
+    for (auto const &pSmp: distance_buckets[i]) {
+      if (pSmp->m_distanceToIni <= m_radius)
+        m_bucketIndex[i]->insert(pSmp);
+    }
+  }
+}
+
+void RRTPlanner::addToBucket(Configuration *conf) {
+  int bucket_id = int(floor(conf->m_distanceToIni / m_bucketSize));
+  if (bucket_id >= NUM_BINS)
+    bucket_id = NUM_BINS - 1;
+
+  distance_buckets[bucket_id].push_back(conf);
+  if (bucket_id > m_current_max_bucket_id)
+    m_current_max_bucket_id = bucket_id;
+  if (m_bucketIndex[bucket_id] != nullptr && conf->m_distanceToIni <= m_radius)
+    m_bucketIndex[bucket_id]->insert(conf);
+}
+
+void RRTPlanner::saveState(PlannerCheckpoint &checkpoint) {
+  checkpoint.setMolecules({m_molecule});
+  checkpoint.addSamples(m_samples);
+}
+
+void RRTPlanner::restoreState(PlannerCheckpoint &checkpoint) {
+  Configuration *root = m_samples.front();
+  checkpoint.restore({m_molecule}, {root});
+  m_samples.assign(checkpoint.getSamples().begin(), checkpoint.getSamples().end());
+
+  //Buckets follow from the distances to the root and are indexed when sampling starts
+  for (int i = 0; i < MAX_BUCKET_NUM; i++)
+    distance_buckets[i].clear();
+  distance_buckets[0].push_back(root);
+  m_current_max_bucket_id = 0;
+  for (auto const &pSmp: m_samples)
+    if (pSmp != root)
+      addToBucket(pSmp);
+}
+
+int RRTPlanner::selectBucket() {
+  int bucket;
+  do {
+    bucket = rand() % (m_numBuckets - 1);
+  } while (m_bucketIndex[bucket]->empty());
+  return bucket;
+}
+
+void RRTPlanner::getSampleData(Configuration *conf, SampleData &data, bool withNullspace) {
+  m_metric->positions(conf, data.positions);
+  data.basis = nullptr;
+  data.nullspaceSize = 0;
+
+  Nullspace *nullspace = withNullspace ? conf->getNullspace() : nullptr;
+  if (nullspace != nullptr) {
+    data.basis = gsl_matrix_alloc(nullspace->getBasis()->size1, nullspace->getBasis()->size2);
+    gsl_matrix_memcpy(data.basis, nullspace->getBasis());
+    data.nullspaceSize = nullspace->getNullspaceSize();
+  }
+}
+
+void RRTPlanner::touchBasis(Configuration *conf, bool added) {
+  SampleData &data = m_sampleData.at(conf);
+  if (data.basis == nullptr)
+    return;
+
+  if (added) {
+    m_basisLru.push_front(conf);
+    m_basisBytes += data.basis->size1 * data.basis->size2 * sizeof(double);
+  } else {
+    m_basisLru.splice(m_basisLru.begin(), m_basisLru, data.basisPosition);
+  }
+  data.basisPosition = m_basisLru.begin();
+
+  //The basis just used or stored is never dropped. Workers recompute the nullspace of a seed without one.
+  while (m_basisBudget > 0 && m_basisBytes > m_basisBudget && m_basisLru.size() > 1) {
+    SampleData &cold = m_sampleData.at(m_basisLru.back());
+    m_basisBytes -= cold.basis->size1 * cold.basis->size2 * sizeof(double);
+    gsl_matrix_free(cold.basis);
+    cold.basis = nullptr;
+    m_basisLru.pop_back();
+    m_droppedBases++;
+  }
+}
+
+void RRTPlanner::selectNodeFromBucket(int bucket, Extension &ext, KinematicWorkspace *workspace) {
+  Configuration *targetCopy = workspace->importConfiguration(ext.target);
+
+  //The index is only read while workers select seeds, distances are measured on stored positions or
+  //on workspace copies
+  if (m_positionMetric) {
+    m_metric->positions(targetCopy, ext.targetPositions);
+    ext.seed = m_bucketIndex[bucket]->nearest(
+        targetCopy,
+        [&](Configuration *pSmp, Configuration *query) {
+          return m_metric->distance(m_sampleData.at(pSmp).positions, ext.targetPositions);
+        }
+    );
+  } else {
+    ext.seed = m_bucketIndex[bucket]->nearest(
+        targetCopy,
+        [&](Configuration *pSmp, Configuration *query) {
+          Configuration *copy = workspace->importConfiguration(pSmp);
+          double distance = m_metric->distance(copy, query);
+          delete copy;
+          return distance;
+        }
+    );
+  }
+
+  delete targetCopy;
+}
+
+void RRTPlanner::extend(Extension &ext, unsigned int thread, Configuration *root) {
+  KinematicWorkspace *workspace = m_workspaces[thread];
+  std::pair<Configuration *, Configuration *> &seedCopy = m_workspaceSeeds[thread];
+  if (seedCopy.first != ext.seed) {
+    delete seedCopy.second;
+    seedCopy = {ext.seed, workspace->importConfiguration(ext.seed)};
+    const SampleData &seedData = m_sampleData.at(ext.seed);
+    if (seedData.basis != nullptr)
+      seedCopy.second->copyNullspace(seedData.basis, seedData.nullspaceSize);
+  }
+
+  //The new sample is a child of the seed copy, so its nullspace can be updated from the seed's
+  Configuration *pNewSmp = m_move->move(seedCopy.second, ext.gradient);
+  ext.sample.basis = nullptr;
+
+  ext.clashing = pNewSmp->updatedMolecule()->inCollision();
+  if (!ext.clashing) {
+    //Its nullspace is kept for when the sample is extended
+    getSampleData(pNewSmp, ext.sample, true);
+    if (m_positionMetric) {
+      const vector<double> &positions = ext.sample.positions;
+      pNewSmp->m_distanceToIni = m_metric->distance(m_sampleData.at(m_samples.front()).positions, positions);
+      pNewSmp->m_distanceToParent = m_metric->distance(m_sampleData.at(ext.seed).positions, positions);
+      ext.distToTarget = m_metric->distance(positions, ext.targetPositions);
+    } else {
+      Configuration *targetCopy = workspace->importConfiguration(ext.target);
+      pNewSmp->m_distanceToIni = m_metric->distance(pNewSmp, root);
+      pNewSmp->m_distanceToParent = m_metric->distance(pNewSmp, seedCopy.second);
+      ext.distToTarget = m_metric->distance(pNewSmp, targetCopy);
+      delete targetCopy;
+    }
+    workspace->exportConfiguration(pNewSmp, ext.conf);
+  }
+
+  delete pNewSmp;
+}
+
 Configuration *RRTPlanner::GenerateRandConf() {
   Configuration *pNewSmp = new Configuration(m_molecule);
 
@@ -235,35 +517,5 @@ Configuration *RRTPlanner::GenerateRandConf() {
 }
 
 Configuration *RRTPlanner::SelectNodeFromBuckets(Configuration *pTarget) {
-  Configuration *pSmp, *pMinSmp;
-  double min_distance = 1000000.0;
-  double distance;
-  pMinSmp = nullptr;
-
-  int selected_bucket_id;
-  while (pMinSmp == nullptr) {
-    do {
-      selected_bucket_id = rand() % (m_numBuckets - 1);
-    } while (distance_buckets[selected_bucket_id].empty());
-//    log("planner") << "Seed from bucket: " << selected_bucket_id << endl;
-    for (list<Configuration *>::iterator iter = distance_buckets[selected_bucket_id].begin();
-         iter != distance_buckets[selected_bucket_id].end(); ++iter) {
-      pSmp = *iter;
-      if (pSmp->m_distanceToIni > m_radius) {
-        continue;
-      }
-      // Using closest to random
-      distance = m_metric->distance(pSmp, pTarget);
-
-      if (distance < min_distance) {
-        min_distance = distance;
-        pMinSmp = pSmp;
-      }
-    }
-  }
-
-  return pMinSmp;
-}	
-
-
-
+  return m_bucketIndex[selectBucket()]->nearest(pTarget);
+}
@@ -32,9 +32,11 @@ IN THE SOFTWARE.
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <unordered_map>
 #include <directions/Direction.h>
 
 #include "metrics/Metric.h"
+#include "metrics/VPTree.h"
 #include "core/Configuration.h"
 #include "planners/SamplingPlanner.h"
 
@@ -46,6 +48,16 @@ class Molecule;
 #define DEFAULT_MAX_RMSD 25
 
 
+/**
+ * A sampling planner that extends the sample closest to a random target. Seeds are picked from a
+ * random distance bucket to spread samples evenly over distances to the initial configuration. Each
+ * bucket is indexed by a metrics::VPTree so the closest sample is found without measuring all of them.
+ *
+ * With SamplingPlanner::setParallel the tree is extended in batches: a batch of random targets is
+ * drawn, seeds are selected and moved in parallel (each thread on its own KinematicWorkspace), and
+ * accepted samples are then inserted in the order of their targets. Random numbers are only drawn on
+ * the calling thread, so a run depends on the random seed and batch size but not on the thread count.
+ */
 class RRTPlanner : public SamplingPlanner {
  public:
   RRTPlanner(
@@ -65,13 +77,28 @@ class RRTPlanner : public SamplingPlanner {
 
   std::list<Configuration *> &getSamples() { return m_samples; }
 
+  /** Number of extensions per batch when sampling in parallel. 0 uses four per thread. */
+  void setBatchSize(int batchSize);
+
+  /**
+   * Memory in bytes for the nullspace bases kept with samples when sampling in parallel. Over budget the
+   * bases of the least recently extended samples are dropped and recomputed by the workers on demand.
+   * 0 (the default) keeps all of them.
+   */
+  void setBasisBudget(size_t bytes);
+
  protected:
   Configuration *GenerateRandConf();
 
   Configuration *SelectNodeFromBuckets(Configuration *pTarget);
 
+  void saveState(PlannerCheckpoint &checkpoint);
+
+  void restoreState(PlannerCheckpoint &checkpoint);
+
   unsigned int m_current_max_bucket_id;
   std::list<Configuration *> distance_buckets[MAX_BUCKET_NUM];
+  metrics::VPTree *m_bucketIndex[MAX_BUCKET_NUM]; ///< Samples of each bucket within m_radius, used to pick seeds
 
   Direction *direction;
 
@@ -97,6 +124,69 @@ class RRTPlanner : public SamplingPlanner {
   double m_stepSize;
   double m_maxRotation;
   bool m_scaleToRadius;
+  int m_batchSize;
+
+  /** What workers need to know about a sample of m_molecule, so they never update m_molecule */
+  struct SampleData {
+    std::vector<double> positions; ///< See Metric::positions. Empty if m_metric doesn't measure positions
+    gsl_matrix *basis;             ///< Copy of the nullspace basis, or null if it wasn't computed or was dropped
+    int nullspaceSize;
+    std::list<Configuration *>::iterator basisPosition; ///< Position in m_basisLru while basis is set
+  };
+
+  /** Result of extending one seed of a batch */
+  struct Extension {
+    Configuration *seed;
+    Configuration *target;
+    std::vector<double> targetPositions; ///< Positions of target if m_metric measures positions
+    gsl_vector *gradient;
+    Configuration *conf;        ///< Child of seed receiving the new sample, deleted if the move clashed
+    bool clashing;
+    double distToTarget;
+    SampleData sample;          ///< Data of the new sample, kept in m_sampleData once it is inserted
+  };
+
+  /** Data of all samples when sampling in parallel. Only modified on the calling thread between batches. */
+  std::unordered_map<Configuration *, SampleData> m_sampleData;
+  bool m_positionMetric;      ///< Whether m_metric measures positions, in which case seeds are selected on positions
+  std::list<Configuration *> m_basisLru; ///< Samples with a stored basis, most recently extended first
+  size_t m_basisBudget;
+  size_t m_basisBytes;        ///< Memory of the bases in m_basisLru
+  long m_droppedBases;
+  /** For each thread, the seed it last extended and the workspace copy of it */
+  std::vector<std::pair<Configuration *, Configuration *> > m_workspaceSeeds;
+
+  void generateSamplesBatched();
+
+  /** Index the samples of all buckets. Done when sampling starts as the metric is set after construction. */
+  void indexBuckets();
+
+  /** Put a new sample in the bucket matching its distance to the initial configuration */
+  void addToBucket(Configuration *conf);
+
+  /** Draw the bucket a seed is picked from. Only buckets with a sample within m_radius are drawn. */
+  int selectBucket();
+
+  /** Fill in the positions (see Metric::positions) and, if `withNullspace`, a copy of the nullspace basis of `conf` */
+  void getSampleData(Configuration *conf, SampleData &data, bool withNullspace);
+
+  /**
+   * Mark the stored basis of `conf` as most recently used, `added` if it was just stored, and drop the
+   * least recently used bases while over m_basisBudget. Only called between batches.
+   */
+  void touchBasis(Configuration *conf, bool added);
+
+  /**
+   * Set ext.seed to the sample of `bucket` closest to ext.target. Distances are measured on stored positions
+   * if possible and otherwise on `workspace`.
+   */
+  void selectNodeFromBucket(int bucket, Extension &ext, KinematicWorkspace *workspace);
+
+  /**
+   * Move a workspace copy of ext.seed on thread `thread`, check it for clashes and copy the result to ext.conf.
+   * The copy is kept for the next extension of the same seed and starts from the seed's stored nullspace.
+   */
+  void extend(Extension &ext, unsigned int thread, Configuration *root);
 };
 
 
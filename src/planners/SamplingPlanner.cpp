@@ -30,8 +30,12 @@ IN THE SOFTWARE.
 #include <math/NullspaceSVD.h>
 
 #include "SamplingPlanner.h"
+#include "PlannerCheckpoint.h"
 
 #include "IO.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+#include "core/KinematicWorkspace.h"
 
 using namespace std;
 
@@ -41,10 +45,20 @@ SamplingPlanner::SamplingPlanner() :
     m_move(nullptr),
     m_metric(nullptr),
     m_workingDir(""),
-    m_saveData(-1) {
+    m_saveData(0),
+    m_threadPool(nullptr),
+    m_resumed(false),
+    m_checkpointInterval(0),
+    m_lastCheckpoint(0) {
 }
 
-SamplingPlanner::~SamplingPlanner() {}
+SamplingPlanner::~SamplingPlanner() {
+  if(m_threadPool!=nullptr){
+    for(auto const& workspace: m_workspaces)
+      delete workspace;
+    delete m_threadPool;
+  }
+}
 
 void SamplingPlanner::initialize(Move *move, metrics::Metric *metric, const std::string &workingDir, int saveData) {
   m_move = move;
@@ -53,6 +67,76 @@ void SamplingPlanner::initialize(Move *move, metrics::Metric *metric, const std:
   m_saveData = saveData;
 }
 
+void SamplingPlanner::setParallel(Molecule* molecule,
+                                  unsigned int numThreads,
+                                  Selection& movingResidues,
+                                  double collisionFactor,
+                                  const std::vector<int>& roots) {
+  if(m_threadPool!=nullptr){
+    cerr << "SamplingPlanner::setParallel - ERROR: can only be called once" << endl;
+    exit(-1);
+  }
+
+  m_threadPool = new ThreadPool(numThreads);
+  for(unsigned int t=0; t<m_threadPool->size(); t++){
+    KinematicWorkspace* workspace = new KinematicWorkspace(molecule, movingResidues, collisionFactor, roots);
+    m_workspaces.push_back(workspace);
+
+    //Selections cache their atoms per molecule. Fill the caches here so threads only read them.
+    if(m_metric!=nullptr){
+      Configuration* conf = new Configuration(workspace->getMolecule());
+      m_metric->distance(conf, conf);
+      delete conf;
+    }
+  }
+  log("samplingStatus") << "Sampling with " << m_threadPool->size() << " threads" << endl;
+}
+
+void SamplingPlanner::setCheckpointing(const std::string& file, int interval) {
+  m_checkpointFile = file;
+  m_checkpointInterval = interval;
+}
+
+void SamplingPlanner::resume(const std::string& file) {
+  PlannerCheckpoint checkpoint;
+  checkpoint.read(file);
+  restoreState(checkpoint);
+  m_resumed = true;
+  m_lastCheckpoint = (int)checkpoint.getValue("numSamples");
+  log("samplingStatus") << "Resuming from " << file << " with " << m_lastCheckpoint << " samples" << endl;
+
+  //Single-file outputs are recreated by the resumed run, so they must contain the restored samples again
+  if(m_saveData == IO::SAVE_TRAJECTORY || m_saveData == IO::SAVE_CONFIGURATIONS){
+    for(auto const& conf: checkpoint.getSamples())
+      IO::writeNewSample(conf, conf, conf->m_id, m_workingDir, m_saveData);
+  }
+}
+
+void SamplingPlanner::checkpoint(int numSamples) {
+  if(m_checkpointInterval<=0 || numSamples < m_lastCheckpoint+m_checkpointInterval)
+    return;
+
+  //Samples written before the checkpoint must be on disk as resuming doesn't rewrite their files
+  IO::flushSamples();
+
+  PlannerCheckpoint checkpoint;
+  saveState(checkpoint);
+  checkpoint.setValue("numSamples", numSamples);
+  checkpoint.write(m_checkpointFile);
+  m_lastCheckpoint = numSamples;
+  log("samplingStatus") << "Wrote checkpoint " << m_checkpointFile << " at " << numSamples << " samples" << endl;
+}
+
+void SamplingPlanner::saveState(PlannerCheckpoint& checkpoint) {
+  cerr << "SamplingPlanner::saveState - ERROR: this planner doesn't support checkpoints" << endl;
+  exit(-1);
+}
+
+void SamplingPlanner::restoreState(PlannerCheckpoint& checkpoint) {
+  cerr << "SamplingPlanner::restoreState - ERROR: this planner doesn't support checkpoints" << endl;
+  exit(-1);
+}
+
 void SamplingPlanner::createTrajectory() {
   if (m_move == nullptr) {
     cerr << "SamplingPlanner::createTrajectory - ERROR: SamplingPlanner must be initialized before use" << endl;
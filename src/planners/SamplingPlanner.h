@@ -32,6 +32,11 @@ IN THE SOFTWARE.
 #include "moves/Move.h"
 #include "metrics/Metric.h"
 
+class ThreadPool;
+class KinematicWorkspace;
+class Selection;
+class PlannerCheckpoint;
+
 /**
  * The superclass for all sampling planners.
  * A sampling planner encodes a strategy for generating a list of samples.
@@ -47,6 +52,29 @@ class SamplingPlanner{
 
   virtual void initialize(Move* move, metrics::Metric* metric, const std::string& workingDir, int saveData);
 
+  /**
+   * Evaluate perturbations on `numThreads` threads, each with its own KinematicWorkspace cloned from
+   * `molecule`. The remaining arguments must be those passed to Molecule::initializeTree for `molecule`.
+   * Call after initialize. Planners without a parallel mode ignore this and sample sequentially.
+   */
+  void setParallel(Molecule* molecule,
+                   unsigned int numThreads,
+                   Selection& movingResidues,
+                   double collisionFactor,
+                   const std::vector<int>& roots = {});
+
+  /**
+   * Write the planner state to `file` whenever `interval` more samples have been generated, so an interrupted
+   * run can be continued with resume. Call after initialize.
+   */
+  void setCheckpointing(const std::string& file, int interval);
+
+  /**
+   * Continue from the state in checkpoint `file`, written by a run with the same molecules and options.
+   * Call after initialize and before generateSamples.
+   */
+  void resume(const std::string& file);
+
   /** Generate samples. */
   virtual void generateSamples() = 0;
 
@@ -69,6 +97,28 @@ class SamplingPlanner{
   std::string m_workingDir;    ///< Working directory into which samples should be written
   int m_saveData;              ///< Amount of data that should be written during sampling
 
+  ThreadPool* m_threadPool;                      ///< Null unless setParallel was called
+  std::vector<KinematicWorkspace*> m_workspaces; ///< One workspace per thread of m_threadPool
+
+  bool m_resumed;                                ///< Set if the state was restored from a checkpoint
+
+  /**
+   * Write a checkpoint if one is due after `numSamples` samples. Planners call this where their state
+   * is complete, i.e. where restoring it continues sampling exactly as without interruption.
+   */
+  void checkpoint(int numSamples);
+
+  /** Add the planner state to `checkpoint`. The default exits as the planner doesn't support checkpoints. */
+  virtual void saveState(PlannerCheckpoint& checkpoint);
+
+  /** Restore the planner state from `checkpoint`, which must include the value "numSamples". */
+  virtual void restoreState(PlannerCheckpoint& checkpoint);
+
+ private:
+  std::string m_checkpointFile;
+  int m_checkpointInterval;                      ///< Samples between checkpoints, 0 disables checkpoints
+  int m_lastCheckpoint;                          ///< Number of samples at the last checkpoint
+
 
 
 };
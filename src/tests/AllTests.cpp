@@ -32,6 +32,12 @@ IN THE SOFTWARE.
 #include "TestLocalRebuild.h"
 #include "TestSugarPucker.h"
 #include "TestMathUtility.h"
+#include "TestNullspace.h"
+#include "TestVPTree.h"
+#include "TestQCP.h"
+#include "TestRMSD.h"
+#include "TestConfigurationStore.h"
+#include "TestPlannerCheckpoint.h"
 #include "TestDummy.h"
 #include "../Logger.h"
 #include <string>
@@ -45,6 +51,12 @@ AllTests::AllTests(){
     allTests.push_back(new TestLocalRebuild());
     allTests.push_back(new TestSugarPucker());
     allTests.push_back(new TestMathUtility());
+    allTests.push_back(new TestNullspace());
+    allTests.push_back(new TestVPTree());
+    allTests.push_back(new TestQCP());
+    allTests.push_back(new TestRMSD());
+    allTests.push_back(new TestConfigurationStore());
+    allTests.push_back(new TestPlannerCheckpoint());
 }
 
 string AllTests::name(){ return "All tests"; }
@@ -0,0 +1,113 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+#include "TestConfigurationStore.h"
+#include <iomanip>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../ConfigurationStore.h"
+#include "../Logger.h"
+#include "../IO.h"
+#include "../Selection.h"
+#include "core/Configuration.h"
+#include "core/Molecule.h"
+
+bool TestConfigurationStore::runTests(){
+	if(testRoundTrip()) log("test")<<left<<setw(60)<<"TestConfigurationStore::testRoundTrip:"<<"passed"<<endl;
+	else { log("test")<<left<<setw(60)<<"TestConfigurationStore::testRoundTrip:"<<"failed"<<endl;return false;}
+	return true;
+}
+
+/**
+ * Write a random tree of configurations in double and single precision with a cache too small to hold
+ * every parent, so records are both delta coded and absolute, and compare what is read back.
+ */
+bool TestConfigurationStore::testRoundTrip(){
+	srand(5);
+	Molecule* mol = IO::readPdb("tests/polypro.pdb", {}, "identify");
+	Selection all("all");
+	mol->initializeTree(all);
+
+	vector<Configuration*> confs;
+	for(int c=0; c<40; c++){
+		Configuration* parent = confs.empty() ? mol->m_conf : confs[rand()%confs.size()];
+		Configuration* conf = new Configuration(parent);
+		conf->m_id = c+1;
+		for(unsigned int d=0; d<conf->getNumDOFs(); d++)
+			conf->m_dofs[d] = parent->m_dofs[d] + 0.3*(2.0*rand()/RAND_MAX-1.0);
+		conf->m_distanceToIni = c;
+		confs.push_back(conf);
+	}
+
+	bool ok = true;
+	string file = "tests/TestConfigurationStore.kgsconf";
+	for(bool singlePrecision: {false, true}){
+		{
+			ConfigurationStore store(file, mol, singlePrecision, true, 4);
+			for(auto const& conf: confs)
+				store.append(conf);
+		}
+		vector<Configuration*> read = ConfigurationStore::read(file, mol);
+		std::remove(file.c_str());
+
+		double tolerance = singlePrecision ? 1.0e-5 : 0.0;
+		if(read.size()!=confs.size()){
+			log("test")<<"TestConfigurationStore::testRoundTrip: Read "<<read.size()<<" of "<<confs.size()<<" configurations"<<endl;
+			ok = false;
+		}
+		for(size_t c=0; c<read.size() && ok; c++){
+			//Children of the initial configuration, which isn't stored, are read as roots
+			int parentId = confs[c]->getParent()==mol->m_conf ? -1 : confs[c]->getParent()->m_id;
+			int readParentId = read[c]->getParent()==nullptr ? -1 : read[c]->getParent()->m_id;
+			if(read[c]->m_id!=confs[c]->m_id || readParentId!=parentId || read[c]->m_distanceToIni!=confs[c]->m_distanceToIni){
+				log("test")<<"TestConfigurationStore::testRoundTrip: Record "<<c<<" has id "<<read[c]->m_id<<" and parent ";
+				log("test")<<readParentId<<" but expected "<<confs[c]->m_id<<" and "<<parentId<<endl;
+				ok = false;
+			}
+			for(unsigned int d=0; d<read[c]->getNumDOFs() && ok; d++){
+				if(fabs(read[c]->m_dofs[d]-confs[c]->m_dofs[d])>tolerance){
+					log("test")<<"TestConfigurationStore::testRoundTrip: DOF "<<d<<" of record "<<c<<" is "<<read[c]->m_dofs[d];
+					log("test")<<" but was "<<confs[c]->m_dofs[d]<<(singlePrecision?" (single precision)":"")<<endl;
+					ok = false;
+				}
+			}
+		}
+		for(auto it = read.rbegin(); it!=read.rend(); ++it)
+			delete *it;
+	}
+
+	for(auto it = confs.rbegin(); it!=confs.rend(); ++it)
+		delete *it;
+	delete mol;
+	return ok;
+}
+
+string TestConfigurationStore::name(){
+	return "ConfigurationStore";
+}
@@ -0,0 +1,332 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+
+#include "TestNullspace.h"
+#include <iomanip>
+#include <gsl/gsl_blas.h>
+#include "../Logger.h"
+#include "../IO.h"
+#include "core/Configuration.h"
+#include "core/Molecule.h"
+#include "core/NullspaceCache.h"
+#include "math/Nullspace.h"
+#include "math/NullspaceSVD.h"
+#include "math/NullspaceSparse.h"
+#include "math/NullspaceQR.h"
+#include "math/ProjectionWorkspace.h"
+#include "math/gsl_helpers.h"
+
+/** Fill rows `rows` and columns `cols` of `M` with random values scaled by `scale` */
+static void fillBlock(gsl_matrix* M, const vector<int>& rows, const vector<int>& cols, double scale){
+	for(int r: rows)
+		for(int c: cols)
+			gsl_matrix_set(M, r, c, scale*(2.0*rand()/RAND_MAX-1.0));
+}
+
+/** True if the first k1 columns of N1 and the first k2 columns of N2 span the same space */
+static bool sameSpan(const gsl_matrix* N1, int k1, const gsl_matrix* N2, int k2){
+	if(k1!=k2) return false;
+	size_t n = N1->size1;
+	gsl_matrix_const_view B1 = gsl_matrix_const_submatrix(N1, 0, 0, n, k1);
+	gsl_matrix_const_view B2 = gsl_matrix_const_submatrix(N2, 0, 0, n, k2);
+	gsl_matrix* P1 = gsl_matrix_alloc(n, n);
+	gsl_matrix* P2 = gsl_matrix_alloc(n, n);
+	gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1.0, &B1.matrix, &B1.matrix, 0.0, P1);
+	gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1.0, &B2.matrix, &B2.matrix, 0.0, P2);
+	gsl_matrix_sub(P1, P2);
+	double diff = frobenius_norm(P1);
+	gsl_matrix_free(P1);
+	gsl_matrix_free(P2);
+	return diff<1.0e-8;
+}
+
+bool TestNullspace::runTests(){
+    if(testSparseMatchesSVD()) log("test")<<left<<setw(60)<<"TestNullspace::testSparseMatchesSVD:"<<"passed"<<endl;
+    else { log("test")<<left<<setw(60)<<"TestNullspace::testSparseMatchesSVD:"<<"failed"<<endl;return false;}
+    if(testIncrementalMatchesSVD()) log("test")<<left<<setw(60)<<"TestNullspace::testIncrementalMatchesSVD:"<<"passed"<<endl;
+    else { log("test")<<left<<setw(60)<<"TestNullspace::testIncrementalMatchesSVD:"<<"failed"<<endl;return false;}
+    if(testQRMatchesSVD()) log("test")<<left<<setw(60)<<"TestNullspace::testQRMatchesSVD:"<<"passed"<<endl;
+    else { log("test")<<left<<setw(60)<<"TestNullspace::testQRMatchesSVD:"<<"failed"<<endl;return false;}
+    if(testEvictionKeepsRigidity()) log("test")<<left<<setw(60)<<"TestNullspace::testEvictionKeepsRigidity:"<<"passed"<<endl;
+    else { log("test")<<left<<setw(60)<<"TestNullspace::testEvictionKeepsRigidity:"<<"failed"<<endl;return false;}
+    if(testBatchedProjectionMatchesSingle()) log("test")<<left<<setw(60)<<"TestNullspace::testBatchedProjectionMatchesSingle:"<<"passed"<<endl;
+    else { log("test")<<left<<setw(60)<<"TestNullspace::testBatchedProjectionMatchesSingle:"<<"failed"<<endl;return false;}
+    return true;
+}
+
+/**
+ * A permuted block-diagonal matrix with a rank deficient block, a block far below the others
+ * (which the SVD cut-off treats as zero) and unconstrained columns.
+ */
+bool TestNullspace::testSparseMatchesSVD(){
+	srand(17);
+	gsl_matrix* J = gsl_matrix_calloc(12, 16);
+	fillBlock(J, {0,1,2,3}, {0,2,5,7,9}, 1.0);      //Full row rank: 1 nullspace direction
+	fillBlock(J, {4,5,6,7,8}, {1,3,4,6}, 1.0e-3);   //Badly scaled but above the cut-off
+	for(int r: {4,5,6,7,8})                          //Column 6 depends on 1 and 3: 1 direction
+		gsl_matrix_set(J, r, 6, gsl_matrix_get(J, r, 1)+gsl_matrix_get(J, r, 3));
+	fillBlock(J, {9,10,11}, {8,10,11}, 1.0e-14);    //Below the cut-off: 3 directions
+	//Columns 12-15 are unconstrained: 4 directions
+
+	Nullspace* svd = new NullspaceSVD(SVD::createSVD(J, true), true);
+	svd->updateFromMatrix();
+	NullspaceSparse* sparse = new NullspaceSparse(J);
+	sparse->updateFromMatrix();
+
+	bool ok = true;
+	if(sparse->getNumBlocks()!=3){
+		log("test")<<"TestNullspace::testSparseMatchesSVD: Expected 3 blocks but got "<<sparse->getNumBlocks()<<endl;
+		ok = false;
+	}
+	if(svd->getNullspaceSize()!=9 || sparse->getNullspaceSize()!=9){
+		log("test")<<"TestNullspace::testSparseMatchesSVD: Expected nullspace size 9 but got "<<svd->getNullspaceSize();
+		log("test")<<" (svd) and "<<sparse->getNullspaceSize()<<" (sparse)"<<endl;
+		ok = false;
+	}
+	else if(!sameSpan(svd->getBasis(), svd->getNullspaceSize(), sparse->getBasis(), sparse->getNullspaceSize())){
+		log("test")<<"TestNullspace::testSparseMatchesSVD: Bases span different spaces"<<endl;
+		ok = false;
+	}
+
+	delete sparse;
+	delete svd;
+	gsl_matrix_free(J);
+	return ok;
+}
+
+/**
+ * Nullspaces updated from the nullspace of a slightly different matrix must span the same space
+ * as a full SVD, also when the perturbation drops the rank of the matrix.
+ */
+bool TestNullspace::testIncrementalMatchesSVD(){
+	srand(23);
+	const int m = 6, n = 10;
+	gsl_matrix* J0 = gsl_matrix_alloc(m, n);
+	gsl_matrix* J1 = gsl_matrix_alloc(m, n);
+	gsl_matrix* J2 = gsl_matrix_alloc(m, n);
+	for(int i=0; i<m; i++){
+		for(int j=0; j<n; j++){
+			double val = 2.0*rand()/RAND_MAX-1.0;
+			gsl_matrix_set(J0, i, j, val);
+			gsl_matrix_set(J1, i, j, val+1.0e-4*(2.0*rand()/RAND_MAX-1.0));
+		}
+	}
+	//J2 is J1 with a repeated row, so its nullspace is one larger than that of J0
+	gsl_matrix_memcpy(J2, J1);
+	for(int j=0; j<n; j++)
+		gsl_matrix_set(J2, m-1, j, gsl_matrix_get(J2, m-2, j));
+
+	NullspaceSVD::setIncrementalUpdates(true);
+	NullspaceSVD prior(SVD::createSVD(J0, true), true);
+	prior.updateFromMatrix();
+
+	bool ok = true;
+	int index = 1;
+	for(gsl_matrix* J: {J1, J2}){
+		NullspaceSVD full(SVD::createSVD(J, true), true);
+		full.updateFromMatrix();
+		NullspaceSVD incremental(SVD::createSVD(J, true), true);
+		incremental.updateFromPrior(&prior);
+
+		if(!sameSpan(full.getBasis(), full.getNullspaceSize(), incremental.getBasis(), incremental.getNullspaceSize())){
+			log("test")<<"TestNullspace::testIncrementalMatchesSVD: J"<<index<<" expected nullspace size "<<full.getNullspaceSize();
+			log("test")<<" and the same span, got size "<<incremental.getNullspaceSize()<<endl;
+			ok = false;
+		}
+		//The perturbed matrix should be handled by the warm start, the rank drop by a full update
+		if(incremental.isSVDCurrent() != (J==J2)){
+			log("test")<<"TestNullspace::testIncrementalMatchesSVD: J"<<index<<" was "<<(incremental.isSVDCurrent()?"":"not ");
+			log("test")<<"decomposed"<<endl;
+			ok = false;
+		}
+		index++;
+	}
+	NullspaceSVD::setIncrementalUpdates(false);
+
+	gsl_matrix_free(J0);
+	gsl_matrix_free(J1);
+	gsl_matrix_free(J2);
+	return ok;
+}
+
+/**
+ * The pivoted QR of the transposed matrix must find the same nullspace as the SVD, both for a
+ * matrix of full row rank and for one with repeated rows.
+ */
+bool TestNullspace::testQRMatchesSVD(){
+	srand(31);
+	const int m = 7, n = 12;
+	gsl_matrix* J1 = gsl_matrix_alloc(m, n);
+	for(int i=0; i<m; i++)
+		for(int j=0; j<n; j++)
+			gsl_matrix_set(J1, i, j, 2.0*rand()/RAND_MAX-1.0);
+	//J2 repeats two rows of J1, so its nullspace is two larger
+	gsl_matrix* J2 = gsl_matrix_alloc(m, n);
+	gsl_matrix_memcpy(J2, J1);
+	for(int j=0; j<n; j++){
+		gsl_matrix_set(J2, m-1, j, gsl_matrix_get(J2, 0, j));
+		gsl_matrix_set(J2, m-2, j, gsl_matrix_get(J2, 1, j));
+	}
+
+	bool ok = true;
+	int index = 1;
+	for(gsl_matrix* J: {J1, J2}){
+		NullspaceSVD svd(SVD::createSVD(J, true), true);
+		svd.updateFromMatrix();
+		NullspaceQR qr(J);
+		qr.updateFromMatrix();
+
+		int expected = J==J1 ? n-m : n-m+2;
+		if(svd.getNullspaceSize()!=expected || qr.getNullspaceSize()!=expected){
+			log("test")<<"TestNullspace::testQRMatchesSVD: J"<<index<<" expected nullspace size "<<expected<<" but got ";
+			log("test")<<svd.getNullspaceSize()<<" (svd) and "<<qr.getNullspaceSize()<<" (qr)"<<endl;
+			ok = false;
+		}
+		else if(!sameSpan(svd.getBasis(), svd.getNullspaceSize(), qr.getBasis(), qr.getNullspaceSize())){
+			log("test")<<"TestNullspace::testQRMatchesSVD: J"<<index<<" bases span different spaces"<<endl;
+			ok = false;
+		}
+		index++;
+	}
+
+	gsl_matrix_free(J1);
+	gsl_matrix_free(J2);
+	return ok;
+}
+
+/**
+ * A nullspace that is evicted by the NullspaceCache after rigidity analysis must come back with the
+ * same basis size and rigidity flags when the configuration asks for it again.
+ */
+bool TestNullspace::testEvictionKeepsRigidity(){
+	Molecule* mol = IO::readPdb("tests/smallRNALoop.pdb", {}, "identify");
+	Selection all("all");
+	mol->initializeTree(all);
+
+	Configuration* analyzed = new Configuration(mol->m_conf);
+	Configuration* other = new Configuration(mol->m_conf);
+	for(unsigned int d=0; d<analyzed->getNumDOFs(); d++){
+		analyzed->m_dofs[d] = 0.001;
+		other->m_dofs[d] = -0.001;
+	}
+
+	bool ok = true;
+	analyzed->rigidityAnalysis();
+	Nullspace* ns = analyzed->getNullspace();
+	if(ns==nullptr){
+		log("test")<<"TestNullspace::testEvictionKeepsRigidity: tests/smallRNALoop.pdb has no constraint cycles"<<endl;
+		delete other;
+		delete analyzed;
+		delete mol;
+		return false;
+	}
+	int size = ns->getNullspaceSize();
+	int m = ns->getMatrix()->size1, n = ns->getMatrix()->size2;
+	vector<bool> rigidDofs, rigidHBonds;
+	for(int i=0; i<n; i++) rigidDofs.push_back(ns->isCovBondRigid(i));
+	for(int i=0; i<m; i++) rigidHBonds.push_back(ns->isHBondRigid(i));
+
+	//With a 1 byte budget only the most recently used nullspace is kept
+	long evictions = NullspaceCache::getNumEvictions();
+	NullspaceCache::setBudget(1);
+	other->getNullspace();
+	if(NullspaceCache::getNumEvictions()==evictions){
+		log("test")<<"TestNullspace::testEvictionKeepsRigidity: Nothing was evicted"<<endl;
+		ok = false;
+	}
+
+	ns = analyzed->getNullspace();
+	if(ns->getNullspaceSize()!=size){
+		log("test")<<"TestNullspace::testEvictionKeepsRigidity: Expected nullspace size "<<size<<" but got "<<ns->getNullspaceSize()<<endl;
+		ok = false;
+	}
+	for(int i=0; i<n; i++){
+		if(ns->isCovBondRigid(i)!=rigidDofs[i]){
+			log("test")<<"TestNullspace::testEvictionKeepsRigidity: Rigidity of cycle DOF "<<i<<" changed"<<endl;
+			ok = false;
+		}
+	}
+	for(int i=0; i<m; i++){
+		if(ns->isHBondRigid(i)!=rigidHBonds[i]){
+			log("test")<<"TestNullspace::testEvictionKeepsRigidity: Rigidity of h-bond "<<i<<" changed"<<endl;
+			ok = false;
+		}
+	}
+	NullspaceCache::setBudget(0);
+
+	delete other;
+	delete analyzed;
+	delete mol;
+	return ok;
+}
+
+/**
+ * Projecting several gradients (one per column, over all DOFs) in one batch must give the same
+ * result as projecting each of them on its own.
+ */
+bool TestNullspace::testBatchedProjectionMatchesSingle(){
+	srand(41);
+	Molecule* mol = IO::readPdb("tests/smallRNALoop.pdb", {}, "identify");
+	Selection all("all");
+	mol->initializeTree(all);
+	Configuration* conf = mol->m_conf;
+
+	const size_t numGradients = 5;
+	const size_t numDofs = conf->getNumDOFs();
+	gsl_matrix* gradients = gsl_matrix_alloc(numDofs, numGradients);
+	gsl_matrix* batched = gsl_matrix_alloc(numDofs, numGradients);
+	gsl_vector* single = gsl_vector_alloc(numDofs);
+	for(size_t i=0; i<numDofs; i++)
+		for(size_t c=0; c<numGradients; c++)
+			gsl_matrix_set(gradients, i, c, 2.0*rand()/RAND_MAX-1.0);
+
+	ProjectionWorkspace workspace;
+	conf->projectOnCycleNullSpace(gradients, batched, workspace);
+
+	bool ok = true;
+	for(size_t c=0; c<numGradients; c++){
+		gsl_vector_view in = gsl_matrix_column(gradients, c);
+		gsl_vector_view out = gsl_matrix_column(batched, c);
+		conf->projectOnCycleNullSpace(&in.vector, single, workspace);
+		gsl_vector_sub(single, &out.vector);
+		if(gsl_blas_dnrm2(single)>1.0e-10){
+			log("test")<<"TestNullspace::testBatchedProjectionMatchesSingle: Gradient "<<c<<" differs by "<<gsl_blas_dnrm2(single)<<endl;
+			ok = false;
+		}
+	}
+
+	gsl_vector_free(single);
+	gsl_matrix_free(batched);
+	gsl_matrix_free(gradients);
+	delete mol;
+	return ok;
+}
+
+string TestNullspace::name(){
+	return "Nullspace";
+}
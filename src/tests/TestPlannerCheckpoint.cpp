@@ -0,0 +1,120 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+#include "TestPlannerCheckpoint.h"
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../Logger.h"
+#include "../IO.h"
+#include "../Selection.h"
+#include "core/Configuration.h"
+#include "core/Molecule.h"
+#include "metrics/RMSD.h"
+#include "moves/RawMove.h"
+#include "planners/PlannerCheckpoint.h"
+#include "planners/PoissonPlanner.h"
+
+/**
+ * Run a Poisson planner on a fresh copy of tests/polypro.pdb until `stopAfter` samples, writing a checkpoint
+ * after every seed to `checkpointFile`, and optionally resuming from `resumeFile` first. Returns the id and
+ * DOF-values of each sample.
+ */
+static vector<vector<double> > samplePoisson(int stopAfter, const string& checkpointFile, const string& resumeFile){
+	Molecule* mol = IO::readPdb("tests/polypro.pdb", {}, "identify");
+	Selection all("all");
+	mol->initializeTree(all);
+
+	vector<vector<double> > ret;
+	{
+		metrics::RMSD metric(all);
+		RawMove move;
+		PoissonPlanner planner(mol, stopAfter, 4, 1.0, "all");
+		planner.initialize(&move, &metric, "tests/", 0);
+		planner.setCheckpointing(checkpointFile, 1);
+		if(!resumeFile.empty())
+			planner.resume(resumeFile);
+		planner.generateSamples();
+
+		for(auto const& conf: planner.getSamples()){
+			vector<double> sample(1, conf->m_id);
+			sample.insert(sample.end(), conf->m_dofs, conf->m_dofs+conf->getNumDOFs());
+			ret.push_back(sample);
+		}
+	}
+	delete mol;
+	return ret;
+}
+
+bool TestPlannerCheckpoint::runTests(){
+	if(testResumeMatchesUninterrupted()) log("test")<<left<<setw(60)<<"TestPlannerCheckpoint::testResumeMatchesUninterrupted:"<<"passed"<<endl;
+	else { log("test")<<left<<setw(60)<<"TestPlannerCheckpoint::testResumeMatchesUninterrupted:"<<"failed"<<endl;return false;}
+	return true;
+}
+
+/**
+ * A run stopped early and resumed from its checkpoint, with `rand` seeded differently, must generate the same
+ * samples as a run that wasn't interrupted.
+ */
+bool TestPlannerCheckpoint::testResumeMatchesUninterrupted(){
+	const int interrupted = 6, total = 15;
+	string uninterruptedFile = "tests/TestPlannerCheckpoint_uninterrupted.kgsckpt";
+	string resumedFile = "tests/TestPlannerCheckpoint_resumed.kgsckpt";
+
+	srand(3);
+	vector<vector<double> > expected = samplePoisson(total, uninterruptedFile, "");
+	srand(3);
+	vector<vector<double> > partial = samplePoisson(interrupted, resumedFile, "");
+	srand(101);
+	vector<vector<double> > resumed = samplePoisson(total, resumedFile, resumedFile);
+	std::remove(uninterruptedFile.c_str());
+	std::remove(resumedFile.c_str());
+
+	if(partial.size()>=expected.size()){
+		log("test")<<"TestPlannerCheckpoint::testResumeMatchesUninterrupted: The interrupted run generated "<<partial.size();
+		log("test")<<" samples, so nothing was left to resume"<<endl;
+		return false;
+	}
+	if(resumed.size()!=expected.size()){
+		log("test")<<"TestPlannerCheckpoint::testResumeMatchesUninterrupted: Resumed run has "<<resumed.size()<<" samples";
+		log("test")<<" but uninterrupted run has "<<expected.size()<<endl;
+		return false;
+	}
+	for(size_t s=0; s<expected.size(); s++){
+		if(resumed[s]!=expected[s]){
+			log("test")<<"TestPlannerCheckpoint::testResumeMatchesUninterrupted: Sample "<<s<<" (id "<<expected[s][0];
+			log("test")<<") differs from the uninterrupted run"<<endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+string TestPlannerCheckpoint::name(){
+	return "PlannerCheckpoint";
+}
@@ -0,0 +1,166 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+#include "TestQCP.h"
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <gsl/gsl_linalg.h>
+#include "../Logger.h"
+#include "math/QCP.h"
+
+bool TestQCP::runTests(){
+	if(testMatchesKabsch()) log("test")<<left<<setw(60)<<"TestQCP::testMatchesKabsch:"<<"passed"<<endl;
+	else { log("test")<<left<<setw(60)<<"TestQCP::testMatchesKabsch:"<<"failed"<<endl;return false;}
+	return true;
+}
+
+/** Row-major rotation matrix of a random unit quaternion */
+static void randomRotation(double m[9]){
+	double q[4], norm = 0.0;
+	for(int k=0; k<4; k++){
+		q[k] = 2.0*rand()/RAND_MAX-1.0;
+		norm += q[k]*q[k];
+	}
+	norm = sqrt(norm);
+	double w = q[0]/norm, x = q[1]/norm, y = q[2]/norm, z = q[3]/norm;
+	m[0] = 1-2*(y*y+z*z); m[1] = 2*(x*y-w*z);   m[2] = 2*(x*z+w*y);
+	m[3] = 2*(x*y+w*z);   m[4] = 1-2*(x*x+z*z); m[5] = 2*(y*z-w*x);
+	m[6] = 2*(x*z-w*y);   m[7] = 2*(y*z+w*x);   m[8] = 1-2*(x*x+y*y);
+}
+
+/** RMSD between `fixed` and `moving` after rotating `moving` by the row-major `rotation` */
+static double rotatedRmsd(const double* fixed, const double* moving, int n, const double rotation[9]){
+	double sum = 0.0;
+	for(int i=0; i<n; i++)
+		for(int r=0; r<3; r++){
+			double x = 0.0;
+			for(int c=0; c<3; c++) x += rotation[3*r+c]*moving[3*i+c];
+			sum += (x-fixed[3*i+r])*(x-fixed[3*i+r]);
+		}
+	return sqrt(sum/n);
+}
+
+/**
+ * Reference superposition by Kabsch' method: the SVD H = U*S*V^T of the correlation matrix of the centered
+ * point sets gives the rotation R = V*diag(1,1,d)*U^T with d the sign of det(V*U^T). Returns the RMSD after
+ * rotating, which unlike the RMSD from the singular values doesn't lose precision for near-identical sets.
+ */
+static double kabschSuperpose(const double* fixed, const double* moving, int n, double rotation[9]){
+	gsl_matrix* H = gsl_matrix_calloc(3,3);
+	for(int i=0; i<n; i++){
+		for(int r=0; r<3; r++){
+			for(int c=0; c<3; c++)
+				*gsl_matrix_ptr(H,r,c) += moving[3*i+r]*fixed[3*i+c];
+		}
+	}
+	gsl_matrix* V = gsl_matrix_alloc(3,3);
+	gsl_vector* S = gsl_vector_alloc(3);
+	gsl_vector* work = gsl_vector_alloc(3);
+	gsl_linalg_SV_decomp(H, V, S, work); //H now holds U
+
+	double det = 0.0;
+	gsl_matrix* VUt = gsl_matrix_alloc(3,3);
+	for(int r=0; r<3; r++)
+		for(int c=0; c<3; c++){
+			double sum = 0.0;
+			for(int k=0; k<3; k++) sum += gsl_matrix_get(V,r,k)*gsl_matrix_get(H,c,k);
+			gsl_matrix_set(VUt,r,c,sum);
+		}
+	for(int c=0; c<3; c++)
+		det += gsl_matrix_get(VUt,0,c)*(gsl_matrix_get(VUt,1,(c+1)%3)*gsl_matrix_get(VUt,2,(c+2)%3) -
+		                                gsl_matrix_get(VUt,1,(c+2)%3)*gsl_matrix_get(VUt,2,(c+1)%3));
+	double d = det<0 ? -1.0 : 1.0;
+
+	for(int r=0; r<3; r++)
+		for(int c=0; c<3; c++){
+			double sum = 0.0;
+			for(int k=0; k<3; k++) sum += gsl_matrix_get(V,r,k)*(k==2?d:1.0)*gsl_matrix_get(H,c,k);
+			rotation[3*r+c] = sum;
+		}
+	gsl_matrix_free(H);
+	gsl_matrix_free(V);
+	gsl_matrix_free(VUt);
+	gsl_vector_free(S);
+	gsl_vector_free(work);
+	return rotatedRmsd(fixed, moving, n, rotation);
+}
+
+bool TestQCP::testMatchesKabsch(){
+	srand(42);
+	const int n = 40;
+	for(int trial=0; trial<20; trial++){
+		//A noisy rotated copy, mirrored in every fourth trial so Kabsch has to correct a reflection
+		double m[9];
+		randomRotation(m);
+		double noise = 0.1*trial;
+		std::vector<double> fixed(3*n), moving(3*n);
+		for(int i=0; i<n; i++){
+			double p[3] = {10.0*rand()/RAND_MAX, 10.0*rand()/RAND_MAX, 10.0*rand()/RAND_MAX};
+			if(trial%4==3) p[2] = -p[2];
+			for(int r=0; r<3; r++){
+				moving[3*i+r] = p[r];
+				fixed[3*i+r] = m[3*r]*p[0] + m[3*r+1]*p[1] + m[3*r+2]*p[2] + noise*(2.0*rand()/RAND_MAX-1.0);
+			}
+		}
+		double centroid[3];
+		qcpCenter(fixed.data(), n, centroid);
+		qcpCenter(moving.data(), n, centroid);
+
+		double qcpRotation[9], kabschRotation[9];
+		double qcp = qcpSuperpose(fixed.data(), moving.data(), n, qcpRotation);
+		double kabsch = kabschSuperpose(fixed.data(), moving.data(), n, kabschRotation);
+		double inner = qcpRmsd(fixed.data(), moving.data(), n,
+		                       qcpInnerProduct(fixed.data(), n), qcpInnerProduct(moving.data(), n));
+
+		//QCP takes the root of a difference of sums, so compare squares: identical sets give an RMSD of about 1e-7
+		if(fabs(qcp*qcp-kabsch*kabsch)>1.0e-10 || fabs(inner*inner-kabsch*kabsch)>1.0e-10){
+			log("test")<<"TestQCP::testMatchesKabsch() trial "<<trial<<": QCP RMSD "<<qcp<<" (inner products: ";
+			log("test")<<inner<<") but Kabsch RMSD "<<kabsch<<endl;
+			return false;
+		}
+		double rotated = rotatedRmsd(fixed.data(), moving.data(), n, qcpRotation);
+		if(fabs(rotated-kabsch)>1.0e-6){
+			log("test")<<"TestQCP::testMatchesKabsch() trial "<<trial<<": QCP rotation gives RMSD "<<rotated;
+			log("test")<<" but Kabsch RMSD is "<<kabsch<<endl;
+			return false;
+		}
+		for(int k=0; k<9; k++){
+			if(fabs(qcpRotation[k]-kabschRotation[k])>1.0e-6){
+				log("test")<<"TestQCP::testMatchesKabsch() trial "<<trial<<": rotations differ at "<<k<<": ";
+				log("test")<<qcpRotation[k]<<" vs "<<kabschRotation[k]<<endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+string TestQCP::name(){
+	return "QCP";
+}
@@ -0,0 +1,152 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+#include "TestRMSD.h"
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "../Logger.h"
+#include "../IO.h"
+#include "../Selection.h"
+#include "../ThreadPool.h"
+#include "core/Configuration.h"
+#include "core/Molecule.h"
+#include "metrics/RMSD.h"
+
+using namespace metrics;
+
+/** Molecules and configurations used by one task. Tasks don't share molecules, as distance updates positions. */
+struct RMSDTestSet {
+	Molecule* mol;
+	Molecule* partner;
+	vector<Configuration*> confs;
+};
+
+static Molecule* readPolypro(){
+	Molecule* mol = IO::readPdb("tests/polypro.pdb", {}, "identify");
+	Selection all("all");
+	mol->initializeTree(all);
+	return mol;
+}
+
+static RMSDTestSet makeTestSet(const vector<vector<double> >& dofValues){
+	RMSDTestSet set;
+	set.mol = readPolypro();
+	set.partner = readPolypro();
+	for(auto const& values: dofValues){
+		Configuration* conf = new Configuration(set.mol->m_conf);
+		for(unsigned int d=0; d<conf->getNumDOFs(); d++)
+			conf->m_dofs[d] = values[d];
+		set.confs.push_back(conf);
+	}
+	return set;
+}
+
+/** All pairwise distances of `set.confs` followed by their distances to the initial configuration of the partner */
+static vector<double> testSetDistances(RMSD& rmsd, RMSDTestSet& set){
+	vector<double> ret;
+	for(size_t i=0; i<set.confs.size(); i++)
+		for(size_t j=0; j<i; j++)
+			ret.push_back(rmsd.distance(set.confs[i], set.confs[j]));
+	for(auto const& conf: set.confs)
+		ret.push_back(rmsd.distance(conf, set.partner->m_conf));
+	return ret;
+}
+
+static void freeTestSet(RMSDTestSet& set){
+	for(auto const& conf: set.confs)
+		delete conf;
+	delete set.mol;
+	delete set.partner;
+}
+
+bool TestRMSD::runTests(){
+	if(testThreadedDistances()) log("test")<<left<<setw(60)<<"TestRMSD::testThreadedDistances:"<<"passed"<<endl;
+	else { log("test")<<left<<setw(60)<<"TestRMSD::testThreadedDistances:"<<"failed"<<endl;return false;}
+	return true;
+}
+
+/**
+ * One metric measures distances on several threads at once, both within a molecule and between molecules,
+ * and has to agree with a metric used on one thread. Partners are then destroyed and re-read, which may
+ * reuse their addresses, and the distances have to stay the same.
+ */
+bool TestRMSD::testThreadedDistances(){
+	srand(11);
+	const size_t numSets = 4, numConfs = 6;
+	Selection all("all");
+	RMSD serial(all), threaded(all);
+
+	Molecule* layout = readPolypro();
+	vector<vector<double> > dofValues(numConfs, vector<double>(layout->m_conf->getNumDOFs()));
+	delete layout;
+	for(auto& values: dofValues)
+		for(auto& v: values)
+			v = 0.2*(2.0*rand()/RAND_MAX-1.0);
+
+	RMSDTestSet reference = makeTestSet(dofValues);
+	vector<double> expected = testSetDistances(serial, reference);
+
+	vector<RMSDTestSet> sets;
+	for(size_t s=0; s<numSets; s++)
+		sets.push_back(makeTestSet(dofValues));
+
+	bool ok = true;
+	for(int round=0; round<2 && ok; round++){
+		vector<vector<double> > found(numSets);
+		ThreadPool pool(numSets);
+		pool.parallelFor(numSets, [&](size_t s, unsigned int thread){
+			found[s] = testSetDistances(threaded, sets[s]);
+		});
+
+		for(size_t s=0; s<numSets && ok; s++){
+			for(size_t i=0; i<expected.size(); i++){
+				if(fabs(found[s][i]-expected[i])>1.0e-10){
+					log("test")<<"TestRMSD::testThreadedDistances: Round "<<round<<", set "<<s<<", distance "<<i<<" is ";
+					log("test")<<found[s][i]<<" but "<<expected[i]<<" on one thread"<<endl;
+					ok = false;
+					break;
+				}
+			}
+		}
+
+		for(auto& set: sets){
+			delete set.partner;
+			set.partner = readPolypro();
+		}
+	}
+
+	for(auto& set: sets)
+		freeTestSet(set);
+	freeTestSet(reference);
+	return ok;
+}
+
+string TestRMSD::name(){
+	return "RMSD";
+}
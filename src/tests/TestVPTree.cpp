@@ -0,0 +1,163 @@
+/*
+
+Excited States software: KGS
+Contributors: See CONTRIBUTORS.txt
+Contact: kgs-contact@simtk.org
+
+Copyright (C) 2009-2017 Stanford University
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+This entire text, including the above copyright notice and this permission notice
+shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*/
+#include "TestVPTree.h"
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include "../Logger.h"
+#include "../IO.h"
+#include "../Selection.h"
+#include "core/Configuration.h"
+#include "core/Molecule.h"
+#include "metrics/Dihedral.h"
+#include "metrics/VPTree.h"
+
+using namespace metrics;
+
+/** A configuration of `mol` with DOF-values drawn from [-3pi,3pi] so the metric has to reduce them */
+static Configuration* randomConfiguration(Molecule* mol){
+	Configuration* conf = new Configuration(mol);
+	for(unsigned int d=0; d<conf->getNumDOFs(); d++)
+		conf->m_dofs[d] = 3.0*M_PI*(2.0*rand()/RAND_MAX-1.0);
+	return conf;
+}
+
+/** Compare nearest, withinRadius and anyWithin of `tree` to a linear scan of `confs` for `query` */
+static bool sameAsBruteForce(VPTree& tree, Metric* metric, const vector<Configuration*>& confs, Configuration* query, double radius){
+	double bestDist = 1.0e100;
+	vector<Configuration*> expected;
+	for(auto const& conf: confs){
+		double d = metric->distance(conf, query);
+		bestDist = std::min(bestDist, d);
+		if(d<radius) expected.push_back(conf);
+	}
+
+	double treeDist;
+	tree.nearest(query, &treeDist);
+	vector<Configuration*> found;
+	tree.withinRadius(query, radius, found);
+	std::sort(expected.begin(), expected.end());
+	std::sort(found.begin(), found.end());
+
+	if(fabs(treeDist-bestDist)>1.0e-12){
+		log("test")<<"TestVPTree: nearest at "<<treeDist<<" but closest is at "<<bestDist<<endl;
+		return false;
+	}
+	if(found!=expected || tree.anyWithin(query, radius)!=!expected.empty()){
+		log("test")<<"TestVPTree: found "<<found.size()<<" within "<<radius<<" but expected "<<expected.size()<<endl;
+		return false;
+	}
+	return true;
+}
+
+bool TestVPTree::runTests(){
+    if(testMatchesBruteForce()) log("test")<<left<<setw(60)<<"TestVPTree::testMatchesBruteForce:"<<"passed"<<endl;
+    else { log("test")<<left<<setw(60)<<"TestVPTree::testMatchesBruteForce:"<<"failed"<<endl;return false;}
+    if(testDuplicates()) log("test")<<left<<setw(60)<<"TestVPTree::testDuplicates:"<<"passed"<<endl;
+    else { log("test")<<left<<setw(60)<<"TestVPTree::testDuplicates:"<<"failed"<<endl;return false;}
+    return true;
+}
+
+/**
+ * Queries under the dihedral metric must give the same results as a linear scan, also after removing
+ * configurations (which rebuilds the tree once more than half the vantage points are gone).
+ */
+bool TestVPTree::testMatchesBruteForce(){
+	srand(41);
+	Molecule* mol = IO::readPdb("tests/polypro.pdb");
+	Selection all("all");
+	mol->initializeTree(all);
+	Dihedral metric(all);
+	VPTree tree(&metric, 4);
+
+	vector<Configuration*> confs;
+	for(int i=0; i<300; i++){
+		confs.push_back(randomConfiguration(mol));
+		tree.insert(confs.back());
+	}
+
+	bool ok = true;
+	for(int q=0; q<50 && ok; q++){
+		Configuration* query = randomConfiguration(mol);
+		ok = sameAsBruteForce(tree, &metric, confs, query, 1.5);
+		delete query;
+	}
+
+	for(size_t i=0; i<200; i++)
+		tree.remove(confs[i]);
+	vector<Configuration*> remaining(confs.begin()+200, confs.end());
+	for(int q=0; q<50 && ok; q++){
+		Configuration* query = randomConfiguration(mol);
+		ok = sameAsBruteForce(tree, &metric, remaining, query, 1.5);
+		delete query;
+	}
+	if(ok && tree.size()!=remaining.size()){
+		log("test")<<"TestVPTree::testMatchesBruteForce: tree has "<<tree.size()<<" configurations, expected "<<remaining.size()<<endl;
+		ok = false;
+	}
+
+	for(auto const& conf: confs)
+		delete conf;
+	delete mol;
+	return ok;
+}
+
+/** Many identical configurations can't be separated by a split, but must still be found */
+bool TestVPTree::testDuplicates(){
+	srand(43);
+	Molecule* mol = IO::readPdb("tests/polypro.pdb");
+	Selection all("all");
+	mol->initializeTree(all);
+	Dihedral metric(all);
+	VPTree tree(&metric, 4);
+
+	vector<Configuration*> confs;
+	Configuration* original = randomConfiguration(mol);
+	for(int i=0; i<200; i++){
+		Configuration* conf = i%4==0 ? randomConfiguration(mol) : original->clone();
+		confs.push_back(conf);
+		tree.insert(conf);
+	}
+
+	bool ok = sameAsBruteForce(tree, &metric, confs, original, 0.5);
+	for(int q=0; q<20 && ok; q++){
+		Configuration* query = randomConfiguration(mol);
+		ok = sameAsBruteForce(tree, &metric, confs, query, 1.5);
+		delete query;
+	}
+
+	for(auto const& conf: confs)
+		delete conf;
+	delete original;
+	delete mol;
+	return ok;
+}
+
+string TestVPTree::name(){
+	return "VPTree";
+}